@@ -1,7 +1,16 @@
 #include <assert.h>
-#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+// This file defines the out-of-line functions, so the inline fast
+// path must not replace them
+#undef FIXPOINT_INLINE
 #include "fixpoint.h"
+#include "fixpoint_inline.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FIXPOINT_X86 1
+#endif
 
 ////////////////////////////////////////////////////////////////////////
 // Helper functions
@@ -11,133 +20,1319 @@
 
 // TODO: add helper functions
 
-// Helper function for left > right fraction case
+// Helper function computing left * right + addend with a single
+// truncation. The exact 128 bit product of the magnitudes is built
+// from the same partial products as fixpoint_inline_mul, the addend
+// is added to (or subtracted from) it, and only then are the low and
+// high 32 bits discarded, as in fixpoint_inline_mul. Like
+// fixpoint_inline_add_sub, the sum
+// and difference are both computed and the right one is selected.
+static result_t
+handle_fma( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+            const fixpoint_t *addend ) {
+  uint64_t p0 = (uint64_t)left->frac * right->frac;
+  uint64_t p1 = (uint64_t)left->frac * right->whole;
+  uint64_t p2 = (uint64_t)left->whole * right->frac;
+  uint64_t p3 = (uint64_t)left->whole * right->whole;
+
+  //product as two 64 bit halves (units of 2^-64)
+  uint64_t middle = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+  uint64_t prod_lo = (middle << 32) | (uint32_t)p0;
+  uint64_t prod_hi = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+
+  //addend in the same units
+  uint64_t add_lo = (uint64_t)addend->frac << 32;
+  uint64_t add_hi = addend->whole;
+  bool prod_negative = left->negative ^ right->negative;
+  bool same_sign = prod_negative == addend->negative;
+
+  //magnitudes add when the signs agree
+  uint64_t sum_lo, sum_hi;
+  bool carry = __builtin_add_overflow(prod_lo, add_lo, &sum_lo);
+  carry = __builtin_add_overflow(prod_hi, add_hi + carry, &sum_hi);
+
+  //otherwise they subtract, and the sign is the addend's if it was bigger
+  uint64_t diff_lo, diff_hi;
+  bool borrow = __builtin_sub_overflow(prod_lo, add_lo, &diff_lo);
+  borrow = __builtin_sub_overflow(prod_hi, add_hi + borrow, &diff_hi);
+  uint64_t borrow_mask = -(uint64_t)borrow;
+  diff_lo = (diff_lo ^ borrow_mask) - borrow_mask;
+  diff_hi = (diff_hi ^ borrow_mask) + (borrow & (diff_lo == 0));
+
+  //select with a mask (the compiler would branch on a ?: here)
+  uint64_t same_mask = -(uint64_t)same_sign;
+  uint64_t lo = (sum_lo & same_mask) | (diff_lo & ~same_mask);
+  uint64_t hi = (sum_hi & same_mask) | (diff_hi & ~same_mask);
+
+  result_t ret = RESULT_OK;
+  bool overflow = (same_sign & carry) | ((hi >> 32) != 0);
+  if (overflow) {
+    ret |= RESULT_OVERFLOW;
+  }
+  if ((uint32_t)lo != 0) {
+    ret |= RESULT_UNDERFLOW;
+  }
+
+  //only an exact 0 is never negative
+  bool negative = (prod_negative ^ (!same_sign & borrow)) & ((hi | lo) != 0 || overflow);
+  fixpoint_inline_store(result, (hi << 32) | (lo >> 32), negative);
+  return ret;
+}
+
+// The exact totals in fixpoint_sum_n and fixpoint_dot_n are kept as
+// REDUCE_DIGITS signed 32 bit "digits" (units of 2^-64, digit d has
+// weight 2^(32d)) in 64 bit accumulators. Every term is split into
+// its 32 bit halves before being added, so the loops only need
+// 32x32->64 multiplies and independent 64 bit adds (no carry chains
+// and no branches). An element adds less than 3 * 2^32 to a digit,
+// so after REDUCE_CHUNK elements the digits are folded into a
+// 192 bit total before they can overflow.
+#define REDUCE_DIGITS 4
+#define REDUCE_CHUNK ((size_t)1 << 28)
+
+// Helper function to add a signed digit with weight 2^(32*pos) to a
+// 192 bit two's complement total (least significant limb first)
+static void
+reduce_fold( uint64_t total[3], int64_t digit, unsigned pos ) {
+  uint64_t ext = (uint64_t)(digit >> 63);
+  uint64_t add[3] = { 0, 0, 0 };
+  unsigned limb = pos / 2;
+  if (pos % 2 == 0) {
+    add[limb] = (uint64_t)digit;
+  } else {
+    add[limb] = (uint64_t)digit << 32;
+    add[++limb] = (uint64_t)(digit >> 32);
+  }
+  //sign extend
+  for (unsigned i = limb + 1; i < 3; i++) {
+    add[i] = ext;
+  }
+
+  bool carry = false;
+  for (unsigned i = 0; i < 3; i++) {
+    bool c = __builtin_add_overflow(total[i], add[i], &total[i]);
+    carry = c | __builtin_add_overflow(total[i], (uint64_t)carry, &total[i]);
+  }
+}
+
+// Helper function to truncate a 192 bit total (units of 2^-64) to a
+// fixpoint_t, setting the flags the same way as handle_fma
+static result_t
+reduce_store( fixpoint_t *result, const uint64_t total[3] ) {
+  bool negative = total[2] >> 63;
+  uint64_t neg_mask = -(uint64_t)negative;
+
+  //two's complement to magnitude
+  uint64_t mag[3];
+  bool carry = negative;
+  for (unsigned i = 0; i < 3; i++) {
+    carry = __builtin_add_overflow(total[i] ^ neg_mask, (uint64_t)carry, &mag[i]);
+  }
+
+  result_t ret = RESULT_OK;
+  if ((mag[1] >> 32) != 0 || mag[2] != 0) {
+    ret |= RESULT_OVERFLOW;
+  }
+  if ((uint32_t)mag[0] != 0) {
+    ret |= RESULT_UNDERFLOW;
+  }
+  fixpoint_inline_store(result, (mag[1] << 32) | (mag[0] >> 32), negative);
+  return ret;
+}
+
+// Helper function adding one value to the digits of a sum
+static inline void
+sum_accumulate( int64_t acc[REDUCE_DIGITS], const fixpoint_t *val ) {
+  int64_t sign = -(int64_t)val->negative;
+  acc[1] += ((int64_t)val->frac ^ sign) - sign;
+  acc[2] += ((int64_t)val->whole ^ sign) - sign;
+}
+
+// Helper function adding one exact product (the partial products of
+// handle_fma, split into 32 bit halves) to the digits of a dot product
+static inline void
+dot_accumulate( int64_t acc[REDUCE_DIGITS], const fixpoint_t *left, const fixpoint_t *right ) {
+  uint64_t p0 = (uint64_t)left->frac * right->frac;
+  uint64_t p1 = (uint64_t)left->frac * right->whole;
+  uint64_t p2 = (uint64_t)left->whole * right->frac;
+  uint64_t p3 = (uint64_t)left->whole * right->whole;
+  int64_t sign = -(int64_t)(left->negative ^ right->negative);
+
+  int64_t d0 = (uint32_t)p0;
+  int64_t d1 = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+  int64_t d2 = (p1 >> 32) + (p2 >> 32) + (uint32_t)p3;
+  int64_t d3 = p3 >> 32;
+  acc[0] += (d0 ^ sign) - sign;
+  acc[1] += (d1 ^ sign) - sign;
+  acc[2] += (d2 ^ sign) - sign;
+  acc[3] += (d3 ^ sign) - sign;
+}
+
+// 128 bit unsigned value as two 64 bit halves
+typedef struct {
+  uint64_t lo, hi;
+} u128_t;
+
+// Helper function computing the 128 bit product a * b + c (which
+// cannot overflow)
+static inline u128_t
+mul_add_64x64( uint64_t a, uint64_t b, u128_t c ) {
+  u128_t r;
+#ifdef __SIZEOF_INT128__
+  unsigned __int128 p = (unsigned __int128)a * b + (((unsigned __int128)c.hi << 64) | c.lo);
+  r.lo = (uint64_t)p;
+  r.hi = (uint64_t)(p >> 64);
+#else
+  uint64_t p0 = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+  uint64_t p1 = (a & 0xFFFFFFFF) * (b >> 32);
+  uint64_t p2 = (a >> 32) * (b & 0xFFFFFFFF);
+  uint64_t p3 = (a >> 32) * (b >> 32);
+  uint64_t middle = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+  r.lo = (middle << 32) | (uint32_t)p0;
+  r.hi = p3 + (p1 >> 32) + (p2 >> 32) + (middle >> 32);
+  bool carry = __builtin_add_overflow(r.lo, c.lo, &r.lo);
+  r.hi += c.hi + carry;
+#endif
+  return r;
+}
+
+// Helper function dividing the 128 bit value (hi, lo) by d, which
+// must be greater than hi (so that the quotient fits in 64 bits).
+// Returns the quotient and stores the remainder in *rem.
+static uint64_t
+div_128_64( uint64_t hi, uint64_t lo, uint64_t d, uint64_t *rem ) {
+#if defined(__x86_64__)
+  //the compiler would call __udivti3 for a 128 bit division, even
+  //though the quotient fits in 64 bits and one divq suffices
+  uint64_t q;
+  __asm__( "divq %4" : "=a"(q), "=d"(*rem) : "a"(lo), "d"(hi), "rm"(d) );
+  return q;
+#elif defined(__SIZEOF_INT128__)
+  unsigned __int128 n = ((unsigned __int128)hi << 64) | lo;
+  *rem = (uint64_t)(n % d);
+  return (uint64_t)(n / d);
+#else
+  //restoring division, one quotient bit at a time
+  uint64_t q = 0;
+  for (int i = 0; i < 64; i++) {
+    bool top = hi >> 63;
+    hi = (hi << 1) | (lo >> 63);
+    lo <<= 1;
+    q <<= 1;
+    if (top || hi >= d) {
+      hi -= d;
+      q |= 1;
+    }
+  }
+  *rem = hi;
+  return q;
+#endif
+}
+
+// Helper function storing a (96 bit) quotient q_hi * 2^64 + q_lo,
+// setting the flags the same way as fixpoint_inline_mul: overflow if the
+// quotient does not fit in 64 bits, underflow if the remainder is
+// not 0 (the quotient was truncated)
+static result_t
+div_store( fixpoint_t *result, uint64_t q_hi, uint64_t q_lo, uint64_t rem, bool negative ) {
+  result_t ret = (q_hi != 0 ? RESULT_OVERFLOW : 0) | (rem != 0 ? RESULT_UNDERFLOW : 0);
+  fixpoint_inline_store(result, q_lo, negative & (ret != RESULT_OK || q_lo != 0));
+  return ret;
+}
+
+// Helper function computing left / right (the body of fixpoint_div).
+// The quotient of the magnitudes is (left << 32) / right, where the
+// dividend has 96 bits, so it is done as a 64/64 division of the top
+// 64 bits (which is skipped when it would be 0, i.e. when there is
+// no overflow) followed by a 128/64 division.
+static result_t
+handle_div( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  uint64_t left_mag = fixpoint_inline_magnitude(left);
+  uint64_t right_mag = fixpoint_inline_magnitude(right);
+  bool negative = left->negative ^ right->negative;
+
+  //divide by zero saturates
+  if (right_mag == 0) {
+    fixpoint_inline_store(result, UINT64_MAX, negative);
+    return RESULT_OVERFLOW;
+  }
+
+  uint64_t q_hi = 0, rem = left_mag >> 32;
+  if (rem >= right_mag) {
+    q_hi = rem / right_mag;
+    rem %= right_mag;
+  }
+  uint64_t q_lo = div_128_64(rem, left_mag << 32, right_mag, &rem);
+  return div_store(result, q_hi, q_lo, rem, negative);
+}
+
+// Helper function dividing the 128 bit value (u1, u0) by the
+// normalized divisor of recip, which must be greater than u1, using
+// its precomputed reciprocal (Moller and Granlund, "Improved division
+// by invariant integers", algorithm 4). Returns the quotient and
+// stores the remainder in *rem.
+static inline uint64_t
+recip_div_step( uint64_t u1, uint64_t u0, const fixpoint_recip_t *recip, uint64_t *rem ) {
+  uint64_t d = recip->divisor;
+  u128_t q = mul_add_64x64(recip->inverse, u1, (u128_t){ u0, u1 + 1 });
+  uint64_t q0 = q.lo, q1 = q.hi;
 
-static result_t 
-handle_addition( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  result->whole = left->whole + right->whole;
-  result->frac = left->frac + right->frac;
-  result->negative = left->negative;
-  //if overflow in the fraction occurs, add one to the whole
-  if (result->frac < left->frac || result->frac < right->frac) {
-    result->whole += 1;
+  //the estimate q1 is at most one too large, or (rarely) one too small
+  uint64_t r = u0 - q1 * d;
+  uint64_t mask = -(uint64_t)(r > q0);
+  q1 += mask;
+  r += mask & d;
+  if (__builtin_expect(r >= d, 0)) {
+    q1++;
+    r -= d;
   }
-  //if overflow occurs
-  if (result->whole < left->whole || result->whole < right->whole) {
+  *rem = r;
+  return q1;
+}
+
+// Helper function computing left / recip's divisor (the body of
+// fixpoint_div_recip), with the same result as handle_div
+static inline result_t
+handle_div_recip( fixpoint_t *result, const fixpoint_t *left, const fixpoint_recip_t *recip ) {
+  uint64_t left_mag = fixpoint_inline_magnitude(left);
+  bool negative = left->negative ^ recip->negative;
+
+  if (recip->divisor == 0) {
+    fixpoint_inline_store(result, UINT64_MAX, negative);
     return RESULT_OVERFLOW;
   }
-  return RESULT_OK;
 
+  //the dividend left << 32, shifted by the same amount as the
+  //divisor, as three limbs (n2 is less than 2^31, so less than d).
+  //One multiplication does the shift (shifts by a variable amount
+  //are slower), and which limbs it lands in depends only on the
+  //divisor, so the branch is always predicted.
+  u128_t prod = mul_add_64x64(left_mag, recip->scale, (u128_t){ 0, 0 });
+  uint64_t n2 = 0, n1 = prod.hi, n0 = prod.lo;
+  if (recip->shift >= 32) {
+    n2 = prod.hi;
+    n1 = prod.lo;
+    n0 = 0;
+  }
+
+  uint64_t q_hi = 0, rem = n1;
+  if (n2 != 0 || n1 >= recip->divisor) {
+    q_hi = recip_div_step(n2, n1, recip, &rem);
+  }
+  uint64_t q_lo = recip_div_step(rem, n0, recip, &rem);
+  return div_store(result, q_hi, q_lo, rem, negative);
+}
+
+// Helper function computing left + right (or left - right if is_sub
+// is true), clamping the magnitude to the largest value on overflow
+// (an overflowed result already has the sign of the exact one)
+static inline result_t
+handle_add_sub_sat( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right, bool is_sub ) {
+  result_t ret = fixpoint_inline_add_sub(result, left, right, is_sub);
+  uint64_t clamp = -(uint64_t)(ret & RESULT_OVERFLOW);
+  fixpoint_inline_store(result, fixpoint_inline_magnitude(result) | clamp, result->negative);
+  return ret;
+}
+
+// Helper function computing left * right, rounded by adding increment
+// (plus the lowest kept bit if ties_even is true) to the 32 discarded
+// low bits of the exact product and rounding up if that carries, and
+// clamped to the largest magnitude on overflow if saturate is true.
+// Truncation is an increment of 0, round to nearest with ties to even
+// is 2^31 - 1 with ties_even, and stochastic rounding is a random
+// increment (which rounds up with probability low / 2^32). The flags
+// are those of fixpoint_mul for the rounded result: RESULT_UNDERFLOW
+// if the product was inexact.
+static inline result_t
+handle_mul_round( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+                  uint32_t increment, bool ties_even, bool saturate ) {
+  u128_t prod = mul_add_64x64(fixpoint_inline_magnitude(left), fixpoint_inline_magnitude(right),
+                              (u128_t){ 0, 0 });
+  uint64_t mag = (prod.hi << 32) | (prod.lo >> 32);
+  uint32_t low = (uint32_t)prod.lo;
+  uint64_t top = prod.hi >> 32;
+
+  uint64_t carry = ((uint64_t)low + increment + (ties_even & mag & 1)) >> 32;
+  mag += carry;
+  top += carry & (mag == 0);
+
+  result_t ret = (top != 0 ? RESULT_OVERFLOW : 0) | (low != 0 ? RESULT_UNDERFLOW : 0);
+  //only an exact 0 is never negative
+  bool negative = (left->negative ^ right->negative) & (mag != 0 || ret != RESULT_OK);
+  mag |= -(uint64_t)(saturate & (top != 0));
+  fixpoint_inline_store(result, mag, negative);
+  return ret;
 }
 
+// Next random value for fixpoint_mul_stochastic_n: the high 32 bits
+// of the next output of splitmix64 (which works with any seed)
+static inline uint32_t
+stochastic_next( uint64_t *state ) {
+  uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  return (uint32_t)((z ^ (z >> 31)) >> 32);
+}
+
+// Elementary function helpers
+//
+// fixpoint_exp, fixpoint_log, fixpoint_sin and fixpoint_cos reduce
+// their argument exactly (or to within 2^-64) and then evaluate a
+// 64 entry table plus a short polynomial in 64 bit fixed point
+// (Q0.64, Q1.63 or Q2.62 as noted) with 64x64->128 bit multiplies.
+// Only the final result is truncated to 32 fractional bits, and the
+// rounding errors of the intermediate steps are a few units of 2^-62
+// relative to the result, so they only matter for large results of
+// fixpoint_exp (see the error bounds in fixpoint.h).
+// The tables were generated with 120 digit decimal arithmetic.
+
+// Constants in Q0.64 (or the format noted)
+#define Q64_HALF         0x8000000000000000ULL
+#define Q64_THIRD        0x5555555555555555ULL
+#define Q64_QUARTER      0x4000000000000000ULL
+#define Q64_FIFTH        0x3333333333333333ULL
+#define Q64_SIXTH        0x2AAAAAAAAAAAAAABULL
+#define Q64_SEVENTH      0x2492492492492492ULL
+#define Q64_1_24         0x0AAAAAAAAAAAAAABULL
+#define Q64_1_120        0x0222222222222222ULL
+#define Q64_1_720        0x005B05B05B05B05BULL
+#define Q64_1_5040       0x000D00D00D00D00DULL
+#define Q64_LN2_64       0x02C5C85FDF473DE7ULL //ln(2) / 64
+#define Q64_PI_128       0x06487ED5110B4612ULL //pi / 128
+#define Q58_LN2          0x02C5C85FDF473DE7ULL //ln(2) in Q6.58
+#define Q63_LOG2E        0xB8AA3B295C17F0BCULL //log2(e) in Q1.63
+
+// floor(2/pi * 2^160), least significant limb first
+static const uint64_t two_over_pi[3] = {
+  0xF534DDC0DB629599ULL, 0x4E441529FC2757D1ULL, 0x00000000A2F9836EULL,
+};
+
+// floor(2^(j/64) * 2^63) (Q1.63), rounded down so that
+// exp2_table[63] * 2^(1/64) stays below 2^64
+static const uint64_t exp2_table[64] = {
+  0x8000000000000000ULL, 0x8164D1F3BC030773ULL, 0x82CD8698AC2BA1D7ULL,
+  0x843A28C3ACDE4046ULL, 0x85AAC367CC487B14ULL, 0x871F61969E8D1010ULL,
+  0x88980E8092DA8527ULL, 0x8A14D575496EFD9AULL, 0x8B95C1E3EA8BD6E6ULL,
+  0x8D1ADF5B7E5BA9E5ULL, 0x8EA4398B45CD53C0ULL, 0x9031DC431466B1DCULL,
+  0x91C3D373AB11C336ULL, 0x935A2B2F13E6E92BULL, 0x94F4EFA8FEF70961ULL,
+  0x96942D3720185A00ULL, 0x9837F0518DB8A96FULL, 0x99E0459320B7FA64ULL,
+  0x9B8D39B9D54E5538ULL, 0x9D3ED9A72CFFB750ULL, 0x9EF5326091A111ADULL,
+  0xA0B0510FB9714FC2ULL, 0xA27043030C496818ULL, 0xA43515AE09E6809EULL,
+  0xA5FED6A9B15138EAULL, 0xA7CD93B4E9653569ULL, 0xA9A15AB4EA7C0EF8ULL,
+  0xAB7A39B5A93ED337ULL, 0xAD583EEA42A14AC6ULL, 0xAF3B78AD690A4374ULL,
+  0xB123F581D2AC258FULL, 0xB311C412A9112489ULL, 0xB504F333F9DE6484ULL,
+  0xB6FD91E328D17791ULL, 0xB8FBAF4762FB9EE9ULL, 0xBAFF5AB2133E45FBULL,
+  0xBD08A39F580C36BEULL, 0xBF1799B67A731082ULL, 0xC12C4CCA66709456ULL,
+  0xC346CCDA24976407ULL, 0xC5672A115506DADDULL, 0xC78D74C8ABB9B15CULL,
+  0xC9B9BD866E2F27A2ULL, 0xCBEC14FEF2727C5CULL, 0xCE248C151F8480E3ULL,
+  0xD06333DAEF2B2594ULL, 0xD2A81D91F12AE45AULL, 0xD4F35AABCFEDFA1FULL,
+  0xD744FCCAD69D6AF4ULL, 0xD99D15C278AFD7B5ULL, 0xDBFBB797DAF23755ULL,
+  0xDE60F4825E0E9123ULL, 0xE0CCDEEC2A94E111ULL, 0xE33F8972BE8A5A51ULL,
+  0xE5B906E77C8348A8ULL, 0xE8396A503C4BDC68ULL, 0xEAC0C6E7DD24392EULL,
+  0xED4F301ED9942B84ULL, 0xEFE4B99BDCDAF5CBULL, 0xF281773C59FFB139ULL,
+  0xF5257D152486CC2CULL, 0xF7D0DF730AD13BB8ULL, 0xFA83B2DB722A033AULL,
+  0xFD3E0C0CF486C174ULL,
+};
+
+// log_recip[j] = floor(2^64 / (1 + (j+1)/64)) (Q0.64): for m in
+// [1 + j/64, 1 + (j+1)/64), m * log_recip[j] is in (64/65, 1).
+// log_table[j] = -ln(log_recip[j] / 2^64) (Q0.64), rounded.
+static const uint64_t log_recip[64] = {
+  0xFC0FC0FC0FC0FC0FULL, 0xF83E0F83E0F83E0FULL, 0xF4898D5F85BB3950ULL,
+  0xF0F0F0F0F0F0F0F0ULL, 0xED7303B5CC0ED730ULL, 0xEA0EA0EA0EA0EA0EULL,
+  0xE6C2B4481CD85689ULL, 0xE38E38E38E38E38EULL, 0xE070381C0E070381ULL,
+  0xDD67C8A60DD67C8AULL, 0xDA740DA740DA740DULL, 0xD79435E50D79435EULL,
+  0xD4C77B03531DEC0DULL, 0xD20D20D20D20D20DULL, 0xCF6474A8819EC8E9ULL,
+  0xCCCCCCCCCCCCCCCCULL, 0xCA4587E6B74F0329ULL, 0xC7CE0C7CE0C7CE0CULL,
+  0xC565C87B5F9D4D1BULL, 0xC30C30C30C30C30CULL, 0xC0C0C0C0C0C0C0C0ULL,
+  0xBE82FA0BE82FA0BEULL, 0xBC52640BC52640BCULL, 0xBA2E8BA2E8BA2E8BULL,
+  0xB81702E05C0B8170ULL, 0xB60B60B60B60B60BULL, 0xB40B40B40B40B40BULL,
+  0xB21642C8590B2164ULL, 0xB02C0B02C0B02C0BULL, 0xAE4C415C9882B931ULL,
+  0xAC7691840AC76918ULL, 0xAAAAAAAAAAAAAAAAULL, 0xA8E83F5717C0A8E8ULL,
+  0xA72F05397829CBC1ULL, 0xA57EB50295FAD40AULL, 0xA3D70A3D70A3D70AULL,
+  0xA237C32B16CFD772ULL, 0xA0A0A0A0A0A0A0A0ULL, 0x9F1165E7254813E2ULL,
+  0x9D89D89D89D89D89ULL, 0x9C09C09C09C09C09ULL, 0x9A90E7D95BC609A9ULL,
+  0x991F1A515885FB37ULL, 0x97B425ED097B425EULL, 0x964FDA6C0964FDA6ULL,
+  0x94F2094F2094F209ULL, 0x939A85C40939A85CULL, 0x9249249249249249ULL,
+  0x90FDBC090FDBC090ULL, 0x8FB823EE08FB823EULL, 0x8E78356D1408E783ULL,
+  0x8D3DCB08D3DCB08DULL, 0x8C08C08C08C08C08ULL, 0x8AD8F2FBA9386822ULL,
+  0x89AE4089AE4089AEULL, 0x8888888888888888ULL, 0x8767AB5F34E47EF1ULL,
+  0x864B8A7DE6D1D608ULL, 0x8534085340853408ULL, 0x8421084210842108ULL,
+  0x83126E978D4FDF3BULL, 0x8208208208208208ULL, 0x8102040810204081ULL,
+  0x8000000000000000ULL,
+};
+static const uint64_t log_table[64] = {
+  0x03F815161F807C7BULL, 0x07E0A6C39E0CC014ULL, 0x0BBA2C7B196E7E23ULL,
+  0x0F85186008B15332ULL, 0x1341D7961BD1D093ULL, 0x16F0D28AE56B4B9DULL,
+  0x1A926D3A4AD56365ULL, 0x1E27076E2AF2E5EAULL, 0x21AEFCF9A11CB2CEULL,
+  0x252AA5F03FEA4698ULL, 0x289A56D996FA3CD0ULL, 0x2BFE60E14F27A791ULL,
+  0x2F57120421B21238ULL, 0x32A4B539E8AD68EDULL, 0x35E7929D017FE5B2ULL,
+  0x391FEF8F35344359ULL, 0x3C4E0EDC55E5CBD4ULL, 0x3F7230DABC7C551BULL,
+  0x428C9389CE438D7FULL, 0x459D72AEAE98380FULL, 0x48A507EF3DE5968AULL,
+  0x4BA38AEB8474C271ULL, 0x4E993155A517A71DULL, 0x51862F08717B09F5ULL,
+  0x546AB61CB7E0B427ULL, 0x5746F6FD60272943ULL, 0x5A1B207A6C52BB11ULL,
+  0x5CE75FDAEF401A74ULL, 0x5FABE0EE0ABF0D93ULL, 0x6268CE1B05096AD7ULL,
+  0x651E5070845BEAEAULL, 0x67CC8FB2FE612FCCULL, 0x6A73B26A68212636ULL,
+  0x6D13DDEF323D8A33ULL, 0x6FAD36769C6DEFDFULL, 0x723FDF1E6A6886B1ULL,
+  0x74CBF9F803AF5588ULL, 0x7751A813071282FDULL, 0x79D109875A1E1F8EULL,
+  0x7C4A3D7EBC1BB2CFULL, 0x7EBD623DE3CC7B68ULL, 0x812A952D2E87F635ULL,
+  0x8391F2E0E6FA0273ULL, 0x85F39721295415B6ULL, 0x884F9CF16A64B7F0ULL,
+  0x8AA61E97A6AF4D4DULL, 0x8CF735A33E4B7663ULL, 0x8F42FAF3820681F0ULL,
+  0x918986BDF5FA1419ULL, 0x93CAF0944D88D75DULL, 0x96074F6A24745DCCULL,
+  0x983EB99A7885F0FEULL, 0x9A7144ECE70E98B9ULL, 0x9C9F069AB150CD4FULL,
+  0x9EC813538AB7D521ULL, 0xA0EC7F4233957324ULL, 0xA30C5E10E2F613E9ULL,
+  0xA527C2ED81F5D812ULL, 0xA73EC08DBADD84E6ULL, 0xA9516932DE2D5774ULL,
+  0xAB5FCEAD9F9CCA0AULL, 0xAD6A0261ACF967DAULL, 0xAF70154920B3AB87ULL,
+  0xB17217F7D1CF79ACULL,
+};
+
+// sin(j * pi / 128) for j in [0, 64] (Q2.62); cos(j * pi / 128)
+// is sin_table[64 - j]
+static const uint64_t sin_table[65] = {
+  0x0000000000000000ULL, 0x0192155F7A3667E0ULL, 0x0323ECBE21BB027DULL,
+  0x04B54824B3867D73ULL, 0x0645E9AF0A6D0AF8ULL, 0x07D59395AA5CC38DULL,
+  0x0964083747309D11ULL, 0x0AF10A22459FE32AULL, 0x0C7C5C1E34D3055BULL,
+  0x0E05C1353F27B17EULL, 0x0F8CFCBD90AF8D58ULL, 0x1111D262B1F67761ULL,
+  0x1294062ED59F05A9ULL, 0x14135C9417660143ULL, 0x158F9A75AB1FDCFEULL,
+  0x17088530FA459EAFULL, 0x187DE2A6AEA962D2ULL, 0x19EF7943A8ED8A2EULL,
+  0x1B5D1009E15CC02BULL, 0x1CC66E9931C45E17ULL, 0x1E2B5D3806F63B1EULL,
+  0x1F8BA4DBF89AB9FBULL, 0x20E70F3245FFDB2DULL, 0x223D66A836964508ULL,
+  0x238E76735CD190D9ULL, 0x24DA0A99BA25BD51ULL, 0x261FEFF9C2E069C2ULL,
+  0x275FF45240A17279ULL, 0x2899E64A123BAC30ULL, 0x29CD9577C7CBD228ULL,
+  0x2AFAD26919D93F45ULL, 0x2C216EAA3A59BDB7ULL, 0x2D413CCCFE779921ULL,
+  0x2E5A106FDFFF2C87ULL, 0x2F6BBE44D55F5DBCULL, 0x30761C17FF2EDBA4ULL,
+  0x317900D62A2E816AULL, 0x3274449324C7F69FULL, 0x3367C08FE70E8168ULL,
+  0x34534F408C4F03BBULL, 0x3536CC521D434606ULL, 0x361214B02A03FF37ULL,
+  0x36E5068A32DC7B22ULL, 0x37AF8158DF2A533FULL, 0x387165E3017B61A4ULL,
+  0x392A96426823E9EDULL, 0x39DAF5E8798EE5E2ULL, 0x3A8269A29B927359ULL,
+  0x3B20D79E651A8C51ULL, 0x3BB6276D998478C2ULL, 0x3C424209ED0DC97FULL,
+  0x3CC511D891C223DDULL, 0x3D3E82AD8C5BB4BBULL, 0x3DAE81CED092C67AULL,
+  0x3E14FDF72461AE55ULL, 0x3E71E758C9CB118AULL, 0x3EC52F9FEEB96056ULL,
+  0x3F0EC9F4E297526BULL, 0x3F4EAAFE114A2D43ULL, 0x3F84C8E1C33FA68FULL,
+  0x3FB11B47A24A4B3CULL, 0x3FD39B5A0310742AULL, 0x3FEC43C6F2DAFBC7ULL,
+  0x3FFB10C1099A1976ULL, 0x4000000000000000ULL,
+};
+
+// 1 / sqrt(k / 256) for k in [64, 256] (Q2.30, rounded): linear
+// interpolation between consecutive entries estimates 1 / sqrt(a)
+// for a in [1/4, 1) to within a relative error of 2^-15
+static const uint32_t rsqrt_table[193] = {
+  0x80000000, 0x7F02F623, 0x7E0BB221, 0x7D19FCA0, 0x7C2DA123, 0x7B466DD8,
+  0x7A64336B, 0x7986C4E4, 0x78ADF778, 0x77D9A26E, 0x77099EFB, 0x763DC824,
+  0x7575FAA4, 0x74B214D4, 0x73F1F68D, 0x73358118, 0x727C9717, 0x71C71C72,
+  0x7114F644, 0x70660ACC, 0x6FBA415C, 0x6F11824C, 0x6E6BB6E9, 0x6DC8C96E,
+  0x6D28A4F0, 0x6C8B355B, 0x6BF06762, 0x6B582874, 0x6AC266BA, 0x6A2F1107,
+  0x699E16D0, 0x690F682B, 0x6882F5C0, 0x67F8B0C5, 0x67708AF9, 0x66EA769B,
+  0x66666666, 0x65E44D8C, 0x65641FAE, 0x64E5D0DA, 0x64695585, 0x63EEA287,
+  0x6375AD16, 0x62FE6AC2, 0x6288D173, 0x6214D764, 0x61A27320, 0x61319B7C,
+  0x60C2479B, 0x60546EE2, 0x5FE808FC, 0x5F7D0DD6, 0x5F137599, 0x5EAB38AC,
+  0x5E444FAF, 0x5DDEB37A, 0x5D7A5D1B, 0x5D1745D1, 0x5CB56711, 0x5C54BA7D,
+  0x5BF539E5, 0x5B96DF46, 0x5B39A4C7, 0x5ADD84BB, 0x5A82799A, 0x5A287E03,
+  0x59CF8CBC, 0x5977A0AC, 0x5920B4DF, 0x58CAC480, 0x5875CADE, 0x5821C364,
+  0x57CEA99D, 0x577C7930, 0x572B2DE0, 0x56DAC38E, 0x568B3632, 0x563C81E0,
+  0x55EEA2C4, 0x55A19522, 0x55555555, 0x5509DFD0, 0x54BF311A, 0x547545D0,
+  0x542C1AA4, 0x53E3AC5B, 0x539BF7CD, 0x5354F9E7, 0x530EAFA5, 0x52C91618,
+  0x52842A5F, 0x523FE9AC, 0x51FC5140, 0x51B95E6B, 0x51770E8F, 0x51355F1A,
+  0x50F44D89, 0x50B3D768, 0x5073FA50, 0x5034B3E7, 0x4FF601E0, 0x4FB7E1FA,
+  0x4F7A5202, 0x4F3D4FCF, 0x4F00D944, 0x4EC4EC4F, 0x4E8986EA, 0x4E4EA718,
+  0x4E144AE9, 0x4DDA7073, 0x4DA115DA, 0x4D683948, 0x4D2FD8F4, 0x4CF7F31B,
+  0x4CC08605, 0x4C899000, 0x4C530F65, 0x4C1D0294, 0x4BE767F5, 0x4BB23DF9,
+  0x4B7D8317, 0x4B4935CF, 0x4B1554A6, 0x4AE1DE2A, 0x4AAED0F0, 0x4A7C2B93,
+  0x4A49ECB3, 0x4A1812FA, 0x49E69D16, 0x49B589BB, 0x4984D7A4, 0x49548592,
+  0x49249249, 0x48F4FC97, 0x48C5C34B, 0x4896E53D, 0x48686148, 0x483A364D,
+  0x480C6332, 0x47DEE6E1, 0x47B1C049, 0x4784EE60, 0x4758701C, 0x472C447C,
+  0x47006A81, 0x46D4E130, 0x46A9A794, 0x467EBCBA, 0x46541FB4, 0x4629CF98,
+  0x45FFCB80, 0x45D6128A, 0x45ACA3D5, 0x45837E88, 0x455AA1CB, 0x45320CC8,
+  0x4509BEB0, 0x44E1B6B4, 0x44B9F40B, 0x449275ED, 0x446B3B96, 0x44444444,
+  0x441D8F3B, 0x43F71BBF, 0x43D0E917, 0x43AAF68F, 0x43854374, 0x435FCF15,
+  0x433A98C6, 0x43159FDC, 0x42F0E3AE, 0x42CC6398, 0x42A81EF6, 0x42841527,
+  0x4260458E, 0x423CAF8D, 0x4219528B, 0x41F62DF2, 0x41D3412A, 0x41B08BA2,
+  0x418E0CC8, 0x416BC40D, 0x4149B0E5, 0x4127D2C3, 0x41062920, 0x40E4B374,
+  0x40C3713B, 0x40A261EF, 0x40818512, 0x4060DA22, 0x404060A1, 0x40201814,
+  0x40000000,
+};
+
+// Helper function returning the high 64 bits of a * b (which is
+// a * b in Q0.64 if either is in Q0.64)
+static inline uint64_t
+mulhi_64x64( uint64_t a, uint64_t b ) {
+  return mul_add_64x64(a, b, (u128_t){ 0, 0 }).hi;
+}
+
+// Helper function to store a Q(64-frac_bits).frac_bits approximation
+// of a nonzero result, truncated to 32 fractional bits (frac_bits must
+// be in [32, 95]). Results of exp, log, sin and cos are irrational
+// except for the few cases handled exactly by the callers, so the
+// stored value is always inexact, and is negative even if it
+// truncates to 0.
 static void
-handle_whole_sub_calc( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  if (left->whole > right->whole) {
-    result->whole = left->whole - right->whole;
-    result->negative = left->negative;
+store_truncated( fixpoint_t *result, uint64_t mag, unsigned frac_bits, bool negative ) {
+  unsigned shift = frac_bits - 32;
+  fixpoint_inline_store(result, shift < 64 ? mag >> shift : 0, negative);
+}
+
+// Helper function comparing the 128 bit values hi1:lo1 and hi2:lo2
+static inline bool
+less_128( uint64_t hi1, uint64_t lo1, uint64_t hi2, uint64_t lo2 ) {
+  return hi1 < hi2 || (hi1 == hi2 && lo1 < lo2);
+}
+
+// Helper function computing sqrt(val) (the body of fixpoint_sqrt):
+// the integer square root of the magnitude shifted left by 32 bits
+// (a 96 bit value). Newton's iteration for the reciprocal square
+// root (multiplications only, from a table estimate) gives a root
+// within 1 of the exact one, which is then corrected with exact
+// integer arithmetic, so the result doesn't depend on the accuracy
+// of the estimate.
+static result_t
+handle_sqrt( fixpoint_t *result, const fixpoint_t *val ) {
+  uint64_t mag = fixpoint_inline_magnitude(val);
+  if (val->negative && mag != 0) {
+    fixpoint_inline_store(result, 0, false);
+    return RESULT_OVERFLOW;
+  }
+  if (mag == 0) {
+    fixpoint_inline_store(result, 0, false);
+    return RESULT_OK;
+  }
+
+  //m = mag * 4^s in [2^62, 2^64), i.e. a = m / 2^64 in [1/4, 1)
+  int s = __builtin_clzll(mag) / 2;
+  uint64_t m = mag << (2 * s);
+
+  //y = 1 / sqrt(a) in Q2.62, interpolated in the table between the
+  //entries for the high 8 bits of m (the next 32 bits are the
+  //fraction), then refined by y' = y * (3 - a * y^2) / 2: each step
+  //doubles the number of correct bits (15, 30, then about 58,
+  //limited by the truncation of the products)
+  uint32_t y0 = rsqrt_table[(m >> 56) - 64], y1 = rsqrt_table[(m >> 56) - 63];
+  uint64_t y = (y0 - (((uint64_t)(y0 - y1) * (uint32_t)(m >> 24)) >> 32)) << 32;
+  for (int i = 0; i < 2; i++) {
+    uint64_t ay2 = mulhi_64x64(m, mulhi_64x64(y, y)); //a * y^2 in Q4.60
+    y = mulhi_64x64(y, ((uint64_t)3 << 60) - ay2) << 3;
+  }
+
+  //sqrt(a) = a * y in Q2.62, and the root of n = mag << 32 is
+  //sqrt(a) * 2^(48 - s)
+  uint64_t x = mulhi_64x64(m, y) >> (14 + s);
+
+  //n = hi * 2^64 + lo; make x the largest value with x * x <= n
+  uint64_t hi = mag >> 32, lo = mag << 32;
+  u128_t square = mul_add_64x64(x, x, (u128_t){ 0, 0 });
+  while (less_128(hi, lo, square.hi, square.lo)) {
+    x--;
+    square = mul_add_64x64(x, x, (u128_t){ 0, 0 });
+  }
+  for (;;) {
+    //(x + 1)^2 = x^2 + 2x + 1
+    u128_t next = mul_add_64x64(2, x, (u128_t){ square.lo + 1, square.hi + (square.lo == UINT64_MAX) });
+    if (less_128(hi, lo, next.hi, next.lo)) {
+      break;
+    }
+    x++;
+    square = next;
+  }
+
+  //exact if x * x == n
+  fixpoint_inline_store(result, x, false);
+  return (square.hi == hi && square.lo == lo) ? RESULT_OK : RESULT_UNDERFLOW;
+}
+
+// Helper function computing exp(val) (the body of fixpoint_exp)
+static result_t
+handle_exp( fixpoint_t *result, const fixpoint_t *val ) {
+  uint64_t mag = fixpoint_inline_magnitude(val);
+  //exp(x) >= 2^32 for x >= 32 ln(2) = 22.18..., and exp(x) < 2^-33
+  //for x <= -23, so the reduction only needs to handle |x| < 23
+  if (mag >= ((uint64_t)23 << 32)) {
+    fixpoint_inline_store(result, val->negative ? 0 : UINT64_MAX, false);
+    return val->negative ? RESULT_UNDERFLOW : RESULT_OVERFLOW;
+  }
+
+  //x * log2(e) = k + f with integer k and f in [0, 1) (Q0.64), so
+  //exp(x) = 2^k * 2^f (the product is in units of 2^-95)
+  u128_t t = mul_add_64x64(mag, Q63_LOG2E, (u128_t){ 0, 0 });
+  int k = (int)(t.hi >> 31);
+  uint64_t f = (t.hi << 33) | (t.lo >> 31);
+  if (val->negative) {
+    //-(k + f) = -(k + 1) + (1 - f) unless f is 0
+    k = -k - (f != 0);
+    f = -f;
+  }
+
+  //2^f = 2^(j/64) * e^s with s = (f - j/64) * ln(2) in [0, ln(2)/64),
+  //and e^s - 1 by its Taylor polynomial (the first omitted term,
+  //s^8/8!, is below 2^-66)
+  unsigned j = (unsigned)(f >> 58);
+  uint64_t s = mulhi_64x64(f << 6, Q64_LN2_64);
+  uint64_t p = Q64_1_5040;
+  p = Q64_1_720 + mulhi_64x64(s, p);
+  p = Q64_1_120 + mulhi_64x64(s, p);
+  p = Q64_1_24 + mulhi_64x64(s, p);
+  p = Q64_SIXTH + mulhi_64x64(s, p);
+  p = Q64_HALF + mulhi_64x64(s, p);
+  uint64_t expm1_s = s + mulhi_64x64(s, mulhi_64x64(s, p));
+  uint64_t m = exp2_table[j] + mulhi_64x64(exp2_table[j], expm1_s);
+
+  //m is 2^f in Q1.63, so 2^k * 2^f is m with 63 - k fractional bits
+  if (k >= 32) {
+    fixpoint_inline_store(result, UINT64_MAX, false);
+    return RESULT_OVERFLOW;
   }
-  else if (right->whole > left->whole) {
-    result->whole = right->whole - left->whole;
-    result->negative = !left->negative;
+  //exp(0) = 1 is the only exactly representable result
+  if (mag == 0) {
+    fixpoint_inline_store(result, (uint64_t)1 << 32, false);
+    return RESULT_OK;
   }
-  else {
-    result->whole = 0;
+  store_truncated(result, m, (unsigned)(63 - k), false);
+  return RESULT_UNDERFLOW;
+}
+
+// Helper function computing ln(val) (the body of fixpoint_log)
+static result_t
+handle_log( fixpoint_t *result, const fixpoint_t *val ) {
+  uint64_t mag = fixpoint_inline_magnitude(val);
+  if (val->negative || mag == 0) {
+    fixpoint_inline_store(result, UINT64_MAX, true);
+    return RESULT_OVERFLOW;
+  }
+  //ln(1) = 0 is the only exactly representable result
+  if (mag == ((uint64_t)1 << 32)) {
+    fixpoint_inline_store(result, 0, false);
+    return RESULT_OK;
+  }
+
+  //x = 2^e * m with m in [1, 2) (Q1.63)
+  int lz = __builtin_clzll(mag);
+  int e = 31 - lz;
+  uint64_t m = mag << lz;
+
+  //m * log_recip[j] = 1 - v with v in [0, 1/65), so ln(m) is
+  //log_table[j] + ln(1 - v) = log_table[j] - (v + v^2/2 + v^3/3 + ...)
+  //(the first omitted term, v^8/8, is below 2^-51)
+  unsigned j = (unsigned)(m >> 57) & 63;
+  uint64_t v = (((uint64_t)1 << 63) - mulhi_64x64(m, log_recip[j])) << 1;
+  uint64_t p = Q64_SEVENTH;
+  p = Q64_SIXTH + mulhi_64x64(v, p);
+  p = Q64_FIFTH + mulhi_64x64(v, p);
+  p = Q64_QUARTER + mulhi_64x64(v, p);
+  p = Q64_THIRD + mulhi_64x64(v, p);
+  p = Q64_HALF + mulhi_64x64(v, p);
+  uint64_t series = v + mulhi_64x64(v, mulhi_64x64(v, p));
+
+  //ln(x) = e * ln(2) + ln(m) in Q6.58 (|ln(x)| < 23)
+  int64_t ln = (int64_t)e * (int64_t)Q58_LN2 + (int64_t)(log_table[j] >> 6) - (int64_t)(series >> 6);
+  bool negative = ln < 0;
+  store_truncated(result, negative ? -(uint64_t)ln : (uint64_t)ln, 58, negative);
+  return RESULT_UNDERFLOW;
+}
+
+// Helper function computing sin(val), or cos(val) if is_cos is true
+// (the body of fixpoint_sin and fixpoint_cos)
+static result_t
+handle_sin_cos( fixpoint_t *result, const fixpoint_t *val, bool is_cos ) {
+  uint64_t mag = fixpoint_inline_magnitude(val);
+
+  //|x| * 2/pi = q + f with integer q and f in [0, 1) (Q0.64): the
+  //product of mag and two_over_pi is in units of 2^-192, and only
+  //its bits 128 to 193 are needed
+  u128_t a = mul_add_64x64(mag, two_over_pi[0], (u128_t){ 0, 0 });
+  u128_t b = mul_add_64x64(mag, two_over_pi[1], (u128_t){ a.hi, 0 });
+  u128_t c = mul_add_64x64(mag, two_over_pi[2], (u128_t){ b.hi, 0 });
+  uint64_t f = c.lo;
+  //cos(x) = sin(x + pi/2)
+  unsigned quadrant = (unsigned)c.hi + is_cos;
+
+  //sin and cos of f * pi/2 from those of j * pi/128 and of the
+  //remainder d = (f - j/64) * pi/2 in [0, pi/128), by their Taylor
+  //polynomials (the first omitted terms are below 2^-50)
+  unsigned j = (unsigned)(f >> 58);
+  uint64_t d = mulhi_64x64(f << 6, Q64_PI_128);
+  uint64_t d2 = mulhi_64x64(d, d);
+  uint64_t sin_d = d - mulhi_64x64(d, mulhi_64x64(d2, Q64_SIXTH - mulhi_64x64(d2, Q64_1_120)));
+  uint64_t one_minus_cos_d =
+    mulhi_64x64(d2, Q64_HALF - mulhi_64x64(d2, Q64_1_24 - mulhi_64x64(d2, Q64_1_720)));
+  uint64_t sin_j = sin_table[j], cos_j = sin_table[64 - j];
+  int64_t sin_f = (int64_t)(sin_j - mulhi_64x64(sin_j, one_minus_cos_d) + mulhi_64x64(cos_j, sin_d));
+  int64_t cos_f = (int64_t)(cos_j - mulhi_64x64(cos_j, one_minus_cos_d) - mulhi_64x64(sin_j, sin_d));
+
+  //sin(f * pi/2 + q * pi/2) is sin, cos, -sin, -cos of f * pi/2 for
+  //q = 0, 1, 2, 3 (mod 4), and sin(-x) = -sin(x)
+  int64_t v = (quadrant & 1) ? cos_f : sin_f;
+  bool negative = (v < 0) ^ ((quadrant & 2) != 0) ^ (!is_cos & val->negative);
+  //sin(0) = 0 and cos(0) = 1 are the only exactly representable results
+  if (mag == 0) {
+    fixpoint_inline_store(result, is_cos ? (uint64_t)1 << 32 : 0, false);
+    return RESULT_OK;
   }
+  store_truncated(result, v < 0 ? -(uint64_t)v : (uint64_t)v, 62, negative);
+  return RESULT_UNDERFLOW;
+}
+
+// Sorting helpers
+//
+// fixpoint_sort_n orders values by a key that preserves the order of
+// fixpoint_compare: the negative values come first, and within each
+// sign the unsigned 64 bit key is the magnitude (non-negative values)
+// or its complement (negative values). Together with the sign that
+// is 65 bits, so the values are partitioned by sign and only the 64
+// bit keys are radix sorted. A value is recovered from its key and
+// sign, so the sorted keys are written back without a payload.
+
+// Arrays shorter than this are sorted with introsort (which is faster
+// than the radix sort up to about 700 elements)
+#define SORT_RADIX_MIN 768
+
+// Introsort finishes ranges this short with insertion sort
+#define SORT_INSERTION_MAX 16
+
+// Helper function computing the sort key of a value (see above)
+static uint64_t
+sort_key( const fixpoint_t *val ) {
+  return fixpoint_inline_magnitude(val) ^ -(uint64_t)val->negative;
+}
+
+static bool
+sort_less( const fixpoint_t *left, const fixpoint_t *right ) {
+  return fixpoint_inline_compare(left, right) < 0;
 }
 
 static void
-handle_left_frac_greater_case( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  if(result->whole == 0) {
-    result->negative = left->negative;
-    result->frac = left->frac - right->frac;
-  } else {
-    if((!result->negative && !left->negative) || (result->negative && left->negative)){
-      uint64_t borrowed_calc = 0x100000000ULL + left->frac - right->frac;
-      result->frac = (uint32_t)borrowed_calc;
-    } else if ((result->negative && !left->negative) || (!result->negative && left->negative)){
-      result->whole -= 1;
-      uint64_t borrowed_calc = 0x100000000ULL + right->frac - left->frac;
-      result->frac = (uint32_t)borrowed_calc;
+sort_swap( fixpoint_t *a, fixpoint_t *b ) {
+  fixpoint_t t = *a;
+  *a = *b;
+  *b = t;
+}
+
+static void
+sort_insertion( fixpoint_t *vals, size_t n ) {
+  for (size_t i = 1; i < n; i++) {
+    fixpoint_t v = vals[i];
+    size_t j = i;
+    for (; j > 0 && sort_less(&v, &vals[j - 1]); j--) {
+      vals[j] = vals[j - 1];
     }
+    vals[j] = v;
   }
 }
 
-// Helper function for right > left fraction case  
+// Helper function restoring the max-heap property of the subtree of
+// vals[0..n) rooted at root
 static void
-handle_right_frac_greater_case( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  if(result->whole == 0) {
-    result->negative = !left->negative;
-    result->frac = right->frac - left->frac;
-  } else {
-    if((!result->negative && !left->negative) || (result->negative && left->negative)){
-      result->whole -= 1;
-      uint64_t borrowed_calc = 0x100000000ULL + left->frac - right->frac;
-      result->frac = (uint32_t)borrowed_calc;
-    } else if ((result->negative && !left->negative) || (!result->negative && left->negative)){
-      uint64_t borrowed_calc = 0x100000000ULL + right->frac - left->frac;
-      result->frac = (uint32_t)borrowed_calc;
+sort_sift_down( fixpoint_t *vals, size_t root, size_t n ) {
+  for (size_t child; (child = 2 * root + 1) < n; root = child) {
+    if (child + 1 < n && sort_less(&vals[child], &vals[child + 1])) {
+      child++;
+    }
+    if (!sort_less(&vals[root], &vals[child])) {
+      return;
     }
+    sort_swap(&vals[root], &vals[child]);
   }
 }
 
-// Helper function to handle subtraction fraction calculation
 static void
-handle_sub_fraction_calc( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  if (left->frac > right->frac) {
-    handle_left_frac_greater_case(result, left, right);
-  } else if (right->frac > left->frac) {
-    handle_right_frac_greater_case(result, left, right);
-  } else {
-    if(result->whole == 0) {
-      result->negative = false;
+sort_heapsort( fixpoint_t *vals, size_t n ) {
+  for (size_t i = n / 2; i-- > 0;) {
+    sort_sift_down(vals, i, n);
+  }
+  for (size_t end = n; end-- > 1;) {
+    sort_swap(&vals[0], &vals[end]);
+    sort_sift_down(vals, 0, end);
+  }
+}
+
+// Helper function sorting vals[0..n) with quicksort (median of three
+// pivot, Hoare partition), switching to heapsort after depth levels
+// so the worst case is O(n log n)
+static void
+sort_introsort( fixpoint_t *vals, size_t n, int depth ) {
+  while (n > SORT_INSERTION_MAX) {
+    if (depth-- == 0) {
+      sort_heapsort(vals, n);
+      return;
+    }
+
+    size_t mid = (n - 1) / 2;
+    if (sort_less(&vals[mid], &vals[0])) sort_swap(&vals[mid], &vals[0]);
+    if (sort_less(&vals[n - 1], &vals[mid])) sort_swap(&vals[n - 1], &vals[mid]);
+    if (sort_less(&vals[mid], &vals[0])) sort_swap(&vals[mid], &vals[0]);
+    fixpoint_t pivot = vals[mid];
+
+    size_t i = 0, j = n - 1;
+    for (;;) {
+      while (sort_less(&vals[i], &pivot)) i++;
+      while (sort_less(&pivot, &vals[j])) j--;
+      if (i >= j) break;
+      sort_swap(&vals[i++], &vals[j--]);
+    }
+
+    //recurse into the smaller part, loop on the larger
+    size_t left_n = j + 1;
+    if (left_n < n - left_n) {
+      sort_introsort(vals, left_n, depth);
+      vals += left_n;
+      n -= left_n;
+    } else {
+      sort_introsort(vals + left_n, n - left_n, depth);
+      n = left_n;
     }
-    result->frac = 0;
   }
+  sort_insertion(vals, n);
 }
 
-// Helper function to check if character is valid hex
-static bool
-is_valid_hex_char( char c ) {
-  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+// Helper function sorting keys[0..n) with an LSD radix sort on 8 bit
+// digits, using tmp (n elements) as the other buffer. The digit
+// counts for all passes are gathered in one pass over the keys, and
+// passes on digits that are the same in every key are skipped.
+// Returns the buffer (keys or tmp) holding the sorted keys.
+static uint64_t *
+sort_radix( uint64_t *keys, uint64_t *tmp, size_t n ) {
+  size_t counts[8][256];
+  memset(counts, 0, sizeof(counts));
+  for (size_t i = 0; i < n; i++) {
+    uint64_t k = keys[i];
+    for (int d = 0; d < 8; d++) {
+      counts[d][(k >> (8 * d)) & 0xFF]++;
+    }
+  }
+
+  uint64_t *src = keys, *dst = tmp;
+  for (int d = 0; d < 8 && n > 0; d++) {
+    unsigned shift = 8 * d;
+    if (counts[d][(src[0] >> shift) & 0xFF] == n) {
+      continue;
+    }
+    size_t offsets[256], offset = 0;
+    for (int b = 0; b < 256; b++) {
+      offsets[b] = offset;
+      offset += counts[d][b];
+    }
+    for (size_t i = 0; i < n; i++) {
+      uint64_t k = src[i];
+      dst[offsets[(k >> shift) & 0xFF]++] = k;
+    }
+    uint64_t *t = src;
+    src = dst;
+    dst = t;
+  }
+  return src;
+}
+
+// Extremes helpers
+//
+// fixpoint_min_n, fixpoint_max_n and fixpoint_stats_n compare values
+// by the pair (group, key), where group is 1 for non-negative values
+// and 0 for negative ones and key is the sort key: the pairs are in
+// the order of fixpoint_compare, and comparing them takes no
+// branches. Only strictly smaller (or larger) values replace the
+// current extreme, so it is the first one.
+
+typedef struct {
+  uint64_t group, key;
+  size_t index;
+} extreme_t;
+
+static inline void
+extreme_init( extreme_t *e, const fixpoint_t *val ) {
+  e->group = !val->negative;
+  e->key = sort_key(val);
+  e->index = 0;
+}
+
+static inline void
+extreme_update( extreme_t *e, const fixpoint_t *val, size_t i, bool is_max ) {
+  uint64_t group = !val->negative, key = sort_key(val);
+  bool less = (group < e->group) | ((group == e->group) & (key < e->key));
+  bool greater = (group > e->group) | ((group == e->group) & (key > e->key));
+  bool replace = is_max ? greater : less;
+  e->group = replace ? group : e->group;
+  e->key = replace ? key : e->key;
+  e->index = replace ? i : e->index;
 }
 
-// Helper function to validate whole part of hex string
+// Helper function storing the value of an extreme (recovered from its
+// key and group, as fixpoint_sort_n does)
+static void
+extreme_store( fixpoint_t *result, const extreme_t *e ) {
+  fixpoint_inline_store(result, e->key ^ (e->group - 1), !e->group);
+}
+
+// Helper function computing min or max (the body of fixpoint_min_n and
+// fixpoint_max_n)
 static bool
-validate_hex_whole_part( const char *str, int *cx, bool negative ) {
-  while (str[*cx] != '.') {
-    if (!is_valid_hex_char(str[*cx])) {
-      return false;
+handle_extreme( fixpoint_t *result, size_t *index, const fixpoint_t *vals, size_t n,
+                bool is_max ) {
+  if (n == 0) {
+    return false;
+  }
+  extreme_t e;
+  extreme_init(&e, &vals[0]);
+  for (size_t i = 1; i < n; i++) {
+    extreme_update(&e, &vals[i], i, is_max);
+  }
+  extreme_store(result, &e);
+  if (index) *index = e.index;
+  return true;
+}
+
+// Hex digit for each nibble value, used by fixpoint_format_hex
+static const char hex_digits[16] = {
+  '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+};
+
+// Value of each hex digit character, with bit 4 set to mark the
+// character as valid (all other characters map to 0)
+static const uint8_t hex_values[256] = {
+  ['0'] = 0x10, ['1'] = 0x11, ['2'] = 0x12, ['3'] = 0x13, ['4'] = 0x14,
+  ['5'] = 0x15, ['6'] = 0x16, ['7'] = 0x17, ['8'] = 0x18, ['9'] = 0x19,
+  ['a'] = 0x1A, ['b'] = 0x1B, ['c'] = 0x1C, ['d'] = 0x1D, ['e'] = 0x1E, ['f'] = 0x1F,
+  ['A'] = 0x1A, ['B'] = 0x1B, ['C'] = 0x1C, ['D'] = 0x1D, ['E'] = 0x1E, ['F'] = 0x1F,
+};
+
+// Helper function to accumulate at most 8 hex digits starting at *p.
+// Advances *p past the digits and returns the number of digits
+// consumed, or 9 if there were more than 8.
+static int
+parse_hex_digits( const char **p, uint32_t *value ) {
+  uint32_t acc = 0;
+  int n = 0;
+  uint8_t d;
+  while ((d = hex_values[(unsigned char)**p]) != 0) {
+    if (n == 8) {
+      return 9;
     }
-    (*cx)++;
+    acc = (acc << 4) | (d & 0xF);
+    (*p)++;
+    n++;
   }
-  (*cx)++;
-  if ((((*cx) > 10 || (*cx) < 3) && negative) || (((*cx) > 9 || (*cx) < 2) && !negative)) {
+  *value = acc;
+  return n;
+}
+
+// Helper function to parse one formatted hex value starting at *p
+// that must be followed by the character term. Reads at most 20
+// characters. If successful, *p is left pointing at the terminator.
+static bool
+parse_hex_value( const char **p, fixpoint_t *val, char term ) {
+  //determing if negative
+  val->negative = (**p == '-');
+  *p += val->negative;
+
+  //1 to 8 whole digits, then '.'
+  int digits = parse_hex_digits(p, &val->whole);
+  if (digits < 1 || digits > 8 || **p != '.') {
     return false;
   }
+  (*p)++;
+
+  //1 to 8 frac digits, then the terminator
+  digits = parse_hex_digits(p, &val->frac);
+  if (digits < 1 || digits > 8 || **p != term) {
+    return false;
+  }
+  //missing digits are trailing 0s
+  val->frac <<= 4 * (8 - digits);
+
+  //success
   return true;
 }
 
-// Helper function to validate fraction part of hex string
+// Number of characters the hex parsers may read starting at the
+// beginning of a value: an optional sign and one 32 byte SIMD
+// register (the scalar parser reads at most 20)
+#define HEX_PARSE_WINDOW 33
+
+typedef bool (*hex_parser_fn)( const char *, fixpoint_t *, char, size_t * );
+
+// Scalar hex parser: parses the value starting at p, which must be
+// followed by term, and sets *len to the number of characters
+// before the terminator
 static bool
-validate_hex_frac_part( const char *str, int *cx, int *digitsInFrac ) {
-  while (str[*cx] != '\0' && *digitsInFrac <= 8) {
-    (*digitsInFrac)++;
-    if (!is_valid_hex_char(str[*cx])) {
-      return false;
-    }
-    (*cx)++;
+parse_hex_scalar( const char *p, fixpoint_t *val, char term, size_t *len ) {
+  const char *start = p;
+  bool ok = parse_hex_value(&p, val, term);
+  *len = (size_t)(p - start);
+  return ok;
+}
+
+#ifdef FIXPOINT_X86
+
+#define SSE41 __attribute__((target("sse4.1")))
+#define AVX2 __attribute__((target("avx2")))
+
+// Helper function for the SIMD hex parsers: checks the same grammar
+// as parse_hex_value given the classified characters after the sign
+// (bit i of hex/dot/term is set if character i is a hex digit/'.'/
+// the terminator), and finds the number of whole and frac digits
+static inline bool
+check_hex_masks( uint32_t hex, uint32_t dot, uint32_t term,
+                 int *whole_digits, int *frac_digits ) {
+  //1 to 8 whole digits, then '.'
+  int w = __builtin_ctzll(~(uint64_t)hex);
+  if (w < 1 || w > 8 || !((dot >> w) & 1)) {
+    return false;
   }
-  if (*digitsInFrac > 8 || *digitsInFrac < 1) {
+
+  //1 to 8 frac digits, then the terminator
+  int f = __builtin_ctzll(~(uint64_t)(hex >> (w + 1)));
+  if (f < 1 || f > 8 || !((term >> (w + 1 + f)) & 1)) {
     return false;
   }
+
+  *whole_digits = w;
+  *frac_digits = f;
   return true;
 }
 
-// Helper function to validate hex string format
+// Convert 16 characters to the values of the hex digits among them
+// (the bytes for other characters are meaningless), and set the
+// bits of *hex for the characters that are hex digits
+SSE41 static inline __m128i
+sse41_hex_nibbles( __m128i v, uint32_t *hex ) {
+  __m128i digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+  __m128i is_digit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+  //setting bit 5 maps 'A'..'F' to 'a'..'f'
+  __m128i alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+  __m128i is_alpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+  *hex = (uint32_t)_mm_movemask_epi8(_mm_or_si128(is_digit, is_alpha));
+  return _mm_blendv_epi8(_mm_add_epi8(alpha, _mm_set1_epi8(10)), digit, is_digit);
+}
+
+// Combine the digits of a validated value: whole_nibbles holds the
+// values of the characters starting at the first whole digit, and
+// the frac digits are loaded from start + whole_digits + 1
+SSE41 static inline void
+sse41_pack_hex( fixpoint_t *val, const char *start, __m128i whole_nibbles,
+                int whole_digits, int frac_digits ) {
+  uint32_t hex;
+  __m128i frac_nibbles = sse41_hex_nibbles(
+    _mm_loadu_si128((const __m128i *)(start + whole_digits + 1)), &hex);
+
+  //right-align the whole digits in bytes 0..7: a negative shuffle
+  //index (bytes 8..15, and the leading bytes if there are fewer
+  //than 8 digits) gives a 0 byte
+  __m128i index = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                -64, -64, -64, -64, -64, -64, -64, -64);
+  __m128i whole = _mm_shuffle_epi8(whole_nibbles,
+                                   _mm_add_epi8(index, _mm_set1_epi8(whole_digits - 8)));
+
+  //left-align the frac digits in bytes 8..15, the missing digits
+  //are trailing 0s
+  __m128i keep = _mm_cmpgt_epi8(_mm_set1_epi8(frac_digits), index);
+  __m128i frac = _mm_and_si128(frac_nibbles, keep);
+
+  //combine pairs of nibbles into bytes, then 4 bytes (most
+  //significant first) into each 32 bit part
+  __m128i nibbles = _mm_unpacklo_epi64(whole, frac);
+  __m128i bytes = _mm_maddubs_epi16(nibbles, _mm_set1_epi16(0x0110));
+  bytes = _mm_packus_epi16(bytes, bytes);
+  bytes = _mm_shuffle_epi8(bytes, _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4,
+                                                3, 2, 1, 0, 7, 6, 5, 4));
+  uint64_t parts = (uint64_t)_mm_cvtsi128_si64(bytes);
+  val->whole = (uint32_t)parts;
+  val->frac = (uint32_t)(parts >> 32);
+}
+
+SSE41 static bool
+parse_hex_sse41( const char *p, fixpoint_t *val, char term, size_t *len ) {
+  val->negative = (*p == '-');
+  const char *start = p + val->negative;
+
+  __m128i v0 = _mm_loadu_si128((const __m128i *)start);
+  __m128i v1 = _mm_loadu_si128((const __m128i *)(start + 16));
+  uint32_t hex0, hex1;
+  __m128i nibbles = sse41_hex_nibbles(v0, &hex0);
+  sse41_hex_nibbles(v1, &hex1);
+  __m128i dots = _mm_set1_epi8('.'), terms = _mm_set1_epi8(term);
+  uint32_t dot = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v0, dots))
+               | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v1, dots)) << 16);
+  uint32_t tm = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v0, terms))
+              | ((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v1, terms)) << 16);
+
+  int whole_digits, frac_digits;
+  if (!check_hex_masks(hex0 | (hex1 << 16), dot, tm, &whole_digits, &frac_digits)) {
+    return false;
+  }
+  sse41_pack_hex(val, start, nibbles, whole_digits, frac_digits);
+  *len = val->negative + whole_digits + 1 + frac_digits;
+  return true;
+}
+
+AVX2 static bool
+parse_hex_avx2( const char *p, fixpoint_t *val, char term, size_t *len ) {
+  val->negative = (*p == '-');
+  const char *start = p + val->negative;
+
+  //classify all 32 characters at once
+  __m256i v = _mm256_loadu_si256((const __m256i *)start);
+  __m256i digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+  __m256i is_digit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+  __m256i alpha = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+  __m256i is_alpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+  uint32_t hex = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha));
+  uint32_t dot = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('.')));
+  uint32_t tm = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(term)));
+
+  int whole_digits, frac_digits;
+  if (!check_hex_masks(hex, dot, tm, &whole_digits, &frac_digits)) {
+    return false;
+  }
+  //the whole digits are all in the low half
+  __m128i nibbles = _mm_blendv_epi8(_mm_add_epi8(_mm256_castsi256_si128(alpha), _mm_set1_epi8(10)),
+                                    _mm256_castsi256_si128(digit), _mm256_castsi256_si128(is_digit));
+  sse41_pack_hex(val, start, nibbles, whole_digits, frac_digits);
+  *len = val->negative + whole_digits + 1 + frac_digits;
+  return true;
+}
+
+#endif // FIXPOINT_X86
+
+static bool isa_selected;
+static fixpoint_isa_t isa_in_use;
+
 static bool
-validate_hex_string( const char *str, int *cx, bool negative, int *digitsInFrac ) {
-  return validate_hex_whole_part(str, cx, negative) && 
-         validate_hex_frac_part(str, cx, digitsInFrac);
+isa_supported( fixpoint_isa_t isa ) {
+  switch (isa) {
+  case FIXPOINT_ISA_SCALAR:
+    return true;
+#ifdef FIXPOINT_X86
+  case FIXPOINT_ISA_SSE41:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+  case FIXPOINT_ISA_AVX2:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+  default:
+    return false;
+  }
+}
+
+// Hex parser for the selected instruction set
+static hex_parser_fn
+get_hex_parser( void ) {
+#ifdef FIXPOINT_X86
+  switch (fixpoint_get_isa()) {
+  case FIXPOINT_ISA_AVX2:
+    return parse_hex_avx2;
+  case FIXPOINT_ISA_SSE41:
+    return parse_hex_sse41;
+  default:
+    break;
+  }
+#endif
+  return parse_hex_scalar;
+}
+
+// Pairs of decimal digits "00".."99", so that two digits can be
+// written with one lookup
+static const char dec_pairs[200] =
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// Powers of 10 that fit in 32 bits
+static const uint32_t pow10_u32[10] = {
+  1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+// Number of fractional digits fixpoint_format_dec rounds to (before
+// removing trailing 0s). 10^-10 is less than half of 2^-32, so every
+// fraction is still the nearest one to its rounded decimal value.
+#define DEC_FRAC_DIGITS 10
+
+// Maximum number of fractional digits fixpoint_parse_dec accepts
+// (more than fit in a fixpoint_str_t), in groups of 9
+#define DEC_PARSE_MAX_GROUPS 5
+
+// Helper function to write the decimal digits of a whole part
+// (without leading 0s, at least one) at p, returning the number
+// of digits written
+static int
+format_dec_whole( char *p, uint32_t whole ) {
+  //estimate floor(log10) from the bit length (1233/4096 ~ log10(2)),
+  //then correct it with one comparison
+  int bits = 32 - __builtin_clz(whole | 1);
+  int guess = (bits * 1233) >> 12;
+  int digits = guess + 1 - ((whole | 1) < pow10_u32[guess]);
+
+  int i = digits;
+  while (whole >= 100) {
+    i -= 2;
+    memcpy(p + i, &dec_pairs[2 * (whole % 100)], 2);
+    whole /= 100;
+  }
+  if (whole >= 10) {
+    memcpy(p + i - 2, &dec_pairs[2 * whole], 2);
+  } else {
+    p[i - 1] = (char)('0' + whole);
+  }
+  return digits;
+}
+
+// Helper function to parse a formatted decimal value, see
+// fixpoint_parse_dec
+static bool
+parse_dec_value( const char *p, fixpoint_t *val ) {
+  val->negative = (*p == '-');
+  p += val->negative;
+
+  //1 to 10 whole digits, which must fit in 32 bits
+  uint64_t whole = 0;
+  int digits = 0;
+  while ((unsigned)(*p - '0') < 10 && digits <= 10) {
+    whole = whole * 10 + (uint64_t)(*p++ - '0');
+    digits++;
+  }
+  if (digits < 1 || digits > 10 || whole > UINT32_MAX || *p++ != '.') {
+    return false;
+  }
+
+  //frac digits in groups of 9 (the last one padded with trailing 0s),
+  //so each group is an integer less than 10^9
+  uint64_t groups[DEC_PARSE_MAX_GROUPS];
+  int ngroups = 0;
+  digits = 9;
+  while (digits == 9 && (unsigned)(*p - '0') < 10) {
+    if (ngroups == DEC_PARSE_MAX_GROUPS) {
+      return false;
+    }
+    uint32_t group = 0;
+    digits = 0;
+    while (digits < 9 && (unsigned)(*p - '0') < 10) {
+      group = group * 10 + (uint32_t)(*p++ - '0');
+      digits++;
+    }
+    groups[ngroups++] = (uint64_t)group * pow10_u32[9 - digits];
+  }
+  if (ngroups == 0 || *p != '\0') {
+    return false;
+  }
+
+  //multiply the fraction by 2^33, one group at a time from the least
+  //significant: what carries out of the first group is the 32 frac
+  //bits followed by the rounding bit, and the remainders are nonzero
+  //if any bits follow the rounding bit
+  uint64_t carry = 0, sticky = 0;
+  for (int i = ngroups - 1; i >= 0; i--) {
+    uint64_t x = (groups[i] << 33) + carry;
+    carry = x / 1000000000;
+    sticky |= x % 1000000000;
+  }
+
+  //round to nearest, ties to even
+  uint64_t frac = carry >> 1;
+  frac += (carry & 1) & ((sticky != 0) | (frac & 1));
+  whole += frac >> 32;
+  if (whole > UINT32_MAX) {
+    return false;
+  }
+  val->whole = (uint32_t)whole;
+  val->frac = (uint32_t)frac;
+  return true;
 }
 
 ////////////////////////////////////////////////////////////////////////
@@ -146,211 +1341,641 @@ validate_hex_string( const char *str, int *cx, bool negative, int *digitsInFrac
 
 void
 fixpoint_init( fixpoint_t *val, uint32_t whole, uint32_t frac, bool negative ) {
-  val->whole = whole;
-  val->frac = frac;
-  val->negative = negative;
+  fixpoint_inline_init( val, whole, frac, negative );
 }
 
 uint32_t
 fixpoint_get_whole( const fixpoint_t *val ) {
-  return val->whole;
+  return fixpoint_inline_get_whole( val );
 }
 
 uint32_t
 fixpoint_get_frac( const fixpoint_t *val ) {
-  return val->frac;
+  return fixpoint_inline_get_frac( val );
 }
 
 bool
 fixpoint_is_negative( const fixpoint_t *val ) {
-  return val->negative;
+  return fixpoint_inline_is_negative( val );
 }
 
 void
 fixpoint_negate( fixpoint_t *val ) {
-  // Special case: zero should never be negated
-  // For non-zero values, flip the sign
-  if (!(val->whole == 0 && val->frac == 0)) {
-    val->negative = !val->negative;
+  fixpoint_inline_negate( val );
+}
+
+result_t
+fixpoint_add( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return fixpoint_inline_add( result, left, right );
+}
+
+result_t
+fixpoint_sub( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return fixpoint_inline_sub( result, left, right );
+}
+
+result_t
+fixpoint_mul( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return fixpoint_inline_mul( result, left, right );
+}
+
+result_t
+fixpoint_fma( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+              const fixpoint_t *addend ) {
+  return handle_fma( result, left, right, addend );
+}
+
+result_t
+fixpoint_add_sat( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return handle_add_sub_sat( result, left, right, false );
+}
+
+result_t
+fixpoint_sub_sat( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return handle_add_sub_sat( result, left, right, true );
+}
+
+result_t
+fixpoint_mul_sat( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return handle_mul_round( result, left, right, 0, false, true );
+}
+
+result_t
+fixpoint_mul_rne( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return handle_mul_round( result, left, right, 0x7FFFFFFF, true, false );
+}
+
+result_t
+fixpoint_mul_stochastic( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+                         uint32_t random ) {
+  return handle_mul_round( result, left, right, random, false, false );
+}
+
+result_t
+fixpoint_div( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return handle_div( result, left, right );
+}
+
+void
+fixpoint_recip_init( fixpoint_recip_t *recip, const fixpoint_t *divisor ) {
+  uint64_t mag = fixpoint_inline_magnitude(divisor);
+  recip->negative = divisor->negative;
+  if (mag == 0) {
+    recip->divisor = 0;
+    recip->inverse = 0;
+    recip->shift = 0;
+    recip->scale = 0;
+    return;
+  }
+
+  //normalize so the top bit is set, then the reciprocal is
+  //floor((2^128 - 1) / d) - 2^64
+  recip->shift = (unsigned)__builtin_clzll(mag);
+  recip->divisor = mag << recip->shift;
+  recip->scale = (uint64_t)1 << ((32 + recip->shift) % 64);
+  uint64_t rem;
+  recip->inverse = div_128_64(~recip->divisor, UINT64_MAX, recip->divisor, &rem);
+}
+
+result_t
+fixpoint_div_recip( fixpoint_t *result, const fixpoint_t *left, const fixpoint_recip_t *recip ) {
+  return handle_div_recip( result, left, recip );
+}
+
+result_t
+fixpoint_sqrt( fixpoint_t *result, const fixpoint_t *val ) {
+  return handle_sqrt( result, val );
+}
+
+result_t
+fixpoint_exp( fixpoint_t *result, const fixpoint_t *val ) {
+  return handle_exp( result, val );
+}
+
+result_t
+fixpoint_log( fixpoint_t *result, const fixpoint_t *val ) {
+  return handle_log( result, val );
+}
+
+result_t
+fixpoint_sin( fixpoint_t *result, const fixpoint_t *val ) {
+  return handle_sin_cos( result, val, false );
+}
+
+result_t
+fixpoint_cos( fixpoint_t *result, const fixpoint_t *val ) {
+  return handle_sin_cos( result, val, true );
+}
+
+int
+fixpoint_compare( const fixpoint_t *left, const fixpoint_t *right ) {
+  return fixpoint_inline_compare( left, right );
+}
+
+void
+fixpoint_format_hex( fixpoint_str_t *s, const fixpoint_t *val ) {
+  char *p = s->str;
+  //adds - for negative (always written, only kept if negative)
+  *p = '-';
+  p += val->negative;
+
+  //number of whole digits without leading 0s (at least one)
+  int whole_digits = val->whole ? (35 - __builtin_clz(val->whole)) / 4 : 1;
+  uint32_t whole = val->whole;
+  for (int i = whole_digits - 1; i >= 0; i--) {
+    p[i] = hex_digits[whole & 0xF];
+    whole >>= 4;
+  }
+  p += whole_digits;
+  *p++ = '.';
+
+  //number of frac digits without trailing 0s (at least one)
+  int frac_digits = val->frac ? 8 - __builtin_ctz(val->frac) / 4 : 1;
+  for (int i = 0; i < frac_digits; i++) {
+    p[i] = hex_digits[(val->frac >> (28 - 4 * i)) & 0xF];
+  }
+  p[frac_digits] = '\0';
+}
+
+bool
+fixpoint_parse_hex( fixpoint_t *val, const fixpoint_str_t *s ) {
+  //fixpoint_str_t is large enough for the SIMD parsers to read
+  //HEX_PARSE_WINDOW characters
+  size_t len;
+  return get_hex_parser()(s->str, val, '\0', &len);
+}
+
+void
+fixpoint_format_dec( fixpoint_str_t *s, const fixpoint_t *val ) {
+  char *p = s->str;
+  //adds - for negative (always written, only kept if negative)
+  *p = '-';
+  p += val->negative;
+
+  p += format_dec_whole(p, val->whole);
+  *p++ = '.';
+
+  //frac digits by repeated multiplication by 100: the integer part
+  //of the product is the next pair of digits, and the fractional
+  //part (exact, in the low 32 bits) is carried on
+  uint64_t x = val->frac;
+  for (int i = 0; i < DEC_FRAC_DIGITS; i += 2) {
+    x *= 100;
+    memcpy(p + i, &dec_pairs[2 * (x >> 32)], 2);
+    x &= 0xFFFFFFFF;
+  }
+
+  //round to nearest, ties to even, using the exact remainder x
+  //(the carry never reaches the decimal point, since the largest
+  //fraction rounds to .9999999998)
+  if (x > 0x80000000 || (x == 0x80000000 && (p[DEC_FRAC_DIGITS - 1] & 1))) {
+    int i = DEC_FRAC_DIGITS - 1;
+    while (p[i] == '9') {
+      p[i--] = '0';
+    }
+    p[i]++;
+  }
+
+  //remove trailing 0s (keeping at least one digit)
+  int frac_digits = DEC_FRAC_DIGITS;
+  while (frac_digits > 1 && p[frac_digits - 1] == '0') {
+    frac_digits--;
+  }
+  p[frac_digits] = '\0';
+}
+
+bool
+fixpoint_parse_dec( fixpoint_t *val, const fixpoint_str_t *s ) {
+  return parse_dec_value(s->str, val);
+}
+
+fixpoint_isa_t
+fixpoint_get_isa( void ) {
+  if (!isa_selected) {
+    //the best supported instruction set
+    isa_in_use = FIXPOINT_ISA_AVX2;
+    while (!isa_supported(isa_in_use)) {
+      isa_in_use--;
+    }
+    isa_selected = true;
+  }
+  return isa_in_use;
+}
+
+bool
+fixpoint_set_isa( fixpoint_isa_t isa ) {
+  if (!isa_supported(isa)) {
+    return false;
+  }
+  isa_in_use = isa;
+  isa_selected = true;
+  return true;
+}
+
+size_t
+fixpoint_parse_hex_buffer( fixpoint_t *vals, size_t max_vals, const char *buf, size_t len,
+                           size_t *end_offset ) {
+  const char *p = buf;
+  const char *end = buf + len;
+  size_t n = 0;
+  hex_parser_fn parse = get_hex_parser();
+
+  while (p < end && n < max_vals) {
+    const char *line = p;
+    bool ok;
+    size_t line_len;
+    if (end - p >= HEX_PARSE_WINDOW) {
+      //fast path: the whole line can be read in place
+      ok = parse(p, &vals[n], '\n', &line_len);
+    } else {
+      //near the end of the buffer, parse a copy of the rest of it,
+      //with a \n added (for an unterminated last line) and padded to
+      //the window, so the parsers never read past the end and accept
+      //the same lines as in the fast path
+      char tail[HEX_PARSE_WINDOW + 1] = { 0 };
+      memcpy(tail, p, (size_t)(end - p));
+      tail[end - p] = '\n';
+      ok = parse(tail, &vals[n], '\n', &line_len);
+    }
+    if (!ok) {
+      *end_offset = (size_t)(line - buf);
+      return n;
+    }
+    p += line_len + 1;
+    if (p > end) {
+      p = end;
+    }
+    n++;
+  }
+
+  *end_offset = (size_t)(p - buf);
+  return n;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Batch API functions
+//
+// Each loop body is the same static helper used by the scalar
+// function, so the compiler can inline it. When flags is NULL a
+// separate loop without the per-element store is used.
+////////////////////////////////////////////////////////////////////////
+
+result_t
+fixpoint_add_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                const fixpoint_t *restrict right, size_t n, result_t *restrict flags ) {
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = fixpoint_inline_add(&result[i], &left[i], &right[i]);
+      all |= flags[i];
+    }
   } else {
-    val->negative = false;
+    for (size_t i = 0; i < n; i++) {
+      all |= fixpoint_inline_add(&result[i], &left[i], &right[i]);
+    }
   }
+  return all;
 }
 
 result_t
-fixpoint_add( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  //if opposite signs, negates the negative one and calls sub
-  if (left->negative ^ right->negative) {
-    if(left->negative) {
-      fixpoint_t newLeft = *left;
-      fixpoint_negate(&newLeft);
-      result_t to_return = fixpoint_sub(result, &newLeft, right);
-      //negates if left was negative because should be neg after
-      fixpoint_negate(result);
-      return to_return;
+fixpoint_sub_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                const fixpoint_t *restrict right, size_t n, result_t *restrict flags ) {
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = fixpoint_inline_sub(&result[i], &left[i], &right[i]);
+      all |= flags[i];
     }
-    if(right->negative) {
-      fixpoint_t newRight = *right;
-      fixpoint_negate(&newRight);
-      return fixpoint_sub(result, left, &newRight);
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= fixpoint_inline_sub(&result[i], &left[i], &right[i]);
     }
   }
+  return all;
+}
 
-  //executes addition
-  return handle_addition( result, left, right );
+result_t
+fixpoint_mul_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                const fixpoint_t *restrict right, size_t n, result_t *restrict flags ) {
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = fixpoint_inline_mul(&result[i], &left[i], &right[i]);
+      all |= flags[i];
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= fixpoint_inline_mul(&result[i], &left[i], &right[i]);
+    }
+  }
+  return all;
 }
 
 result_t
-fixpoint_sub( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  //if opposite signs, negates the negative one and calls add
-  if (left->negative ^ right->negative) {
-    if(left->negative) {
-      fixpoint_t newLeft = *left;
-      fixpoint_negate(&newLeft);
-      result_t res = fixpoint_add(result, &newLeft, right);
-      //manually set the sign since negate won't work on zero
-      if (res == RESULT_OVERFLOW && result->whole == 0 && result->frac == 0) {
-        result->negative = true;
-      } else {
-        fixpoint_negate(result);
-      }
-      return res;
+fixpoint_add_sat_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                    const fixpoint_t *restrict right, size_t n, result_t *restrict flags ) {
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = handle_add_sub_sat(&result[i], &left[i], &right[i], false);
+      all |= flags[i];
     }
-    if(right->negative) {
-      fixpoint_t newRight = *right;
-      fixpoint_negate(&newRight);
-      return fixpoint_add(result, left, &newRight);
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= handle_add_sub_sat(&result[i], &left[i], &right[i], false);
     }
   }
+  return all;
+}
 
-  //takes into account which whole is bigger and subtracts/sets negative
-  handle_whole_sub_calc (result, left, right);
+result_t
+fixpoint_sub_sat_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                    const fixpoint_t *restrict right, size_t n, result_t *restrict flags ) {
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = handle_add_sub_sat(&result[i], &left[i], &right[i], true);
+      all |= flags[i];
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= handle_add_sub_sat(&result[i], &left[i], &right[i], true);
+    }
+  }
+  return all;
+}
 
-  //handle fraction calculation
-  handle_sub_fraction_calc(result, left, right);
-  return RESULT_OK;
+result_t
+fixpoint_mul_sat_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                    const fixpoint_t *restrict right, size_t n, result_t *restrict flags ) {
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = handle_mul_round(&result[i], &left[i], &right[i], 0, false, true);
+      all |= flags[i];
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= handle_mul_round(&result[i], &left[i], &right[i], 0, false, true);
+    }
+  }
+  return all;
 }
 
 result_t
-fixpoint_mul( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
-  //multiplies both parts first number by both parts second and stores in 64 bit
-  uint64_t p0 = (uint64_t)left->frac * right->frac;  
-  uint64_t p1 = (uint64_t)left->frac * right->whole;  
-  uint64_t p2 = (uint64_t)left->whole * right->frac;  
-  uint64_t p3 = (uint64_t)left->whole * right->whole;  
+fixpoint_mul_rne_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                    const fixpoint_t *restrict right, size_t n, result_t *restrict flags ) {
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = handle_mul_round(&result[i], &left[i], &right[i], 0x7FFFFFFF, true, false);
+      all |= flags[i];
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= handle_mul_round(&result[i], &left[i], &right[i], 0x7FFFFFFF, true, false);
+    }
+  }
+  return all;
+}
 
-  //handles adding together the parts and truncating the bits
-  uint64_t middle_sum = p1 + p2 + (p0 >> 32);
-  result->whole = (uint32_t)p3 + (uint32_t)(middle_sum >> 32);
+result_t
+fixpoint_mul_stochastic_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                           const fixpoint_t *restrict right, size_t n, uint64_t *seed,
+                           result_t *restrict flags ) {
+  uint64_t state = *seed;
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = handle_mul_round(&result[i], &left[i], &right[i], stochastic_next(&state), false, false);
+      all |= flags[i];
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= handle_mul_round(&result[i], &left[i], &right[i], stochastic_next(&state), false, false);
+    }
+  }
+  *seed = state;
+  return all;
+}
 
-  result->frac = (uint32_t)middle_sum;
-  //sign handling
-  result->negative = left->negative ^ right->negative;
+result_t
+fixpoint_div_recip_n( fixpoint_t *restrict result, const fixpoint_t *restrict left,
+                      const fixpoint_recip_t *recip, size_t n, result_t *restrict flags ) {
+  //work on a copy, otherwise the compiler reloads *recip after
+  //every store to result
+  const fixpoint_recip_t recip_copy = *recip;
+  recip = &recip_copy;
+  result_t all = RESULT_OK;
+  if (flags) {
+    for (size_t i = 0; i < n; i++) {
+      flags[i] = handle_div_recip(&result[i], &left[i], recip);
+      all |= flags[i];
+    }
+  } else {
+    for (size_t i = 0; i < n; i++) {
+      all |= handle_div_recip(&result[i], &left[i], recip);
+    }
+  }
+  return all;
+}
 
-  //check overflow/underflow
-  result_t ret = RESULT_OK;
+void
+fixpoint_compare_n( int *restrict result, const fixpoint_t *restrict left,
+                    const fixpoint_t *restrict right, size_t n ) {
+  for (size_t i = 0; i < n; i++) {
+    result[i] = fixpoint_inline_compare(&left[i], &right[i]);
+  }
+}
 
-  //overflow
-  uint64_t final_whole = (uint64_t)(uint32_t)p3 + (uint32_t)(middle_sum >> 32);
-  if ((p3 >> 32) != 0 || (final_whole >> 32) != 0) {
-    ret |= RESULT_OVERFLOW;
+void
+fixpoint_sort_n( fixpoint_t *vals, size_t n ) {
+  int depth = n > 1 ? 2 * (63 - __builtin_clzll(n)) : 0;
+  uint64_t *keys = n >= SORT_RADIX_MIN ? malloc(2 * n * sizeof(uint64_t)) : NULL;
+  if (!keys) {
+    sort_introsort(vals, n, depth);
+    return;
   }
+  uint64_t *tmp = keys + n;
 
-  //underflow
-  if ((p0 & 0xFFFFFFFF) != 0) {
-    ret |= RESULT_UNDERFLOW;
+  //partition the keys by sign, negatives first
+  size_t nneg = 0;
+  for (size_t i = 0; i < n; i++) {
+    nneg += vals[i].negative;
   }
-  if (ret == RESULT_OK && result->whole == 0 && result->frac == 0) {
-    result->negative = false;
+  size_t neg_i = 0, pos_i = nneg;
+  for (size_t i = 0; i < n; i++) {
+    bool negative = vals[i].negative;
+    keys[negative ? neg_i : pos_i] = sort_key(&vals[i]);
+    neg_i += negative;
+    pos_i += !negative;
   }
 
-  return ret;
+  const uint64_t *neg_keys = sort_radix(keys, tmp, nneg);
+  const uint64_t *pos_keys = sort_radix(keys + nneg, tmp + nneg, n - nneg);
+  for (size_t i = 0; i < nneg; i++) {
+    fixpoint_inline_store(&vals[i], ~neg_keys[i], true);
+  }
+  for (size_t i = 0; i < n - nneg; i++) {
+    fixpoint_inline_store(&vals[nneg + i], pos_keys[i], false);
+  }
+  free(keys);
 }
 
-int
-fixpoint_compare( const fixpoint_t *left, const fixpoint_t *right ) {
-  //if differing signs the negative is smallest
-  if (left->negative ^ right->negative) {
-    if (left->negative) return -1;
-    if (right->negative) return 1;
-  }
-  int toReturn = 0;
-  //sets return value for if both are positive
-  if (left->whole < right->whole) {
-    toReturn = -1;
-  } else if (left->whole > right->whole) {
-    toReturn = 1;
-  } else if (left->frac < right->frac) {
-    toReturn = -1;
-  } else if (left->frac > right->frac) {
-    toReturn = 1;
-  }
-  //if same returns 0
-  if(!toReturn) return toReturn;
-  //if both are negative returns opposite
-  if(left->negative) return toReturn *-1;
-  //if both positive, return regular
-  return toReturn;
+void
+fixpoint_format_dec_n( fixpoint_str_t *restrict strs, const fixpoint_t *restrict vals, size_t n ) {
+  for (size_t i = 0; i < n; i++) {
+    fixpoint_format_dec(&strs[i], &vals[i]);
+  }
 }
 
-void
-fixpoint_format_hex( fixpoint_str_t *s, const fixpoint_t *val ) {
-  int cx = 0;
-  //adds - for negative
-  if (val->negative) {
-    s->str[0] = '-';
-    cx = 1;
+size_t
+fixpoint_parse_dec_n( fixpoint_t *restrict vals, const fixpoint_str_t *restrict strs, size_t n,
+                      bool *restrict ok ) {
+  size_t count = 0;
+  for (size_t i = 0; i < n; i++) {
+    bool parsed = parse_dec_value(strs[i].str, &vals[i]);
+    if (ok) {
+      ok[i] = parsed;
+    }
+    count += parsed;
   }
- 
-  //adds hexstring and '.' for whole
-  cx += snprintf(s->str + cx, FIXPOINT_STR_MAX_SIZE - cx, "%x.", val->whole);
+  return count;
+}
 
-  //if just 0, adds 0 to frac, if not, adds hexstring then removes all trailing 0s
-  if (val->frac == 0) {
-    cx += snprintf(s->str + cx, FIXPOINT_STR_MAX_SIZE - cx, "%d", 0);
-  } else {
-    cx += snprintf(s->str + cx, FIXPOINT_STR_MAX_SIZE - cx, "%08x", val->frac);
-    while (s->str[cx - 1] == '0') {
-      s->str[cx - 1] = '\0';
-      cx--;
+////////////////////////////////////////////////////////////////////////
+// Reduction functions
+//
+// The loops are unrolled by two with separate sets of digit
+// accumulators (see REDUCE_DIGITS), which are only combined, and
+// checked for overflow, once the whole array has been added up.
+////////////////////////////////////////////////////////////////////////
+
+result_t
+fixpoint_sum_n( fixpoint_t *result, const fixpoint_t *vals, size_t n ) {
+  uint64_t total[3] = { 0, 0, 0 };
+  for (size_t begin = 0; begin < n; begin += REDUCE_CHUNK) {
+    size_t end = n - begin < REDUCE_CHUNK ? n : begin + REDUCE_CHUNK;
+    int64_t acc0[REDUCE_DIGITS] = { 0 }, acc1[REDUCE_DIGITS] = { 0 };
+    size_t i = begin;
+    for (; i + 2 <= end; i += 2) {
+      sum_accumulate(acc0, &vals[i]);
+      sum_accumulate(acc1, &vals[i + 1]);
+    }
+    if (i < end) {
+      sum_accumulate(acc0, &vals[i]);
+    }
+    for (unsigned d = 0; d < REDUCE_DIGITS; d++) {
+      reduce_fold(total, acc0[d], d);
+      reduce_fold(total, acc1[d], d);
     }
   }
+  return reduce_store(result, total);
 }
 
 bool
-fixpoint_parse_hex( fixpoint_t *val, const fixpoint_str_t *s ) {
-  //buffer for parsing making sure everything is right
-  int cx = 0;
-  int digitsInFrac = 0;
-  //allow adding trailing 0s by modifying base string
-  char newStr [FIXPOINT_STR_MAX_SIZE];
-  strcpy(newStr, s->str);
+fixpoint_min_n( fixpoint_t *result, size_t *index, const fixpoint_t *vals, size_t n ) {
+  return handle_extreme(result, index, vals, n, false);
+}
 
-  //determing if negative
-  if (newStr[0] == '-') {
-    val->negative = true;
-    cx++;
-  } else {
-    val->negative = false;
-  }
+bool
+fixpoint_max_n( fixpoint_t *result, size_t *index, const fixpoint_t *vals, size_t n ) {
+  return handle_extreme(result, index, vals, n, true);
+}
+
+result_t
+fixpoint_stats_n( fixpoint_stats_t *stats, const fixpoint_t *vals, size_t n ) {
+  static const fixpoint_t zero = { 0, 0, false };
+  extreme_t min, max;
+  extreme_init(&min, n > 0 ? &vals[0] : &zero);
+  max = min;
 
-  //validate string format
-  if (!validate_hex_string(newStr, &cx, val->negative, &digitsInFrac)) {
-    return 0;
+  //the same digit accumulation as fixpoint_sum_n, in the same loop
+  //as the extremes
+  uint64_t total[3] = { 0, 0, 0 };
+  for (size_t begin = 0; begin < n; begin += REDUCE_CHUNK) {
+    size_t end = n - begin < REDUCE_CHUNK ? n : begin + REDUCE_CHUNK;
+    int64_t acc[REDUCE_DIGITS] = { 0 };
+    for (size_t i = begin; i < end; i++) {
+      sum_accumulate(acc, &vals[i]);
+      extreme_update(&min, &vals[i], i, false);
+      extreme_update(&max, &vals[i], i, true);
+    }
+    for (unsigned d = 0; d < REDUCE_DIGITS; d++) {
+      reduce_fold(total, acc[d], d);
+    }
   }
 
-  //add 0s to end of string
-  int len = strlen(newStr);
-  while (digitsInFrac < 8) {
-      newStr[len++] = '0';
-      digitsInFrac++;
+  stats->count = n;
+  extreme_store(&stats->min, &min);
+  extreme_store(&stats->max, &max);
+  stats->argmin = min.index;
+  stats->argmax = max.index;
+  return reduce_store(&stats->sum, total);
+}
+
+bool
+fixpoint_histogram_n( size_t *counts, size_t nbuckets, const fixpoint_t *lo, const fixpoint_t *width,
+                      const fixpoint_t *vals, size_t n ) {
+  uint64_t w = fixpoint_inline_magnitude(width);
+  if (w == 0 || width->negative) {
+    return false;
   }
-  newStr[len] = '\0';
+  //floor(d / w) for d < 2^64 is within 2 of mulhi(d, recip)
+  uint64_t recip = UINT64_MAX / w;
+  //lo as a 128 bit two's complement value (a negative 0 is 0)
+  uint64_t lo_mag = fixpoint_inline_magnitude(lo);
+  uint64_t lo_mask = -(uint64_t)(lo->negative & (lo_mag != 0));
+  uint64_t lo_lo = (lo_mag ^ lo_mask) - lo_mask, lo_hi = lo_mask;
 
-  //put values in correct spots
-  if(!val->negative) sscanf (newStr, "%x%*c%x", &val->whole, &val->frac);
-  if(val->negative) sscanf (newStr, "%*c%x%*c%x", &val->whole, &val->frac);
+  for (size_t i = 0; i < n; i++) {
+    //d = vals[i] - lo, in 128 bit two's complement
+    uint64_t mag = fixpoint_inline_magnitude(&vals[i]);
+    uint64_t mask = -(uint64_t)(vals[i].negative & (mag != 0));
+    uint64_t d_lo;
+    bool borrow = __builtin_sub_overflow((mag ^ mask) - mask, lo_lo, &d_lo);
+    uint64_t d_hi = mask - lo_hi - borrow;
 
-  //success
-  return 1;
+    uint64_t q;
+    if (__builtin_expect(d_hi == 0, 1)) {
+      q = mulhi_64x64(d_lo, recip);
+      uint64_t r = d_lo - q * w;
+      bool c = r >= w;
+      q += c;
+      r -= c ? w : 0;
+      q += r >= w;
+    } else if (d_hi == 1 && w > 1) {
+      //2^64 <= d < 2^65 (only for huge buckets)
+      uint64_t rem;
+      q = div_128_64(d_hi, d_lo, w, &rem);
+    } else {
+      q = UINT64_MAX;
+    }
+    //d < 0 goes to counts[0], q >= nbuckets to counts[nbuckets + 1]
+    size_t bucket = q < nbuckets ? (size_t)q + 1 : nbuckets + 1;
+    counts[(d_hi >> 63) ? 0 : bucket]++;
+  }
+  return true;
+}
+
+result_t
+fixpoint_dot_n( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right, size_t n ) {
+  uint64_t total[3] = { 0, 0, 0 };
+  for (size_t begin = 0; begin < n; begin += REDUCE_CHUNK) {
+    size_t end = n - begin < REDUCE_CHUNK ? n : begin + REDUCE_CHUNK;
+    int64_t acc0[REDUCE_DIGITS] = { 0 }, acc1[REDUCE_DIGITS] = { 0 };
+    size_t i = begin;
+    for (; i + 2 <= end; i += 2) {
+      dot_accumulate(acc0, &left[i], &right[i]);
+      dot_accumulate(acc1, &left[i + 1], &right[i + 1]);
+    }
+    if (i < end) {
+      dot_accumulate(acc0, &left[i], &right[i]);
+    }
+    for (unsigned d = 0; d < REDUCE_DIGITS; d++) {
+      reduce_fold(total, acc0[d], d);
+      reduce_fold(total, acc1[d], d);
+    }
+  }
+  return reduce_store(result, total);
 }
@@ -5,6 +5,17 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// restrict is not a C++ keyword
+#ifdef __cplusplus
+#define FIXPOINT_RESTRICT __restrict
+#else
+#define FIXPOINT_RESTRICT restrict
+#endif
+
 ////////////////////////////////////////////////////////////////////////
 // Data types
 ////////////////////////////////////////////////////////////////////////
@@ -48,6 +59,35 @@ typedef struct {
 
 #define RESULT_OK 0
 
+//! Instruction sets the optimized kernels can use.
+typedef enum {
+  FIXPOINT_ISA_SCALAR, //!< portable C
+  FIXPOINT_ISA_SSE41,  //!< SSE4.1
+  FIXPOINT_ISA_AVX2,   //!< AVX2
+} fixpoint_isa_t;
+
+//! Statistics of an array, computed in one pass by fixpoint_stats_n.
+typedef struct {
+  size_t count;      //!< number of values
+  fixpoint_t min;    //!< smallest value
+  fixpoint_t max;    //!< largest value
+  size_t argmin;     //!< index of the first smallest value
+  size_t argmax;     //!< index of the first largest value
+  fixpoint_t sum;    //!< sum of the values
+} fixpoint_stats_t;
+
+//! Precomputed reciprocal of a divisor, for dividing many values by
+//! the same divisor with fixpoint_div_recip or fixpoint_div_recip_n
+//! (each division becomes two multiplications and a correction).
+//! Initialize it with fixpoint_recip_init.
+typedef struct {
+  uint64_t divisor;  //!< magnitude of the divisor, shifted left until the top bit is set (0 if the divisor is 0)
+  uint64_t inverse;  //!< floor((2^128 - 1) / divisor) - 2^64
+  uint64_t scale;    //!< 2^((32 + shift) % 64), used to shift dividends
+  unsigned shift;    //!< number of bits divisor was shifted by
+  bool negative;     //!< true if the divisor is negative
+} fixpoint_recip_t;
+
 ////////////////////////////////////////////////////////////////////////
 // Public API functions
 ////////////////////////////////////////////////////////////////////////
@@ -146,6 +186,187 @@ fixpoint_sub( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *righ
 result_t
 fixpoint_mul( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
 
+//! Compute left * right + addend with a single truncation. The
+//! exact 128-bit product (as computed by fixpoint_mul) is added to
+//! the addend, and then the high and low 32 bits of the exact sum
+//! are discarded, as fixpoint_mul does with the product. The result
+//! is the same as fixpoint_mul followed by fixpoint_add whenever
+//! fixpoint_mul would return RESULT_OK, and at least as accurate
+//! otherwise.
+//!
+//! @param result pointer to result fixpoint_t instance (where the
+//!               result is stored)
+//! @param left pointer to left value to be multiplied
+//! @param right pointer to right value to be multiplied
+//! @param addend pointer to the value added to the product
+//! @return RESULT_OK, or RESULT_OVERFLOW (the high 32 bits of the
+//!         exact sum were not all 0), or RESULT_UNDERFLOW (the low
+//!         32 bits of the exact sum were not all 0), or both
+result_t
+fixpoint_fma( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+              const fixpoint_t *addend );
+
+//! Compute the sum of two fixpoint_t values, saturating: same as
+//! fixpoint_add, except that on overflow the largest magnitude
+//! (0xFFFFFFFF.FFFFFFFF) is stored, with the sign of the exact sum.
+//!
+//! @param result pointer to result fixpoint_t instance (where the sum is stored)
+//! @param left the left value to be added
+//! @param right the right value to be added
+//! @return RESULT_OK or RESULT_OVERFLOW (the sum was clamped)
+result_t
+fixpoint_add_sat( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
+
+//! Compute the difference of two fixpoint_t values, saturating (see
+//! fixpoint_add_sat).
+//!
+//! @param result pointer to result fixpoint_t instance (where the difference is stored)
+//! @param left the left value in the subtraction (the minuend)
+//! @param right the right value in the subtraction (the subtrahend)
+//! @return RESULT_OK or RESULT_OVERFLOW (the difference was clamped)
+result_t
+fixpoint_sub_sat( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
+
+//! Compute the product of two fixpoint_t values, saturating: same as
+//! fixpoint_mul, except that on overflow the largest magnitude is
+//! stored, with the sign of the exact product.
+//!
+//! @param result pointer to result fixpoint_t instance (where product is stored)
+//! @param left pointer to left value to be multiplied
+//! @param right pointer to right value to be multiplied
+//! @return as for fixpoint_mul (RESULT_OVERFLOW means the product
+//!         was clamped)
+result_t
+fixpoint_mul_sat( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
+
+//! Compute the product of two fixpoint_t values, rounded to the
+//! nearest multiple of 2^-32 (ties to even) instead of truncated.
+//! Overflow is handled as in fixpoint_mul (the high 32 bits of the
+//! rounded product are discarded).
+//!
+//! @param result pointer to result fixpoint_t instance (where product is stored)
+//! @param left pointer to left value to be multiplied
+//! @param right pointer to right value to be multiplied
+//! @return RESULT_OK, or RESULT_OVERFLOW (the high 32 bits of the
+//!         rounded product were not all 0), or RESULT_UNDERFLOW (the
+//!         product was rounded), or both
+result_t
+fixpoint_mul_rne( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
+
+//! Compute the product of two fixpoint_t values with stochastic
+//! rounding: the magnitude is rounded up when the discarded low 32
+//! bits of the exact product plus random carry into the kept bits, so
+//! for a uniformly distributed random value the product is rounded up
+//! with probability (low 32 bits) / 2^32, and the result is unbiased.
+//! Otherwise the same as fixpoint_mul_rne.
+//!
+//! @param result pointer to result fixpoint_t instance (where product is stored)
+//! @param left pointer to left value to be multiplied
+//! @param right pointer to right value to be multiplied
+//! @param random 32 random bits
+//! @return as for fixpoint_mul_rne
+result_t
+fixpoint_mul_stochastic( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+                         uint32_t random );
+
+//! Compute the quotient of two fixpoint_t values.
+//! The exact quotient is truncated (towards 0) to 32 fractional bits.
+//! Dividing by 0 stores the largest magnitude (0xFFFFFFFF.FFFFFFFF),
+//! with the sign of left * right, and returns RESULT_OVERFLOW.
+//!
+//! @param result pointer to result fixpoint_t instance (where the
+//!               quotient is stored)
+//! @param left pointer to the dividend
+//! @param right pointer to the divisor
+//! @return RESULT_OK, or RESULT_OVERFLOW (the whole part of the
+//!         quotient does not fit in 32 bits), or RESULT_UNDERFLOW
+//!         (nonzero bits of the quotient were truncated), or
+//!         (RESULT_OVERFLOW|RESULT_UNDERFLOW)
+result_t
+fixpoint_div( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
+
+//! Precompute the reciprocal of a divisor (which may be 0).
+//!
+//! @param recip pointer to the fixpoint_recip_t to initialize
+//! @param divisor pointer to the divisor
+void
+fixpoint_recip_init( fixpoint_recip_t *recip, const fixpoint_t *divisor );
+
+//! Divide by a divisor whose reciprocal was computed with
+//! fixpoint_recip_init. The stored value and the return value are
+//! identical to those of fixpoint_div.
+//!
+//! @param result pointer to result fixpoint_t instance (where the
+//!               quotient is stored)
+//! @param left pointer to the dividend
+//! @param recip pointer to the reciprocal of the divisor
+//! @return same as fixpoint_div
+result_t
+fixpoint_div_recip( fixpoint_t *result, const fixpoint_t *left, const fixpoint_recip_t *recip );
+
+//! Compute the square root of a fixpoint_t value, truncated (towards
+//! 0) to 32 fractional bits. The result is exact: it is the largest
+//! value whose square is at most val.
+//!
+//! @param result pointer to fixpoint_t where the square root is stored
+//! @param val pointer to the value (which must not be negative)
+//! @return RESULT_OK if the square root is exact, RESULT_UNDERFLOW if
+//!         it was truncated, or RESULT_OVERFLOW if val is negative
+//!         (in which case result is set to 0)
+result_t
+fixpoint_sqrt( fixpoint_t *result, const fixpoint_t *val );
+
+//! Compute e^val.
+//! The result differs from the exact value truncated towards 0 by at
+//! most one unit in the last place (2^-32) plus 2^-58 of the result,
+//! i.e. it is within one unit for results below 2^26, and within
+//! 2^-58 relative error above that.
+//!
+//! @param result pointer to fixpoint_t where the result is stored
+//! @param val pointer to the exponent
+//! @return RESULT_OK if the result is exact (only for val = 0),
+//!         RESULT_UNDERFLOW if it was truncated, or RESULT_OVERFLOW
+//!         if e^val is at least 2^32 (in which case result is set to
+//!         the largest value)
+result_t
+fixpoint_exp( fixpoint_t *result, const fixpoint_t *val );
+
+//! Compute the natural logarithm of a fixpoint_t value.
+//! The result differs from the exact value truncated towards 0 by at
+//! most one unit in the last place (2^-32).
+//!
+//! @param result pointer to fixpoint_t where the result is stored
+//! @param val pointer to the value (which must be positive)
+//! @return RESULT_OK if the result is exact (only for val = 1),
+//!         RESULT_UNDERFLOW if it was truncated, or RESULT_OVERFLOW
+//!         if val is 0 or negative (in which case result is set to
+//!         the most negative value)
+result_t
+fixpoint_log( fixpoint_t *result, const fixpoint_t *val );
+
+//! Compute the sine of a fixpoint_t value (in radians).
+//! The argument is reduced modulo pi/2 with enough precision that
+//! the whole range of fixpoint_t values is handled, and the result
+//! differs from the exact value truncated towards 0 by at most one
+//! unit in the last place (2^-32).
+//!
+//! @param result pointer to fixpoint_t where the result is stored
+//! @param val pointer to the angle
+//! @return RESULT_OK if the result is exact (only for val = 0), or
+//!         RESULT_UNDERFLOW if it was truncated
+result_t
+fixpoint_sin( fixpoint_t *result, const fixpoint_t *val );
+
+//! Compute the cosine of a fixpoint_t value (in radians).
+//! See fixpoint_sin.
+//!
+//! @param result pointer to fixpoint_t where the result is stored
+//! @param val pointer to the angle
+//! @return RESULT_OK if the result is exact (only for val = 0), or
+//!         RESULT_UNDERFLOW if it was truncated
+result_t
+fixpoint_cos( fixpoint_t *result, const fixpoint_t *val );
+
 //! Compare two fixpoint_t values.
 //!
 //! @param left pointer to the left fixpoint_t instance to be compared
@@ -193,6 +414,364 @@ fixpoint_format_hex( fixpoint_str_t *s, const fixpoint_t *val );
 bool
 fixpoint_parse_hex( fixpoint_t *val, const fixpoint_str_t *s );
 
+//! Parse newline-delimited formatted base-16 values (as produced by
+//! fixpoint_format_hex, one per line) directly from a buffer, which
+//! does not need to be NUL-terminated. Each line must be a string
+//! that fixpoint_parse_hex accepts, followed by '\n' (the newline
+//! is optional on the last line). Parsing stops at the first
+//! malformed line, or when max_vals values have been stored.
+//!
+//! @param vals array where the parsed values are stored
+//! @param max_vals number of elements in vals
+//! @param buf the buffer containing the text to parse
+//! @param len number of characters in the buffer
+//! @param end_offset set to the offset in buf where parsing stopped:
+//!                   len if every line was parsed, otherwise the
+//!                   offset of the first line that was not parsed
+//!                   (which is malformed if fewer than max_vals values
+//!                   were stored)
+//! @return the number of values stored in vals
+size_t
+fixpoint_parse_hex_buffer( fixpoint_t *vals, size_t max_vals, const char *buf, size_t len,
+                           size_t *end_offset );
+
+//! Format a fixpoint_t value as a string of base 10 digits:
+//! an optional minus sign (if the value is negative), the whole
+//! part without leading 0s (at least one digit), a decimal point,
+//! and the fractional part rounded to 10 digits (to nearest, ties
+//! to even), without trailing 0s (at least one digit). Examples:
+//!
+//!   0.5, -12.375, 4294967295.9999999998, 0.0000000002, 7.0
+//!
+//! Ten digits are always enough for fixpoint_parse_dec to recover
+//! the exact value.
+//!
+//! @param s pointer to a fixpoint_str_t instance where the
+//!          formatted string should be stored
+//! @param val pointer to a fixpoint_t instance to be converted
+//!            to base 10
+void
+fixpoint_format_dec( fixpoint_str_t *s, const fixpoint_t *val );
+
+//! Convert a base-10 string to a fixpoint_t value. The string must
+//! have an optional minus sign, 1 to 10 whole digits (a value that
+//! fits in 32 bits), a decimal point, and at least one fractional
+//! digit. The fraction is rounded to the nearest multiple of 2^-32
+//! (ties to even) exactly, however many digits it has. A value
+//! that rounds up to 2^32 or more is out of range and rejected.
+//!
+//! @param val pointer to the fixpoint_t instance where the converted
+//!            value should be stored
+//! @param s pointer to a fixpoint_str_t instance containing a
+//!          base-10 string
+//! @return true if the string was well-formed and in range and the
+//!         converted value was stored in the fixpoint_t instance,
+//!         false otherwise
+bool
+fixpoint_parse_dec( fixpoint_t *val, const fixpoint_str_t *s );
+
+//! Return the instruction set used by the SIMD kernels (hex parsing
+//! and the fixpoint_column_t arithmetic). Unless changed by
+//! fixpoint_set_isa, this is the best one the CPU supports
+//! (detected the first time it is needed).
+//!
+//! @return the instruction set in use
+fixpoint_isa_t
+fixpoint_get_isa( void );
+
+//! Select the instruction set used by the SIMD kernels
+//! (mostly useful for testing and benchmarking).
+//!
+//! @param isa the instruction set to use
+//! @return true if successful, false if the CPU does not support isa
+//!         (in which case the selection is unchanged)
+bool
+fixpoint_set_isa( fixpoint_isa_t isa );
+
+////////////////////////////////////////////////////////////////////////
+// Batch API functions
+//
+// These apply an operation element-wise to arrays of n values:
+// element i of the result is computed from element i of the inputs,
+// exactly as the corresponding scalar function would compute it.
+// The result array must not overlap the input arrays.
+////////////////////////////////////////////////////////////////////////
+
+//! Compute result[i] = left[i] + right[i] for i in [0, n).
+//! The value stored in result[i] and the value stored in flags[i]
+//! are identical to what fixpoint_add would store and return.
+//!
+//! @param result array of n fixpoint_t instances where sums are stored
+//! @param left array of n left values to be added
+//! @param right array of n right values to be added
+//! @param n number of elements
+//! @param flags array of n result_t values where the per-element
+//!              results are stored (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_add_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] - right[i] for i in [0, n).
+//! See fixpoint_add_n (the per-element behavior is that of fixpoint_sub).
+//!
+//! @param result array of n fixpoint_t instances where differences are stored
+//! @param left array of n minuends
+//! @param right array of n subtrahends
+//! @param n number of elements
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_sub_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] * right[i] for i in [0, n).
+//! See fixpoint_add_n (the per-element behavior is that of fixpoint_mul).
+//!
+//! @param result array of n fixpoint_t instances where products are stored
+//! @param left array of n left values to be multiplied
+//! @param right array of n right values to be multiplied
+//! @param n number of elements
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_mul_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] + right[i] for i in [0, n), saturating.
+//! See fixpoint_add_n (the per-element behavior is that of fixpoint_add_sat).
+//!
+//! @param result array of n fixpoint_t instances where results are stored
+//! @param left array of n left operands
+//! @param right array of n right operands
+//! @param n number of elements
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_add_sat_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                    const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] - right[i] for i in [0, n), saturating.
+//! See fixpoint_add_n (the per-element behavior is that of fixpoint_sub_sat).
+//!
+//! @param result array of n fixpoint_t instances where results are stored
+//! @param left array of n left operands
+//! @param right array of n right operands
+//! @param n number of elements
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_sub_sat_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                    const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] * right[i] for i in [0, n), saturating.
+//! See fixpoint_add_n (the per-element behavior is that of fixpoint_mul_sat).
+//!
+//! @param result array of n fixpoint_t instances where results are stored
+//! @param left array of n left operands
+//! @param right array of n right operands
+//! @param n number of elements
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_mul_sat_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                    const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] * right[i] for i in [0, n), rounded to nearest (ties to even).
+//! See fixpoint_add_n (the per-element behavior is that of fixpoint_mul_rne).
+//!
+//! @param result array of n fixpoint_t instances where results are stored
+//! @param left array of n left operands
+//! @param right array of n right operands
+//! @param n number of elements
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_mul_rne_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                    const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] * right[i] for i in [0, n), with
+//! stochastic rounding: element i is computed as fixpoint_mul_stochastic
+//! would, with random set to the high 32 bits of the next output of
+//! the splitmix64 generator whose state is *seed. *seed is updated, so
+//! consecutive calls continue the same sequence (any initial value
+//! can be used).
+//!
+//! @param result array of n fixpoint_t instances where products are stored
+//! @param left array of n left values to be multiplied
+//! @param right array of n right values to be multiplied
+//! @param n number of elements
+//! @param seed pointer to the state of the random generator
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_mul_stochastic_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                           const fixpoint_t *FIXPOINT_RESTRICT right, size_t n, uint64_t *seed,
+                           result_t *FIXPOINT_RESTRICT flags );
+
+//! Compute result[i] = left[i] / divisor for i in [0, n), where
+//! recip is the reciprocal of divisor (see fixpoint_recip_init).
+//! See fixpoint_add_n (the per-element behavior is that of fixpoint_div).
+//!
+//! @param result array of n fixpoint_t instances where quotients are stored
+//! @param left array of n dividends
+//! @param recip pointer to the reciprocal of the divisor
+//! @param n number of elements
+//! @param flags array of n per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_div_recip_n( fixpoint_t *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                      const fixpoint_recip_t *recip, size_t n, result_t *FIXPOINT_RESTRICT flags );
+
+//! Compare left[i] with right[i] for i in [0, n), storing
+//! -1, 0, or 1 in result[i] exactly as fixpoint_compare would return.
+//!
+//! @param result array of n ints where the comparison results are stored
+//! @param left array of n left values to be compared
+//! @param right array of n right values to be compared
+//! @param n number of elements
+void
+fixpoint_compare_n( int *FIXPOINT_RESTRICT result, const fixpoint_t *FIXPOINT_RESTRICT left,
+                    const fixpoint_t *FIXPOINT_RESTRICT right, size_t n );
+
+//! Sort vals[0], ..., vals[n-1] in place into the order of
+//! fixpoint_compare (ascending). A negative 0 (which fixpoint_compare
+//! orders just below 0) is kept as it is.
+//! Large arrays are radix sorted on an order-preserving 64 bit key
+//! (the magnitude, or its complement for negative values) after
+//! partitioning them by sign, which takes 16 bytes per element of
+//! temporary memory. Small arrays, or large ones if that memory
+//! can't be allocated, are sorted in place with introsort.
+//!
+//! @param vals array of n values to be sorted
+//! @param n number of elements
+void
+fixpoint_sort_n( fixpoint_t *vals, size_t n );
+
+//! Format vals[i] into strs[i] for i in [0, n), exactly as
+//! fixpoint_format_dec would.
+//!
+//! @param strs array of n fixpoint_str_t instances where the strings are stored
+//! @param vals array of n values to be formatted
+//! @param n number of elements
+void
+fixpoint_format_dec_n( fixpoint_str_t *FIXPOINT_RESTRICT strs, const fixpoint_t *FIXPOINT_RESTRICT vals, size_t n );
+
+//! Parse strs[i] into vals[i] for i in [0, n), exactly as
+//! fixpoint_parse_dec would.
+//!
+//! @param vals array of n fixpoint_t instances where the values are stored
+//! @param strs array of n strings to be parsed
+//! @param n number of elements
+//! @param ok array of n bools where fixpoint_parse_dec's result for
+//!           each element is stored (may be NULL)
+//! @return the number of strings successfully parsed
+size_t
+fixpoint_parse_dec_n( fixpoint_t *FIXPOINT_RESTRICT vals, const fixpoint_str_t *FIXPOINT_RESTRICT strs, size_t n,
+                      bool *FIXPOINT_RESTRICT ok );
+
+////////////////////////////////////////////////////////////////////////
+// Reduction functions
+//
+// These combine n values into a single result. The intermediate
+// results are exact (they are kept in a wide internal accumulator),
+// so the result is truncated, and checked for overflow and
+// underflow, only once at the end: an intermediate total may be
+// out of range as long as the final one is not.
+////////////////////////////////////////////////////////////////////////
+
+//! Compute the sum of vals[0], ..., vals[n-1].
+//! The sum of an empty array is 0.
+//!
+//! @param result pointer to fixpoint_t where the sum should be stored
+//! @param vals array of n values to be added
+//! @param n number of elements
+//! @return RESULT_OK if the exact sum is in range, or RESULT_OVERFLOW
+//!         if it is not (result then holds the low 64 bits of its
+//!         magnitude, and its sign)
+result_t
+fixpoint_sum_n( fixpoint_t *result, const fixpoint_t *vals, size_t n );
+
+//! Compute the dot product left[0] * right[0] + ... + left[n-1] * right[n-1].
+//! The products are not truncated before they are added, so the
+//! result is the exact dot product truncated once (which may differ
+//! from chaining fixpoint_mul and fixpoint_add, or fixpoint_fma).
+//! Like fixpoint_fma, the result is negative 0 if a negative dot
+//! product truncates to 0.
+//!
+//! @param result pointer to fixpoint_t where the dot product should be stored
+//! @param left array of n left values
+//! @param right array of n right values
+//! @param n number of elements
+//! @return RESULT_OK if the exact dot product is representable,
+//!         otherwise the bitwise OR of RESULT_OVERFLOW (if it is
+//!         too large) and RESULT_UNDERFLOW (if nonzero bits were
+//!         truncated), as for fixpoint_mul
+result_t
+fixpoint_dot_n( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right, size_t n );
+
+//! Find the smallest of vals[0], ..., vals[n-1] (in the order of
+//! fixpoint_compare, so -0 is smaller than 0).
+//!
+//! @param result pointer to fixpoint_t where the smallest value is stored
+//! @param index if not NULL, set to the index of the first smallest value
+//! @param vals array of n values
+//! @param n number of elements
+//! @return true if successful, false if n is 0 (nothing is stored)
+bool
+fixpoint_min_n( fixpoint_t *result, size_t *index, const fixpoint_t *vals, size_t n );
+
+//! Find the largest of vals[0], ..., vals[n-1] (see fixpoint_min_n).
+//!
+//! @param result pointer to fixpoint_t where the largest value is stored
+//! @param index if not NULL, set to the index of the first largest value
+//! @param vals array of n values
+//! @param n number of elements
+//! @return true if successful, false if n is 0 (nothing is stored)
+bool
+fixpoint_max_n( fixpoint_t *result, size_t *index, const fixpoint_t *vals, size_t n );
+
+//! Compute the count, minimum, maximum and sum of vals[0], ...,
+//! vals[n-1] in a single pass. The results are the same as those of
+//! fixpoint_min_n, fixpoint_max_n and fixpoint_sum_n. If n is 0, the
+//! minimum, maximum and sum are 0 and argmin and argmax are 0.
+//!
+//! @param stats pointer to fixpoint_stats_t where the results are stored
+//! @param vals array of n values
+//! @param n number of elements
+//! @return the result of the sum, as for fixpoint_sum_n
+result_t
+fixpoint_stats_n( fixpoint_stats_t *stats, const fixpoint_t *vals, size_t n );
+
+//! Count vals[0], ..., vals[n-1] into nbuckets buckets of equal width:
+//! bucket i holds the values v with lo + i * width <= v <
+//! lo + (i + 1) * width, and its count is counts[i + 1]. Values below
+//! lo are counted in counts[0], and values at or above
+//! lo + nbuckets * width in counts[nbuckets + 1]. The counts are
+//! added to, so a histogram can be built from several arrays.
+//! A negative 0 is counted as 0.
+//!
+//! @param counts array of nbuckets + 2 counts to increment
+//! @param nbuckets number of buckets
+//! @param lo pointer to the lower bound of the first bucket
+//! @param width pointer to the width of the buckets (must be positive)
+//! @param vals array of n values
+//! @param n number of elements
+//! @return true if successful, false if width is not positive (nothing
+//!         is counted)
+bool
+fixpoint_histogram_n( size_t *counts, size_t nbuckets, const fixpoint_t *lo, const fixpoint_t *width,
+                      const fixpoint_t *vals, size_t n );
+
 // TODO: add prototypes for helper functions you want to test using unit tests
 
+#ifdef __cplusplus
+}
+#endif
+
+// Inline fast path (see fixpoint_inline.h)
+#ifdef FIXPOINT_INLINE
+#include "fixpoint_inline.h"
+#endif
+
 #endif // FIXPOINT_H
@@ -0,0 +1,350 @@
+#ifndef FIXPOINT_HPP
+#define FIXPOINT_HPP
+
+#include <charconv>
+#include <cstdint>
+#include <system_error>
+#include "fixpoint.h"
+
+////////////////////////////////////////////////////////////////////////
+// C++ wrapper
+//
+// Fixpoint is a value type wrapping fixpoint_t, with constexpr
+// arithmetic, comparison, formatting and parsing, so expressions on
+// constants are evaluated at compile time. Every operation follows
+// the same steps as the corresponding function in fixpoint.c, and
+// gives bit-identical results (including the result_t flags and the
+// sign of 0).
+//
+// Requires C++17.
+////////////////////////////////////////////////////////////////////////
+
+namespace fixpoint {
+
+//! Value type wrapping a fixpoint_t.
+//! The arithmetic operators store the same (possibly truncated)
+//! results as fixpoint_add, fixpoint_sub and fixpoint_mul and discard
+//! the result_t flags; use add, sub and mul to get them. The
+//! comparison operators order values as fixpoint_compare does (in
+//! particular, a negative 0 is less than 0).
+class Fixpoint {
+public:
+  //! Construct the value 0.
+  constexpr Fixpoint() noexcept : m_val{ 0, 0, false } { }
+
+  //! Construct a value from its parts, as fixpoint_init.
+  //!
+  //! @param whole the whole part of the value
+  //! @param frac the fractional part of the value
+  //! @param negative true if the value is negative
+  constexpr Fixpoint( uint32_t whole, uint32_t frac, bool negative = false ) noexcept
+    : m_val{ whole, frac, negative } { }
+
+  //! Construct a value from a fixpoint_t.
+  constexpr explicit Fixpoint( const fixpoint_t &val ) noexcept : m_val( val ) { }
+
+  //! @return the wrapped fixpoint_t (for calling the C API)
+  constexpr const fixpoint_t &c_val() const noexcept { return m_val; }
+
+  //! @return the whole part of the value
+  constexpr uint32_t whole() const noexcept { return m_val.whole; }
+
+  //! @return the fractional part of the value
+  constexpr uint32_t frac() const noexcept { return m_val.frac; }
+
+  //! @return true if the value is negative
+  constexpr bool is_negative() const noexcept { return m_val.negative; }
+
+  //! Compute left + right, as fixpoint_add.
+  //!
+  //! @param result set to the sum
+  //! @return RESULT_OK or RESULT_OVERFLOW
+  static constexpr result_t add( Fixpoint &result, const Fixpoint &left, const Fixpoint &right ) noexcept {
+    return add_sub( result, left, right, false );
+  }
+
+  //! Compute left - right, as fixpoint_sub.
+  //!
+  //! @param result set to the difference
+  //! @return RESULT_OK or RESULT_OVERFLOW
+  static constexpr result_t sub( Fixpoint &result, const Fixpoint &left, const Fixpoint &right ) noexcept {
+    return add_sub( result, left, right, true );
+  }
+
+  //! Compute left * right, as fixpoint_mul.
+  //!
+  //! @param result set to the (truncated) product
+  //! @return RESULT_OK, or RESULT_OVERFLOW, or RESULT_UNDERFLOW,
+  //!         or (RESULT_OVERFLOW|RESULT_UNDERFLOW)
+  static constexpr result_t mul( Fixpoint &result, const Fixpoint &left, const Fixpoint &right ) noexcept {
+    uint64_t p0 = (uint64_t)left.frac() * right.frac();
+    uint64_t p1 = (uint64_t)left.frac() * right.whole();
+    uint64_t p2 = (uint64_t)left.whole() * right.frac();
+    uint64_t p3 = (uint64_t)left.whole() * right.whole();
+
+    uint64_t middle_sum = p1 + p2 + (p0 >> 32);
+    uint64_t final_whole = (uint64_t)(uint32_t)p3 + (uint32_t)(middle_sum >> 32);
+    result_t ret = RESULT_OK;
+    if ((p3 >> 32) != 0 || (final_whole >> 32) != 0) {
+      ret |= RESULT_OVERFLOW;
+    }
+    if ((uint32_t)p0 != 0) {
+      ret |= RESULT_UNDERFLOW;
+    }
+
+    //0 is only non-negative if the product is exact
+    uint32_t whole = (uint32_t)final_whole, frac = (uint32_t)middle_sum;
+    bool negative = left.is_negative() != right.is_negative();
+    result = Fixpoint( whole, frac, negative && !(ret == RESULT_OK && whole == 0 && frac == 0) );
+    return ret;
+  }
+
+  //! Compare two values, as fixpoint_compare.
+  //!
+  //! @return -1 if left < right, 0 if left == right, and 1 if left > right
+  static constexpr int compare( const Fixpoint &left, const Fixpoint &right ) noexcept {
+    uint64_t left_mag = left.magnitude(), right_mag = right.magnitude();
+    int mag_cmp = (left_mag > right_mag) - (left_mag < right_mag);
+    int sign_cmp = (int)right.is_negative() - (int)left.is_negative();
+    int same_sign_cmp = left.is_negative() ? -mag_cmp : mag_cmp;
+    return sign_cmp ? sign_cmp : same_sign_cmp;
+  }
+
+  //! Negation, as fixpoint_negate (0 stays non-negative).
+  constexpr Fixpoint operator-() const noexcept {
+    return Fixpoint( whole(), frac(), !is_negative() && magnitude() != 0 );
+  }
+
+  constexpr Fixpoint &operator+=( const Fixpoint &right ) noexcept {
+    add( *this, *this, right );
+    return *this;
+  }
+
+  constexpr Fixpoint &operator-=( const Fixpoint &right ) noexcept {
+    sub( *this, *this, right );
+    return *this;
+  }
+
+  constexpr Fixpoint &operator*=( const Fixpoint &right ) noexcept {
+    mul( *this, *this, right );
+    return *this;
+  }
+
+private:
+  constexpr uint64_t magnitude() const noexcept {
+    return ((uint64_t)m_val.whole << 32) | m_val.frac;
+  }
+
+  // Same steps as fixpoint_inline_add_sub (with the carry and borrow
+  // computed without the builtins, which aren't constexpr everywhere)
+  static constexpr result_t add_sub( Fixpoint &result, const Fixpoint &left, const Fixpoint &right,
+                                     bool is_sub ) noexcept {
+    uint64_t left_mag = left.magnitude(), right_mag = right.magnitude();
+    bool same_sign = left.is_negative() == (right.is_negative() != is_sub);
+
+    uint64_t sum = left_mag + right_mag;
+    bool carry = sum < left_mag;
+    bool borrow = left_mag < right_mag;
+    uint64_t diff = borrow ? right_mag - left_mag : left_mag - right_mag;
+
+    uint64_t mag = same_sign ? sum : diff;
+    bool overflow = same_sign && carry;
+    bool negative = (left.is_negative() != (!same_sign && borrow)) && (mag != 0 || overflow);
+    result = Fixpoint( (uint32_t)(mag >> 32), (uint32_t)mag, negative );
+    return overflow ? RESULT_OVERFLOW : RESULT_OK;
+  }
+
+  fixpoint_t m_val;
+};
+
+constexpr Fixpoint operator+( Fixpoint left, const Fixpoint &right ) noexcept { return left += right; }
+constexpr Fixpoint operator-( Fixpoint left, const Fixpoint &right ) noexcept { return left -= right; }
+constexpr Fixpoint operator*( Fixpoint left, const Fixpoint &right ) noexcept { return left *= right; }
+
+constexpr bool operator==( const Fixpoint &l, const Fixpoint &r ) noexcept { return Fixpoint::compare( l, r ) == 0; }
+constexpr bool operator!=( const Fixpoint &l, const Fixpoint &r ) noexcept { return Fixpoint::compare( l, r ) != 0; }
+constexpr bool operator<( const Fixpoint &l, const Fixpoint &r ) noexcept { return Fixpoint::compare( l, r ) < 0; }
+constexpr bool operator<=( const Fixpoint &l, const Fixpoint &r ) noexcept { return Fixpoint::compare( l, r ) <= 0; }
+constexpr bool operator>( const Fixpoint &l, const Fixpoint &r ) noexcept { return Fixpoint::compare( l, r ) > 0; }
+constexpr bool operator>=( const Fixpoint &l, const Fixpoint &r ) noexcept { return Fixpoint::compare( l, r ) >= 0; }
+
+//! Format a value into [first, last), like std::to_chars: base 16
+//! gives the same string as fixpoint_format_hex, base 10 the same
+//! string as fixpoint_format_dec. No NUL terminator is written.
+//!
+//! @param first start of the output buffer
+//! @param last end of the output buffer
+//! @param val the value to format
+//! @param base 16 or 10
+//! @return ptr past the last character written and a default
+//!         std::errc, or last and std::errc::value_too_large if the
+//!         buffer is too small (its contents are then unspecified),
+//!         or first and std::errc::invalid_argument for another base
+constexpr std::to_chars_result
+to_chars( char *first, char *last, const Fixpoint &val, int base = 16 ) noexcept {
+  if (base != 16 && base != 10) {
+    return { first, std::errc::invalid_argument };
+  }
+  char buf[FIXPOINT_STR_MAX_SIZE] = { };
+  int len = 0;
+  if (val.is_negative()) {
+    buf[len++] = '-';
+  }
+
+  //whole part without leading 0s (at least one digit)
+  char digits[10] = { };
+  int n = 0;
+  uint32_t whole = val.whole();
+  do {
+    digits[n++] = "0123456789abcdef"[whole % base];
+    whole /= base;
+  } while (whole != 0);
+  while (n > 0) {
+    buf[len++] = digits[--n];
+  }
+  buf[len++] = '.';
+
+  if (base == 16) {
+    //frac part without trailing 0s (at least one digit)
+    uint32_t frac = val.frac();
+    do {
+      buf[len++] = "0123456789abcdef"[frac >> 28];
+      frac <<= 4;
+    } while (frac != 0);
+  } else {
+    //10 digits by repeated multiplication by 10, then round to
+    //nearest, ties to even, using the exact remainder (the carry
+    //never reaches the decimal point)
+    uint64_t x = val.frac();
+    for (int i = 0; i < 10; i++) {
+      x *= 10;
+      digits[i] = (char)('0' + (x >> 32));
+      x &= 0xFFFFFFFF;
+    }
+    if (x > 0x80000000 || (x == 0x80000000 && (digits[9] & 1))) {
+      int i = 9;
+      while (digits[i] == '9') {
+        digits[i--] = '0';
+      }
+      digits[i]++;
+    }
+    n = 10;
+    while (n > 1 && digits[n - 1] == '0') {
+      n--;
+    }
+    for (int i = 0; i < n; i++) {
+      buf[len++] = digits[i];
+    }
+  }
+
+  if (last - first < len) {
+    return { last, std::errc::value_too_large };
+  }
+  for (int i = 0; i < len; i++) {
+    first[i] = buf[i];
+  }
+  return { first + len, std::errc() };
+}
+
+//! Parse a value from [first, last), like std::from_chars: base 16
+//! accepts the strings accepted by fixpoint_parse_hex, base 10 those
+//! accepted by fixpoint_parse_dec (with the same rounding), but
+//! parsing stops at the first character that can't continue the
+//! value instead of requiring the whole input to be consumed.
+//!
+//! @param first start of the input
+//! @param last end of the input
+//! @param val set to the parsed value if successful (otherwise
+//!            unchanged)
+//! @param base 16 or 10
+//! @return ptr past the parsed characters and a default std::errc;
+//!         or first and std::errc::invalid_argument if the input does
+//!         not start with a valid value; or ptr past the value and
+//!         std::errc::result_out_of_range if a base 10 value does not
+//!         fit in a fixpoint_t
+constexpr std::from_chars_result
+from_chars( const char *first, const char *last, Fixpoint &val, int base = 16 ) noexcept {
+  if (base != 16 && base != 10) {
+    return { first, std::errc::invalid_argument };
+  }
+  const char *p = first;
+  bool negative = p != last && *p == '-';
+  p += negative;
+
+  //value of a digit character, or -1
+  auto digit_value = [base]( const char *q, const char *end ) {
+    if (q == end) {
+      return -1;
+    }
+    char c = *q;
+    int d = (c >= '0' && c <= '9') ? c - '0'
+          : (c >= 'a' && c <= 'f') ? c - 'a' + 10
+          : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : -1;
+    return d < base ? d : -1;
+  };
+
+  //1 to 8 (base 16) or 10 (base 10) whole digits, then '.'
+  uint64_t whole = 0;
+  int digits = 0;
+  for (int d = digit_value( p, last ); d >= 0; d = digit_value( ++p, last ), digits++) {
+    if (digits < 10) {
+      whole = whole * base + (unsigned)d;
+    }
+  }
+  if (digits < 1 || digits > (base == 16 ? 8 : 10) || p == last || *p != '.') {
+    return { first, std::errc::invalid_argument };
+  }
+  p++;
+
+  if (base == 16) {
+    //1 to 8 frac digits, the missing ones are trailing 0s
+    uint32_t frac = 0;
+    digits = 0;
+    for (int d = digit_value( p, last ); d >= 0; d = digit_value( ++p, last ), digits++) {
+      frac = (frac << 4) | (uint32_t)d;
+    }
+    if (digits < 1 || digits > 8) {
+      return { first, std::errc::invalid_argument };
+    }
+    val = Fixpoint( (uint32_t)whole, frac << (4 * (8 - digits)), negative );
+    return { p, std::errc() };
+  }
+
+  //the value times 2^32 is rounded to nearest, ties to even. Ties
+  //(multiples of 2^-33) have at most 33 fractional digits, so with n
+  //the first 33 digits as an integer, frac * 2^32 = n / (2 * 5^33)
+  //plus a positive amount less than 1 / (2 * 5^33) exactly when a
+  //later digit is nonzero
+  unsigned __int128 n = 0, denom = 2;
+  bool sticky = false;
+  digits = 0;
+  for (int d = digit_value( p, last ); d >= 0; d = digit_value( ++p, last ), digits++) {
+    if (digits < 33) {
+      n = n * 10 + (unsigned)d;
+    } else {
+      sticky |= d != 0;
+    }
+  }
+  if (digits < 1) {
+    return { first, std::errc::invalid_argument };
+  }
+  for (int i = digits; i < 33; i++) {
+    n *= 10;
+  }
+  for (int i = 0; i < 33; i++) {
+    denom *= 5;
+  }
+  uint64_t frac = (uint64_t)(n / denom);
+  unsigned __int128 twice_rem = 2 * (n % denom);
+  frac += twice_rem > denom || (twice_rem == denom && (sticky || (frac & 1)));
+  whole += frac >> 32;
+  if (whole > UINT32_MAX) {
+    return { p, std::errc::result_out_of_range };
+  }
+  val = Fixpoint( (uint32_t)whole, (uint32_t)frac, negative );
+  return { p, std::errc() };
+}
+
+} // namespace fixpoint
+
+#endif // FIXPOINT_HPP
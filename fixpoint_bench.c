@@ -0,0 +1,1365 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "fixpoint.h"
+#include "fixpoint_inline.h"
+#include "fixpoint_column.h"
+#include "fixpoint_io.h"
+#include "fixpoint_packed.h"
+#include "fixpoint_ref.h"
+
+// Number of values in each input array, and number of passes
+// made over the arrays for each timed operation
+#define BENCH_N 4096
+#define BENCH_PASSES 2000
+
+static const char *isa_names[] = { "scalar", "sse4.1", "avx2" };
+
+typedef result_t (*binop_fn)( fixpoint_t *, const fixpoint_t *, const fixpoint_t * );
+typedef result_t (*unop_fn)( fixpoint_t *, const fixpoint_t * );
+
+// Results are accumulated here so the compiler can't discard
+// the benchmarked calls
+static volatile uint32_t bench_sink;
+
+static uint64_t bench_rng_state = 0x9E3779B97F4A7C15ULL;
+
+// xorshift64 pseudo-random generator (deterministic, so every
+// run benchmarks the same inputs)
+static uint64_t
+bench_rand( void ) {
+  uint64_t x = bench_rng_state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  bench_rng_state = x;
+  return x;
+}
+
+static double
+bench_now_ns( void ) {
+  struct timespec ts;
+  clock_gettime( CLOCK_MONOTONIC, &ts );
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Fill an array with random values with random signs
+static void
+fill_mixed_sign( fixpoint_t *vals, size_t n ) {
+  for ( size_t i = 0; i < n; i++ ) {
+    uint64_t r = bench_rand();
+    fixpoint_init( &vals[i], (uint32_t)(r >> 32), (uint32_t)r, false );
+    if ( bench_rand() & 1 )
+      fixpoint_negate( &vals[i] );
+  }
+}
+
+// Time a binary operation over the input arrays, returning ns/op
+static double
+bench_binop( binop_fn fn, const fixpoint_t *left, const fixpoint_t *right, fixpoint_t *out ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      acc += fn( &out[i], &left[i], &right[i] );
+    acc += out[pass % BENCH_N].frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+// fixpoint_div's baseline: convert to double and back (inexact,
+// and without overflow/underflow reporting)
+static result_t
+div_via_double( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  double l = left->whole + left->frac / 4294967296.0;
+  double r = right->whole + right->frac / 4294967296.0;
+  double q = l / r;
+  if ( q >= 4294967296.0 ) q = 4294967295.0;
+  fixpoint_init( result, (uint32_t)q, (uint32_t)( ( q - (uint32_t)q ) * 4294967296.0 ),
+                 left->negative != right->negative );
+  return RESULT_OK;
+}
+
+// Time a loop making direct calls to the accessors, negate, add, mul
+// and compare, through the out-of-line functions (a real call each)
+// or through the inline versions, returning ns/element
+static double
+bench_calls( const fixpoint_t *left, const fixpoint_t *right, fixpoint_t *out ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ ) {
+      fixpoint_t v;
+      fixpoint_init( &v, fixpoint_get_whole( &left[i] ), fixpoint_get_frac( &left[i] ),
+                     fixpoint_is_negative( &left[i] ) );
+      fixpoint_negate( &v );
+      acc += fixpoint_add( &out[i], &v, &right[i] );
+      acc += fixpoint_sub( &v, &out[i], &left[i] );
+      acc += fixpoint_mul( &out[i], &v, &right[i] );
+      acc += fixpoint_compare( &out[i], &v );
+    }
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+static double
+bench_inline_calls( const fixpoint_t *left, const fixpoint_t *right, fixpoint_t *out ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ ) {
+      fixpoint_t v;
+      fixpoint_inline_init( &v, fixpoint_inline_get_whole( &left[i] ),
+                            fixpoint_inline_get_frac( &left[i] ),
+                            fixpoint_inline_is_negative( &left[i] ) );
+      fixpoint_inline_negate( &v );
+      acc += fixpoint_inline_add( &out[i], &v, &right[i] );
+      acc += fixpoint_inline_sub( &v, &out[i], &left[i] );
+      acc += fixpoint_inline_mul( &out[i], &v, &right[i] );
+      acc += fixpoint_inline_compare( &out[i], &v );
+    }
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+// Time a unary operation over the input array, returning ns/op
+static double
+bench_unop( unop_fn fn, const fixpoint_t *vals, fixpoint_t *out ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      acc += fn( &out[i], &vals[i] );
+    acc += out[pass % BENCH_N].frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+// Baselines for fixpoint_sqrt/exp/log/sin/cos: convert to double,
+// call libm and convert back (inexact, and without overflow/underflow
+// reporting)
+static double
+to_double( const fixpoint_t *val ) {
+  double d = val->whole + val->frac / 4294967296.0;
+  return val->negative ? -d : d;
+}
+
+static result_t
+from_double( fixpoint_t *result, double d ) {
+  double mag = fabs( d );
+  if ( mag >= 4294967296.0 ) mag = 4294967295.0;
+  fixpoint_init( result, (uint32_t)mag, (uint32_t)( ( mag - (uint32_t)mag ) * 4294967296.0 ), d < 0 );
+  return RESULT_OK;
+}
+
+static result_t
+sqrt_via_double( fixpoint_t *result, const fixpoint_t *val ) {
+  return from_double( result, sqrt( to_double( val ) ) );
+}
+
+static result_t
+exp_via_double( fixpoint_t *result, const fixpoint_t *val ) {
+  return from_double( result, exp( to_double( val ) ) );
+}
+
+static result_t
+log_via_double( fixpoint_t *result, const fixpoint_t *val ) {
+  return from_double( result, log( to_double( val ) ) );
+}
+
+static result_t
+sin_via_double( fixpoint_t *result, const fixpoint_t *val ) {
+  return from_double( result, sin( to_double( val ) ) );
+}
+
+static result_t
+cos_via_double( fixpoint_t *result, const fixpoint_t *val ) {
+  return from_double( result, cos( to_double( val ) ) );
+}
+
+// Time fixpoint_div_recip_n over the input array, returning ns/element
+static double
+bench_div_recip_n( const fixpoint_t *left, const fixpoint_recip_t *recip, fixpoint_t *out,
+                   result_t *flags ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    acc += fixpoint_div_recip_n( out, left, recip, BENCH_N, flags );
+    acc += out[pass % BENCH_N].frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+typedef result_t (*ternop_fn)( fixpoint_t *, const fixpoint_t *, const fixpoint_t *,
+                              const fixpoint_t * );
+
+// fixpoint_fma's baseline: multiply, then add
+static result_t
+mul_then_add( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+              const fixpoint_t *addend ) {
+  fixpoint_t product;
+  result_t ret = fixpoint_mul( &product, left, right );
+  return ret | fixpoint_add( result, &product, addend );
+}
+
+// Time a ternary operation over the input arrays, returning ns/op
+static double
+bench_ternop( ternop_fn fn, const fixpoint_t *left, const fixpoint_t *right,
+              const fixpoint_t *addend, fixpoint_t *out ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      acc += fn( &out[i], &left[i], &right[i], &addend[i] );
+    acc += out[pass % BENCH_N].frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+typedef result_t (*sum_fn)( fixpoint_t *, const fixpoint_t *, size_t );
+typedef result_t (*dot_fn)( fixpoint_t *, const fixpoint_t *, const fixpoint_t *, size_t );
+
+// fixpoint_sum_n's baseline: chained fixpoint_add
+static result_t
+chained_sum( fixpoint_t *result, const fixpoint_t *vals, size_t n ) {
+  result_t ret = RESULT_OK;
+  fixpoint_init( result, 0, 0, false );
+  for ( size_t i = 0; i < n; i++ )
+    ret |= fixpoint_add( result, result, &vals[i] );
+  return ret;
+}
+
+// fixpoint_dot_n's baseline: chained fixpoint_mul and fixpoint_add
+static result_t
+chained_dot( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right, size_t n ) {
+  result_t ret = RESULT_OK;
+  fixpoint_init( result, 0, 0, false );
+  for ( size_t i = 0; i < n; i++ ) {
+    fixpoint_t product;
+    ret |= fixpoint_mul( &product, &left[i], &right[i] );
+    ret |= fixpoint_add( result, result, &product );
+  }
+  return ret;
+}
+
+// Time a sum reduction over the input array, returning ns/element
+static double
+bench_sum( sum_fn fn, const fixpoint_t *vals ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    fixpoint_t result;
+    acc += fn( &result, vals, BENCH_N );
+    acc += result.frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+// Time a dot product over the input arrays, returning ns/element
+static double
+bench_dot( dot_fn fn, const fixpoint_t *left, const fixpoint_t *right ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    fixpoint_t result;
+    acc += fn( &result, left, right, BENCH_N );
+    acc += result.frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+typedef result_t (*batch_fn)( fixpoint_t *restrict, const fixpoint_t *restrict,
+                             const fixpoint_t *restrict, size_t, result_t *restrict );
+
+// Baselines for the saturating batch functions: the wrapping batch
+// function followed by a pass clamping the elements that overflowed
+static result_t
+add_n_then_clamp( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right, size_t n,
+                  result_t *flags ) {
+  result_t all = fixpoint_add_n( result, left, right, n, flags );
+  for ( size_t i = 0; i < n; i++ ) {
+    if ( flags[i] & RESULT_OVERFLOW )
+      fixpoint_init( &result[i], 0xFFFFFFFF, 0xFFFFFFFF, result[i].negative );
+  }
+  return all;
+}
+
+static result_t
+mul_n_then_clamp( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right, size_t n,
+                  result_t *flags ) {
+  result_t all = fixpoint_mul_n( result, left, right, n, flags );
+  for ( size_t i = 0; i < n; i++ ) {
+    if ( flags[i] & RESULT_OVERFLOW )
+      fixpoint_init( &result[i], 0xFFFFFFFF, 0xFFFFFFFF, left[i].negative != right[i].negative );
+  }
+  return all;
+}
+
+static uint64_t bench_stochastic_seed = 1;
+
+static result_t
+mul_stochastic_n( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right, size_t n,
+                  result_t *flags ) {
+  return fixpoint_mul_stochastic_n( result, left, right, n, &bench_stochastic_seed, flags );
+}
+
+// Time a batch operation over the input arrays, returning ns/element
+static double
+bench_batch( batch_fn fn, const fixpoint_t *left, const fixpoint_t *right, fixpoint_t *out,
+             result_t *flags ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    acc += fn( out, left, right, BENCH_N, flags );
+    acc += out[pass % BENCH_N].frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+typedef result_t (*column_fn)( fixpoint_column_t *, const fixpoint_column_t *,
+                              const fixpoint_column_t *, result_t * );
+
+// Time a column operation, returning ns/element
+static double
+bench_column( column_fn fn, const fixpoint_column_t *left, const fixpoint_column_t *right,
+              fixpoint_column_t *out, result_t *flags ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    acc += fn( out, left, right, flags );
+    acc += out->frac[pass % BENCH_N];
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) BENCH_PASSES * BENCH_N );
+}
+
+typedef void (*format_fn)( fixpoint_str_t *, const fixpoint_t * );
+
+// Time a formatting function over the input array, returning ns/value
+static double
+bench_format( format_fn fn, const fixpoint_t *vals ) {
+  uint32_t acc = 0;
+  fixpoint_str_t s;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES / 4; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ ) {
+      fn( &s, &vals[i] );
+      acc += (unsigned char) s.str[2];
+    }
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) ( BENCH_PASSES / 4 ) * BENCH_N );
+}
+
+typedef bool (*parse_fn)( fixpoint_t *, const fixpoint_str_t * );
+
+// Time a parsing function over an array of strings, returning ns/string
+static double
+bench_parse( parse_fn fn, const fixpoint_str_t *strs ) {
+  uint32_t acc = 0;
+  fixpoint_t val;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES / 4; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ ) {
+      acc += fn( &val, &strs[i] );
+      acc += val.frac;
+    }
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) ( BENCH_PASSES / 4 ) * BENCH_N );
+}
+
+// Time fixpoint_format_dec_n over the input array, returning ns/value
+static double
+bench_format_dec_n( const fixpoint_t *vals, fixpoint_str_t *strs ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES / 4; pass++ ) {
+    fixpoint_format_dec_n( strs, vals, BENCH_N );
+    acc += (unsigned char) strs[pass % BENCH_N].str[2];
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) ( BENCH_PASSES / 4 ) * BENCH_N );
+}
+
+// Time fixpoint_parse_dec_n over an array of strings, returning ns/string
+static double
+bench_parse_dec_n( const fixpoint_str_t *strs, fixpoint_t *vals ) {
+  uint32_t acc = 0;
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES / 4; pass++ ) {
+    acc += fixpoint_parse_dec_n( vals, strs, BENCH_N, NULL );
+    acc += vals[pass % BENCH_N].frac;
+  }
+  double elapsed = bench_now_ns() - start;
+  bench_sink = acc;
+  return elapsed / ( (double) ( BENCH_PASSES / 4 ) * BENCH_N );
+}
+
+// Benchmark parsing strings with the given number of whole and frac
+// digits, reporting throughput in MB/s of input text
+static void
+bench_parse_size( int digits, fixpoint_str_t *strs ) {
+  size_t total_len = 0;
+  for ( size_t i = 0; i < BENCH_N; i++ ) {
+    uint64_t r = bench_rand();
+    fixpoint_t val;
+    //whole has exactly `digits` digits, frac has no trailing zero
+    fixpoint_init( &val, (uint32_t)( r >> 32 ) >> ( 32 - 4 * digits ) | ( 1u << ( 4 * digits - 4 ) ),
+                   ( (uint32_t) r | 1 ) << ( 32 - 4 * digits ), r & 1 );
+    fixpoint_format_hex( &strs[i], &val );
+    total_len += strlen( strs[i].str );
+  }
+  double avg_len = (double) total_len / BENCH_N;
+  double ref_ns = bench_parse( fixpoint_ref_parse_hex, strs );
+  printf( "parse_hex, %d+%d digits: baseline %7.2f ns (%7.1f MB/s)\n",
+          digits, digits, ref_ns, avg_len * 1e3 / ref_ns );
+  fixpoint_isa_t best = fixpoint_get_isa();
+  for ( int isa = FIXPOINT_ISA_SCALAR; isa <= FIXPOINT_ISA_AVX2; isa++ ) {
+    if ( !fixpoint_set_isa( isa ) )
+      continue;
+    double ns = bench_parse( fixpoint_parse_hex, strs );
+    printf( "  %-8s %7.2f ns (%7.1f MB/s), %.2fx\n", isa_names[isa], ns, avg_len * 1e3 / ns, ref_ns / ns );
+  }
+  fixpoint_set_isa( best );
+}
+
+// Benchmark parsing a large newline-delimited buffer with
+// fixpoint_parse_hex_buffer, against splitting it into lines and
+// calling fixpoint_parse_hex on each one
+static void
+bench_parse_stream( void ) {
+  const size_t nlines = 1 << 20;
+  char *buf = malloc( nlines * FIXPOINT_STR_MAX_SIZE );
+  fixpoint_t *vals = malloc( nlines * sizeof( fixpoint_t ) );
+  size_t len = 0;
+  for ( size_t i = 0; i < nlines; i++ ) {
+    uint64_t r = bench_rand();
+    fixpoint_t val;
+    fixpoint_str_t s;
+    fixpoint_init( &val, (uint32_t)( r >> 32 ) >> ( r % 32 ), (uint32_t) r, r & 1 );
+    fixpoint_format_hex( &s, &val );
+    size_t n = strlen( s.str );
+    memcpy( buf + len, s.str, n );
+    len += n;
+    buf[len++] = '\n';
+  }
+
+  //fault in the output array so neither loop pays for it
+  memset( vals, 0, nlines * sizeof( fixpoint_t ) );
+
+  size_t offset;
+  double start = bench_now_ns();
+  size_t count = fixpoint_parse_hex_buffer( vals, nlines, buf, len, &offset );
+  double stream_ns = bench_now_ns() - start;
+
+  start = bench_now_ns();
+  const char *p = buf;
+  for ( size_t i = 0; i < nlines; i++ ) {
+    fixpoint_str_t s;
+    const char *nl = memchr( p, '\n', buf + len - p );
+    memcpy( s.str, p, nl - p );
+    s.str[nl - p] = '\0';
+    count += fixpoint_parse_hex( &vals[i], &s );
+    p = nl + 1;
+  }
+  double line_ns = bench_now_ns() - start;
+  bench_sink = (uint32_t) count + vals[nlines / 2].frac;
+
+  printf( "parse_hex_buffer, %zu lines (%.1f MB): per-line %.1f MB/s, buffer %.1f MB/s, %.2fx\n",
+          nlines, len / 1e6, len * 1e3 / line_ns, len * 1e3 / stream_ns, line_ns / stream_ns );
+  free( buf );
+  free( vals );
+}
+
+// Time loading values saved as hex text (parsing the file) and as a
+// binary file (mapping it, then reading every value)
+static void
+bench_binary_file( void ) {
+  const size_t nvals = 1 << 20;
+  fixpoint_t *vals = malloc( nvals * sizeof( fixpoint_t ) );
+  fixpoint_packed_t packed;
+  fixpoint_packed_init( &packed, nvals );
+  char hex_name[] = "/tmp/fixpoint_bench_XXXXXX";
+  char bin_name[] = "/tmp/fixpoint_bench_XXXXXX";
+  FILE *hex = fdopen( mkstemp( hex_name ), "w" );
+  close( mkstemp( bin_name ) );
+  for ( size_t i = 0; i < nvals; i++ ) {
+    uint64_t r = bench_rand();
+    fixpoint_str_t s;
+    fixpoint_init( &vals[i], (uint32_t)( r >> 32 ) >> ( r % 32 ), (uint32_t) r, r & 1 );
+    fixpoint_format_hex( &s, &vals[i] );
+    fprintf( hex, "%s\n", s.str );
+  }
+  fclose( hex );
+  fixpoint_pack( &packed, vals );
+  fixpoint_write_binary_file( bin_name, &packed, true );
+
+  size_t count, offset;
+  double start = bench_now_ns();
+  fixpoint_parse_hex_file( hex_name, vals, nvals, &count, &offset );
+  double hex_ns = bench_now_ns() - start;
+
+  uint64_t acc = 0;
+  fixpoint_binary_file_t file;
+  start = bench_now_ns();
+  fixpoint_map_binary_file( &file, bin_name, false );
+  for ( size_t i = 0; i < file.packed.size; i++ )
+    acc += file.packed.mag[i];
+  double map_ns = bench_now_ns() - start;
+  fixpoint_unmap_binary_file( &file );
+
+  start = bench_now_ns();
+  fixpoint_map_binary_file( &file, bin_name, true );
+  fixpoint_unpack( vals, &file.packed );
+  double unpack_ns = bench_now_ns() - start;
+  fixpoint_unmap_binary_file( &file );
+  bench_sink = (uint32_t) acc + (uint32_t) count + vals[nvals / 2].frac;
+
+  printf( "load %zu values: parse hex file %.1f ms, map binary %.1f ms (%.0fx), "
+          "map+verify+unpack %.1f ms (%.0fx)\n",
+          nvals, hex_ns / 1e6, map_ns / 1e6, hex_ns / map_ns, unpack_ns / 1e6, hex_ns / unpack_ns );
+  unlink( hex_name );
+  unlink( bin_name );
+  fixpoint_packed_cleanup( &packed );
+  free( vals );
+}
+
+static void
+report( const char *name, double ns_per_op, double baseline_ns_per_op ) {
+  printf( "%-24s %8.2f ns/op", name, ns_per_op );
+  if ( baseline_ns_per_op > 0.0 )
+    printf( "  (%.2fx vs baseline)", baseline_ns_per_op / ns_per_op );
+  printf( "\n" );
+}
+
+// qsort comparator for the baseline of bench_sort
+static int
+compare_for_qsort( const void *left, const void *right ) {
+  return fixpoint_compare( left, right );
+}
+
+// Time sorting arrays of n random values with fixpoint_sort_n,
+// against qsort with fixpoint_compare, returning ns/element
+static void
+bench_sort( size_t n ) {
+  fixpoint_t *vals = malloc( n * sizeof( fixpoint_t ) );
+  fixpoint_t *work = malloc( n * sizeof( fixpoint_t ) );
+  fill_mixed_sign( vals, n );
+  //sort about 2^22 elements in total at every size
+  int reps = (int)( ( (size_t) 1 << 22 ) / n );
+  uint32_t acc = 0;
+
+  double qsort_ns = 0.0, sort_ns = 0.0;
+  for ( int rep = 0; rep < reps; rep++ ) {
+    memcpy( work, vals, n * sizeof( fixpoint_t ) );
+    double start = bench_now_ns();
+    qsort( work, n, sizeof( fixpoint_t ), compare_for_qsort );
+    qsort_ns += bench_now_ns() - start;
+    acc += work[n / 2].frac;
+
+    memcpy( work, vals, n * sizeof( fixpoint_t ) );
+    start = bench_now_ns();
+    fixpoint_sort_n( work, n );
+    sort_ns += bench_now_ns() - start;
+    acc += work[n / 2].frac;
+  }
+  bench_sink = acc;
+
+  char name[64];
+  double elems = (double) reps * n;
+  snprintf( name, sizeof( name ), "qsort %zu (baseline)", n );
+  report( name, qsort_ns / elems, 0.0 );
+  snprintf( name, sizeof( name ), "sort_n %zu", n );
+  report( name, sort_ns / elems, qsort_ns / elems );
+  free( vals );
+  free( work );
+}
+
+// Time min/max/sum with fixpoint_stats_n (one pass), against a pass
+// with fixpoint_compare for each of min and max plus fixpoint_sum_n,
+// returning ns/element
+static void
+bench_reductions( const fixpoint_t *vals ) {
+  uint32_t acc = 0;
+  double elems = (double) BENCH_PASSES * BENCH_N;
+
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    size_t min_i = 0, max_i = 0;
+    for ( size_t i = 1; i < BENCH_N; i++ ) {
+      if ( fixpoint_compare( &vals[i], &vals[min_i] ) < 0 )
+        min_i = i;
+    }
+    for ( size_t i = 1; i < BENCH_N; i++ ) {
+      if ( fixpoint_compare( &vals[i], &vals[max_i] ) > 0 )
+        max_i = i;
+    }
+    fixpoint_t sum;
+    acc += fixpoint_sum_n( &sum, vals, BENCH_N ) + sum.frac + min_i + max_i;
+  }
+  double passes_ns = ( bench_now_ns() - start ) / elems;
+
+  start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    fixpoint_t min;
+    size_t min_i;
+    fixpoint_min_n( &min, &min_i, vals, BENCH_N );
+    acc += min_i;
+  }
+  double min_ns = ( bench_now_ns() - start ) / elems;
+
+  start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    fixpoint_stats_t stats;
+    acc += fixpoint_stats_n( &stats, vals, BENCH_N ) + stats.sum.frac + stats.argmin + stats.argmax;
+  }
+  double stats_ns = ( bench_now_ns() - start ) / elems;
+
+  size_t counts[66] = { 0 };
+  fixpoint_t lo, width;
+  fixpoint_init( &lo, 0xFFFFFFFF, 0, true );
+  fixpoint_init( &width, 0x8000000, 0, false );
+  start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ )
+    fixpoint_histogram_n( counts, 64, &lo, &width, vals, BENCH_N );
+  double hist_ns = ( bench_now_ns() - start ) / elems;
+  bench_sink = acc + (uint32_t) counts[1];
+
+  report( "min+max+sum (3 passes)", passes_ns, 0.0 );
+  report( "min_n", min_ns, 0.0 );
+  report( "stats_n", stats_ns, passes_ns );
+  report( "histogram_n (64)", hist_ns, 0.0 );
+}
+
+// Time packing and unpacking the input array, against copying it
+// to and from a column (the other compact layout)
+static void
+bench_packed( const fixpoint_t *vals, fixpoint_t *out ) {
+  fixpoint_column_t col;
+  fixpoint_packed_t packed;
+  fixpoint_column_init( &col, BENCH_N );
+  fixpoint_packed_init( &packed, BENCH_N );
+  uint32_t acc = 0;
+  double elems = (double) BENCH_PASSES * BENCH_N;
+
+  double start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    fixpoint_column_from_array( &col, vals );
+    acc += col.frac[pass % BENCH_N];
+  }
+  double col_from = ( bench_now_ns() - start ) / elems;
+  start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    acc += fixpoint_pack( &packed, vals );
+    acc += (uint32_t) packed.mag[pass % BENCH_N];
+  }
+  double pack = ( bench_now_ns() - start ) / elems;
+
+  start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    fixpoint_column_to_array( out, &col );
+    acc += out[pass % BENCH_N].frac;
+  }
+  double col_to = ( bench_now_ns() - start ) / elems;
+  start = bench_now_ns();
+  for ( int pass = 0; pass < BENCH_PASSES; pass++ ) {
+    fixpoint_unpack( out, &packed );
+    acc += out[pass % BENCH_N].frac;
+  }
+  double unpack = ( bench_now_ns() - start ) / elems;
+  bench_sink = acc;
+
+  report( "to column (baseline)", col_from, 0.0 );
+  report( "pack", pack, col_from );
+  report( "from column (baseline)", col_to, 0.0 );
+  report( "unpack", unpack, col_to );
+  fixpoint_column_cleanup( &col );
+  fixpoint_packed_cleanup( &packed );
+}
+
+////////////////////////////////////////////////////////////////////////
+// Benchmark suite
+//
+// fixpoint_bench --suite times each core operation over several input
+// distributions, with the number of passes calibrated so that every
+// measurement takes at least SUITE_MIN_NS, and prints the results as
+// text, CSV or JSON (--format=text|csv|json). With --repeat=N each
+// measurement is repeated N times, and the median is reported with
+// a 95% confidence interval.
+//
+// --compare=BASELINE.json compares the medians with a file written
+// by --format=json, and exits with status 1 if any of them regressed:
+// slower than the baseline by more than --threshold percent (default
+// 10), with a confidence interval entirely above the baseline's. The
+// suite includes a reference kernel that doesn't use the library, and
+// the baseline is scaled by the ratio of its times, so a machine that
+// is uniformly slower than when the baseline was made (e.g., a busy
+// VM) doesn't fail the comparison.
+////////////////////////////////////////////////////////////////////////
+
+#define SUITE_MIN_NS 20e6
+
+// Inputs of one distribution: left/right operands (mul_right for mul,
+// see suite_fill) and the strings parsed by parse_hex
+typedef struct {
+  fixpoint_t left[BENCH_N], right[BENCH_N], mul_right[BENCH_N], out[BENCH_N];
+  fixpoint_str_t strs[BENCH_N];
+} suite_inputs_t;
+
+typedef enum {
+  SUITE_SAME_SIGN,
+  SUITE_MIXED_SIGN,
+  SUITE_NEAR_OVERFLOW,
+  SUITE_RANDOM_STRINGS,
+  SUITE_NUM_DISTS,
+} suite_dist_t;
+
+static const char *suite_dist_names[] = {
+  "same_sign", "mixed_sign", "near_overflow", "random_strings",
+};
+
+typedef enum {
+  SUITE_TEXT,
+  SUITE_CSV,
+  SUITE_JSON,
+} suite_format_t;
+
+// Fill the inputs for a distribution:
+//   same_sign:      random non-negative values
+//   mixed_sign:     random values with random signs
+//   near_overflow:  magnitudes near 2^31 with random signs, so sums
+//                   and differences overflow about half the time, and
+//                   mul_right values near 2, so products are near 2^32
+//   random_strings: mixed_sign values, but the strings are random
+//                   hex digits, '.' and '-' (only some well-formed)
+static void
+suite_fill( suite_inputs_t *in, suite_dist_t dist ) {
+  for ( size_t i = 0; i < BENCH_N; i++ ) {
+    uint64_t r = bench_rand(), r2 = bench_rand();
+    uint32_t whole = (uint32_t)( r >> 32 ), frac = (uint32_t) r;
+    uint32_t whole2 = (uint32_t)( r2 >> 32 ), frac2 = (uint32_t) r2;
+    bool neg = dist != SUITE_SAME_SIGN && ( r2 & 1 ), neg2 = dist != SUITE_SAME_SIGN && ( r2 & 2 );
+    if ( dist == SUITE_NEAR_OVERFLOW ) {
+      whole = 0x80000000u - 0x100000u + ( whole >> 11 );
+      whole2 = 0x80000000u - 0x100000u + ( whole2 >> 11 );
+    }
+    fixpoint_init( &in->left[i], whole, frac, neg && ( whole | frac ) );
+    fixpoint_init( &in->right[i], whole2, frac2, neg2 && ( whole2 | frac2 ) );
+    in->mul_right[i] = in->right[i];
+    if ( dist == SUITE_NEAR_OVERFLOW )
+      fixpoint_init( &in->mul_right[i], 1 + ( whole2 & 1 ), frac2, neg2 );
+
+    if ( dist == SUITE_RANDOM_STRINGS ) {
+      static const char chars[] = "0123456789abcdefABCDEF0123456789.-";
+      size_t len = 1 + bench_rand() % ( FIXPOINT_STR_MAX_SIZE - 2 );
+      for ( size_t k = 0; k < len; k++ )
+        in->strs[i].str[k] = chars[bench_rand() % ( sizeof( chars ) - 1 )];
+      in->strs[i].str[len] = '\0';
+    } else {
+      fixpoint_format_hex( &in->strs[i], &in->left[i] );
+    }
+  }
+}
+
+typedef uint32_t (*suite_kernel_fn)( suite_inputs_t *, int );
+
+static uint32_t
+suite_init( suite_inputs_t *in, int passes ) {
+  uint32_t acc = 0;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      fixpoint_init( &in->out[i], in->left[i].whole, in->left[i].frac, in->left[i].negative );
+    acc += in->out[pass % BENCH_N].frac;
+  }
+  return acc;
+}
+
+static uint32_t
+suite_negate( suite_inputs_t *in, int passes ) {
+  //negate a copy, so the inputs are unchanged
+  uint32_t acc = 0;
+  memcpy( in->out, in->left, sizeof( in->out ) );
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      fixpoint_negate( &in->out[i] );
+    acc += in->out[pass % BENCH_N].negative;
+  }
+  return acc;
+}
+
+static uint32_t
+suite_add( suite_inputs_t *in, int passes ) {
+  uint32_t acc = 0;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      acc += fixpoint_add( &in->out[i], &in->left[i], &in->right[i] );
+    acc += in->out[pass % BENCH_N].frac;
+  }
+  return acc;
+}
+
+static uint32_t
+suite_sub( suite_inputs_t *in, int passes ) {
+  uint32_t acc = 0;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      acc += fixpoint_sub( &in->out[i], &in->left[i], &in->right[i] );
+    acc += in->out[pass % BENCH_N].frac;
+  }
+  return acc;
+}
+
+static uint32_t
+suite_mul( suite_inputs_t *in, int passes ) {
+  uint32_t acc = 0;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      acc += fixpoint_mul( &in->out[i], &in->left[i], &in->mul_right[i] );
+    acc += in->out[pass % BENCH_N].frac;
+  }
+  return acc;
+}
+
+static uint32_t
+suite_compare( suite_inputs_t *in, int passes ) {
+  uint32_t acc = 0;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ )
+      acc += fixpoint_compare( &in->left[i], &in->right[i] );
+  }
+  return acc;
+}
+
+static uint32_t
+suite_format_hex( suite_inputs_t *in, int passes ) {
+  uint32_t acc = 0;
+  fixpoint_str_t s;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ ) {
+      fixpoint_format_hex( &s, &in->left[i] );
+      acc += (unsigned char) s.str[2];
+    }
+  }
+  return acc;
+}
+
+static uint32_t
+suite_parse_hex( suite_inputs_t *in, int passes ) {
+  uint32_t acc = 0;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ ) {
+      acc += fixpoint_parse_hex( &in->out[i], &in->strs[i] );
+      acc += in->out[i].frac;
+    }
+  }
+  return acc;
+}
+
+// Machine speed reference for --compare: a dependent chain of integer
+// operations, which no change to the library can affect
+static uint32_t
+suite_reference( suite_inputs_t *in, int passes ) {
+  uint64_t x = in->left[0].frac | 1;
+  for ( int pass = 0; pass < passes; pass++ ) {
+    for ( size_t i = 0; i < BENCH_N; i++ ) {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+    }
+  }
+  return (uint32_t) x;
+}
+
+// Operations in the suite, and whether they also run on
+// random_strings (only the parser reads the strings)
+static const struct {
+  const char *name;
+  suite_kernel_fn fn;
+  bool strings;
+} suite_ops[] = {
+  { "init", suite_init, false },
+  { "negate", suite_negate, false },
+  { "add", suite_add, false },
+  { "sub", suite_sub, false },
+  { "mul", suite_mul, false },
+  { "compare", suite_compare, false },
+  { "format_hex", suite_format_hex, false },
+  { "parse_hex", suite_parse_hex, true },
+  { "reference", suite_reference, false },
+};
+
+#define SUITE_NUM_OPS ( sizeof( suite_ops ) / sizeof( suite_ops[0] ) )
+
+// Number of passes of a kernel that take at least SUITE_MIN_NS
+// (doubling from 1)
+static int
+suite_calibrate( suite_kernel_fn fn, suite_inputs_t *in ) {
+  uint32_t acc = 0;
+  for ( int passes = 1; ; passes *= 2 ) {
+    double start = bench_now_ns();
+    acc += fn( in, passes );
+    if ( bench_now_ns() - start >= SUITE_MIN_NS ) {
+      bench_sink = acc;
+      return passes;
+    }
+  }
+}
+
+static int
+compare_doubles( const void *left, const void *right ) {
+  double l = *(const double *) left, r = *(const double *) right;
+  return ( l > r ) - ( l < r );
+}
+
+// Summary of repeated measurements of one kernel: the median and a
+// distribution-free confidence interval for it, [x(j), x(n+1-j)]
+// for the sorted samples x(1) <= ... <= x(n), with j the largest
+// rank such that P(Binomial(n, 1/2) < j) <= 2.5% (or j = 1 if there
+// are too few samples for a 95% interval)
+typedef struct {
+  double median, ci_low, ci_high;
+  int samples;
+} suite_stats_t;
+
+static suite_stats_t
+suite_summarize( double *samples, int n ) {
+  qsort( samples, n, sizeof( double ), compare_doubles );
+  suite_stats_t st;
+  st.samples = n;
+  st.median = n % 2 ? samples[n / 2] : ( samples[n / 2 - 1] + samples[n / 2] ) / 2;
+
+  //cdf is P(Binomial(n, 1/2) <= k), accumulated term by term, and
+  //rank k + 1 is allowed while it is at most 2.5%
+  int j = 1;
+  double term = pow( 0.5, n ), cdf = 0.0;
+  for ( int k = 0; k < ( n - 1 ) / 2; k++ ) {
+    cdf += term;
+    if ( cdf > 0.025 )
+      break;
+    j = k + 1;
+    term = term * ( n - k ) / ( k + 1 );
+  }
+  st.ci_low = samples[j - 1];
+  st.ci_high = samples[n - j];
+  return st;
+}
+
+// A result read from a baseline file written with --format=json
+typedef struct {
+  char op[32], dist[32];
+  double ns, ci_high;
+} suite_baseline_t;
+
+// Helper function to find "key": in the JSON object text [p, end)
+// and return a pointer to its value (NULL if there is none)
+static const char *
+json_find( const char *p, const char *end, const char *key ) {
+  char quoted[40];
+  snprintf( quoted, sizeof( quoted ), "\"%s\"", key );
+  size_t len = strlen( quoted );
+  for ( ; p + len <= end; p++ ) {
+    if ( memcmp( p, quoted, len ) == 0 ) {
+      p += len;
+      while ( p < end && ( *p == ' ' || *p == ':' ) )
+        p++;
+      return p;
+    }
+  }
+  return NULL;
+}
+
+// Helper function to copy the JSON string value at p (if any) to dst
+static bool
+json_string( char *dst, size_t size, const char *p, const char *end ) {
+  if ( !p || *p != '"' )
+    return false;
+  const char *close = memchr( p + 1, '"', end - p - 1 );
+  if ( !close || (size_t)( close - p - 1 ) >= size )
+    return false;
+  memcpy( dst, p + 1, close - p - 1 );
+  dst[close - p - 1] = '\0';
+  return true;
+}
+
+// Read the results from a baseline file, which is the output of
+// --format=json (only the members of each result object that the
+// comparison needs are read). Returns the number of results, or -1
+// if the file can't be read
+static int
+read_baseline( const char *filename, suite_baseline_t *base, int max ) {
+  FILE *f = fopen( filename, "r" );
+  if ( !f )
+    return -1;
+  char *buf = malloc( 1 << 20 );
+  size_t len = fread( buf, 1, ( 1 << 20 ) - 1, f );
+  fclose( f );
+  buf[len] = '\0';
+
+  int count = 0;
+  const char *p = buf;
+  while ( count < max && ( p = strchr( p, '{' ) ) != NULL ) {
+    const char *close = strchr( p + 1, '}' );
+    const char *inner = strchr( p + 1, '{' );
+    if ( !close )
+      break;
+    if ( inner && inner < close ) {
+      //the outer object
+      p = inner;
+      continue;
+    }
+    suite_baseline_t *b = &base[count];
+    const char *ns = json_find( p, close, "ns_per_op" );
+    const char *ci = json_find( p, close, "ci_high" );
+    if ( json_string( b->op, sizeof( b->op ), json_find( p, close, "op" ), close )
+         && json_string( b->dist, sizeof( b->dist ), json_find( p, close, "distribution" ), close )
+         && ns ) {
+      b->ns = strtod( ns, NULL );
+      b->ci_high = ci ? strtod( ci, NULL ) : b->ns;
+      count++;
+    }
+    p = close + 1;
+  }
+  free( buf );
+  return count;
+}
+
+// Options of --suite
+typedef struct {
+  suite_format_t format;
+  int repeat;
+  const char *baseline;   // --compare file, or NULL
+  double threshold;       // allowed slowdown, in percent
+} suite_options_t;
+
+// One measured case of the suite: an operation on a distribution
+typedef struct {
+  size_t op;
+  int dist;
+  int passes;
+} suite_case_t;
+
+static int
+run_suite( const suite_options_t *opts ) {
+  suite_inputs_t *in = malloc( SUITE_NUM_DISTS * sizeof( suite_inputs_t ) );
+  suite_case_t cases[SUITE_NUM_DISTS * SUITE_NUM_OPS];
+  suite_baseline_t base[64];
+  int ncases = 0, nbase = 0, regressions = 0;
+
+  if ( opts->baseline ) {
+    nbase = read_baseline( opts->baseline, base, 64 );
+    if ( nbase < 0 ) {
+      perror( opts->baseline );
+      free( in );
+      return 2;
+    }
+  }
+
+  for ( int dist = 0; dist < SUITE_NUM_DISTS; dist++ ) {
+    suite_fill( &in[dist], dist );
+    for ( size_t op = 0; op < SUITE_NUM_OPS; op++ ) {
+      if ( dist == SUITE_RANDOM_STRINGS && !suite_ops[op].strings )
+        continue;
+      if ( suite_ops[op].fn == suite_reference && dist != SUITE_SAME_SIGN )
+        continue;
+      cases[ncases].op = op;
+      cases[ncases].dist = dist;
+      cases[ncases].passes = suite_calibrate( suite_ops[op].fn, &in[dist] );
+      ncases++;
+    }
+  }
+
+  //the repetitions are made in rounds over all the cases, so a slow
+  //phase of the machine affects one sample of many cases rather than
+  //all the samples of one
+  double *samples = malloc( ncases * opts->repeat * sizeof( double ) );
+  uint32_t acc = 0;
+  for ( int r = 0; r < opts->repeat; r++ ) {
+    for ( int c = 0; c < ncases; c++ ) {
+      suite_case_t *sc = &cases[c];
+      double start = bench_now_ns();
+      acc += suite_ops[sc->op].fn( &in[sc->dist], sc->passes );
+      samples[c * opts->repeat + r] = ( bench_now_ns() - start ) / ( (double) sc->passes * BENCH_N );
+    }
+  }
+  bench_sink = acc;
+
+  //with a baseline, its times are scaled by how much faster or slower
+  //the machine is now, as measured by the reference kernel
+  double scale = 1.0;
+  for ( int c = 0; c < ncases && opts->baseline; c++ ) {
+    if ( suite_ops[cases[c].op].fn != suite_reference )
+      continue;
+    suite_stats_t st = suite_summarize( &samples[c * opts->repeat], opts->repeat );
+    for ( int i = 0; i < nbase; i++ ) {
+      if ( strcmp( base[i].op, "reference" ) == 0 )
+        scale = st.median / base[i].ns;
+    }
+  }
+
+  if ( opts->baseline ) {
+    printf( "machine speed vs baseline: %.3fx (baseline times are scaled by it)\n", 1.0 / scale );
+    printf( "%-12s %-16s %10s %10s %8s  %s\n", "op", "distribution", "baseline", "median", "change",
+            "95% CI" );
+  } else if ( opts->format == SUITE_CSV ) {
+    printf( "op,distribution,ns_per_op,ops_per_s,ci_low,ci_high,samples\n" );
+  } else if ( opts->format == SUITE_JSON ) {
+    printf( "{\n  \"benchmarks\": [\n" );
+  }
+
+  for ( int c = 0; c < ncases; c++ ) {
+    suite_stats_t st = suite_summarize( &samples[c * opts->repeat], opts->repeat );
+    const char *name = suite_ops[cases[c].op].name, *dist_name = suite_dist_names[cases[c].dist];
+    double ns = st.median;
+
+    if ( opts->baseline ) {
+      //a regression is a median slower than the threshold allows,
+      //with a confidence interval entirely above the baseline's
+      const suite_baseline_t *b = NULL;
+      for ( int i = 0; i < nbase; i++ ) {
+        if ( strcmp( base[i].op, name ) == 0 && strcmp( base[i].dist, dist_name ) == 0 )
+          b = &base[i];
+      }
+      if ( suite_ops[cases[c].op].fn == suite_reference ) {
+        continue;
+      } else if ( !b ) {
+        printf( "%-12s %-16s %10s %10.2f %8s  [%.2f, %.2f]  (not in baseline)\n", name, dist_name,
+                "-", ns, "-", st.ci_low, st.ci_high );
+      } else {
+        double base_ns = b->ns * scale;
+        double change = ( ns / base_ns - 1.0 ) * 100.0;
+        bool regressed = change > opts->threshold && st.ci_low > b->ci_high * scale;
+        regressions += regressed;
+        printf( "%-12s %-16s %10.2f %10.2f %+7.1f%%  [%.2f, %.2f]%s\n", name, dist_name, base_ns, ns,
+                change, st.ci_low, st.ci_high, regressed ? "  REGRESSION" : "" );
+      }
+    } else if ( opts->format == SUITE_CSV ) {
+      printf( "%s,%s,%.3f,%.0f,%.3f,%.3f,%d\n", name, dist_name, ns, 1e9 / ns, st.ci_low, st.ci_high,
+              st.samples );
+    } else if ( opts->format == SUITE_JSON ) {
+      printf( "    { \"op\": \"%s\", \"distribution\": \"%s\", \"ns_per_op\": %.3f, \"ops_per_s\": %.0f, "
+              "\"ci_low\": %.3f, \"ci_high\": %.3f, \"samples\": %d }%s\n",
+              name, dist_name, ns, 1e9 / ns, st.ci_low, st.ci_high, st.samples, c + 1 < ncases ? "," : "" );
+    } else {
+      printf( "%-12s %-16s %8.2f ns/op %14.0f ops/s", name, dist_name, ns, 1e9 / ns );
+      if ( st.samples > 1 )
+        printf( "  [%.2f, %.2f]", st.ci_low, st.ci_high );
+      printf( "\n" );
+    }
+  }
+
+  if ( !opts->baseline && opts->format == SUITE_JSON )
+    printf( "  ]\n}\n" );
+  free( samples );
+  free( in );
+  if ( regressions > 0 ) {
+    fprintf( stderr, "%d benchmark(s) regressed by more than %.1f%% against %s\n", regressions,
+             opts->threshold, opts->baseline );
+    return 1;
+  }
+  return 0;
+}
+
+int main( int argc, char **argv ) {
+  //--suite runs the benchmark suite instead (see run_suite)
+  bool suite = false;
+  suite_options_t opts = { SUITE_TEXT, 0, NULL, 10.0 };
+  for ( int i = 1; i < argc; i++ ) {
+    if ( strcmp( argv[i], "--suite" ) == 0 ) {
+      suite = true;
+    } else if ( strcmp( argv[i], "--format=text" ) == 0 ) {
+      opts.format = SUITE_TEXT;
+    } else if ( strcmp( argv[i], "--format=csv" ) == 0 ) {
+      opts.format = SUITE_CSV;
+    } else if ( strcmp( argv[i], "--format=json" ) == 0 ) {
+      opts.format = SUITE_JSON;
+    } else if ( strncmp( argv[i], "--repeat=", 9 ) == 0 && atoi( argv[i] + 9 ) > 0 ) {
+      opts.repeat = atoi( argv[i] + 9 );
+    } else if ( strncmp( argv[i], "--compare=", 10 ) == 0 ) {
+      opts.baseline = argv[i] + 10;
+    } else if ( strncmp( argv[i], "--threshold=", 12 ) == 0 ) {
+      opts.threshold = atof( argv[i] + 12 );
+    } else {
+      fprintf( stderr, "Usage: %s [--suite [--format=text|csv|json] [--repeat=N]\n"
+               "                  [--compare=BASELINE.json [--threshold=PERCENT]]]\n", argv[0] );
+      return 1;
+    }
+  }
+  //comparisons need several samples for their confidence intervals
+  if ( opts.repeat == 0 )
+    opts.repeat = opts.baseline ? 9 : 1;
+  if ( suite )
+    return run_suite( &opts );
+
+  fixpoint_t *left = malloc( BENCH_N * sizeof( fixpoint_t ) );
+  fixpoint_t *right = malloc( BENCH_N * sizeof( fixpoint_t ) );
+  fixpoint_t *out = malloc( BENCH_N * sizeof( fixpoint_t ) );
+  result_t *flags = malloc( BENCH_N * sizeof( result_t ) );
+
+  fill_mixed_sign( left, BENCH_N );
+  fill_mixed_sign( right, BENCH_N );
+
+  printf( "mixed-sign random inputs, %d values x %d passes\n", BENCH_N, BENCH_PASSES );
+
+  double ref_add = bench_binop( fixpoint_ref_add, left, right, out );
+  report( "add (baseline)", ref_add, 0.0 );
+  report( "add", bench_binop( fixpoint_add, left, right, out ), ref_add );
+
+  double ref_sub = bench_binop( fixpoint_ref_sub, left, right, out );
+  report( "sub (baseline)", ref_sub, 0.0 );
+  report( "sub", bench_binop( fixpoint_sub, left, right, out ), ref_sub );
+
+  double calls = bench_calls( left, right, out );
+  report( "calls (out-of-line)", calls, 0.0 );
+  report( "calls (inline)", bench_inline_calls( left, right, out ), calls );
+
+  double add = bench_binop( fixpoint_add, left, right, out );
+  report( "add_n", bench_batch( fixpoint_add_n, left, right, out, flags ), add );
+  double sub = bench_binop( fixpoint_sub, left, right, out );
+  report( "sub_n", bench_batch( fixpoint_sub_n, left, right, out, flags ), sub );
+  double mul = bench_binop( fixpoint_mul, left, right, out );
+  report( "mul", mul, 0.0 );
+  report( "mul_n", bench_batch( fixpoint_mul_n, left, right, out, flags ), mul );
+
+  double add_clamp = bench_batch( add_n_then_clamp, left, right, out, flags );
+  report( "add_n + clamp (baseline)", add_clamp, 0.0 );
+  report( "add_sat_n", bench_batch( fixpoint_add_sat_n, left, right, out, flags ), add_clamp );
+  double mul_clamp = bench_batch( mul_n_then_clamp, left, right, out, flags );
+  report( "mul_n + clamp (baseline)", mul_clamp, 0.0 );
+  report( "mul_sat_n", bench_batch( fixpoint_mul_sat_n, left, right, out, flags ), mul_clamp );
+  double mul_n = bench_batch( fixpoint_mul_n, left, right, out, flags );
+  report( "mul_rne_n", bench_batch( fixpoint_mul_rne_n, left, right, out, flags ), mul_n );
+  report( "mul_stochastic_n", bench_batch( mul_stochastic_n, left, right, out, flags ), mul_n );
+
+  fixpoint_t *addend = malloc( BENCH_N * sizeof( fixpoint_t ) );
+  fill_mixed_sign( addend, BENCH_N );
+  double mul_add = bench_ternop( mul_then_add, left, right, addend, out );
+  report( "mul+add (baseline)", mul_add, 0.0 );
+  report( "fma", bench_ternop( fixpoint_fma, left, right, addend, out ), mul_add );
+  free( addend );
+
+  double sum = bench_sum( chained_sum, left );
+  report( "sum (chained add)", sum, 0.0 );
+  report( "sum_n", bench_sum( fixpoint_sum_n, left ), sum );
+  double dot = bench_dot( chained_dot, left, right );
+  report( "dot (chained mul+add)", dot, 0.0 );
+  report( "dot_n", bench_dot( fixpoint_dot_n, left, right ), dot );
+
+  double div_double = bench_binop( div_via_double, left, right, out );
+  report( "div (via double)", div_double, 0.0 );
+  report( "div", bench_binop( fixpoint_div, left, right, out ), div_double );
+  //dividing every element by the same value
+  fixpoint_t *divisor = malloc( BENCH_N * sizeof( fixpoint_t ) );
+  for ( size_t i = 0; i < BENCH_N; i++ )
+    divisor[i] = right[0];
+  double div_one = bench_binop( fixpoint_div, left, divisor, out );
+  report( "div (same divisor)", div_one, 0.0 );
+  fixpoint_recip_t recip;
+  fixpoint_recip_init( &recip, &right[0] );
+  report( "div_recip_n", bench_div_recip_n( left, &recip, out, flags ), div_one );
+  free( divisor );
+
+  //non-negative inputs for sqrt and log, and inputs in (-22, 22) for
+  //exp (so its result is neither saturated nor 0)
+  fixpoint_t *pos = malloc( BENCH_N * sizeof( fixpoint_t ) );
+  fixpoint_t *small = malloc( BENCH_N * sizeof( fixpoint_t ) );
+  for ( size_t i = 0; i < BENCH_N; i++ ) {
+    fixpoint_init( &pos[i], left[i].whole, left[i].frac, false );
+    fixpoint_init( &small[i], left[i].whole % 22, left[i].frac, left[i].negative );
+  }
+  double sqrt_double = bench_unop( sqrt_via_double, pos, out );
+  report( "sqrt (via double)", sqrt_double, 0.0 );
+  report( "sqrt", bench_unop( fixpoint_sqrt, pos, out ), sqrt_double );
+  double exp_double = bench_unop( exp_via_double, small, out );
+  report( "exp (via double)", exp_double, 0.0 );
+  report( "exp", bench_unop( fixpoint_exp, small, out ), exp_double );
+  double log_double = bench_unop( log_via_double, pos, out );
+  report( "log (via double)", log_double, 0.0 );
+  report( "log", bench_unop( fixpoint_log, pos, out ), log_double );
+  double sin_double = bench_unop( sin_via_double, left, out );
+  report( "sin (via double)", sin_double, 0.0 );
+  report( "sin", bench_unop( fixpoint_sin, left, out ), sin_double );
+  double cos_double = bench_unop( cos_via_double, left, out );
+  report( "cos (via double)", cos_double, 0.0 );
+  report( "cos", bench_unop( fixpoint_cos, left, out ), cos_double );
+  free( pos );
+  free( small );
+
+  double ref_format = bench_format( fixpoint_ref_format_hex, left );
+  report( "format_hex (baseline)", ref_format, 0.0 );
+  report( "format_hex", bench_format( fixpoint_format_hex, left ), ref_format );
+
+  fixpoint_str_t *strs = malloc( BENCH_N * sizeof( fixpoint_str_t ) );
+  double ref_format_dec = bench_format( fixpoint_ref_format_dec, left );
+  report( "format_dec (baseline)", ref_format_dec, 0.0 );
+  double format_dec = bench_format( fixpoint_format_dec, left );
+  report( "format_dec", format_dec, ref_format_dec );
+  report( "format_dec_n", bench_format_dec_n( left, strs ), format_dec );
+  fixpoint_format_dec_n( strs, left, BENCH_N );
+  double ref_parse_dec = bench_parse( fixpoint_ref_parse_dec, strs );
+  report( "parse_dec (baseline)", ref_parse_dec, 0.0 );
+  double parse_dec = bench_parse( fixpoint_parse_dec, strs );
+  report( "parse_dec", parse_dec, ref_parse_dec );
+  report( "parse_dec_n", bench_parse_dec_n( strs, out ), parse_dec );
+
+  for ( int digits = 1; digits <= 8; digits *= 2 )
+    bench_parse_size( digits, strs );
+  free( strs );
+  bench_parse_stream();
+  bench_binary_file();
+
+  fixpoint_column_t lcol, rcol, ocol;
+  fixpoint_column_init( &lcol, BENCH_N );
+  fixpoint_column_init( &rcol, BENCH_N );
+  fixpoint_column_init( &ocol, BENCH_N );
+  fixpoint_column_from_array( &lcol, left );
+  fixpoint_column_from_array( &rcol, right );
+  for ( int isa = FIXPOINT_ISA_SCALAR; isa <= FIXPOINT_ISA_AVX2; isa++ ) {
+    if ( !fixpoint_set_isa( isa ) )
+      continue;
+    char name[64];
+    snprintf( name, sizeof( name ), "column_add (%s)", isa_names[isa] );
+    report( name, bench_column( fixpoint_column_add, &lcol, &rcol, &ocol, flags ), add );
+    snprintf( name, sizeof( name ), "column_mul (%s)", isa_names[isa] );
+    report( name, bench_column( fixpoint_column_mul, &lcol, &rcol, &ocol, flags ), mul );
+  }
+  fixpoint_column_cleanup( &lcol );
+  fixpoint_column_cleanup( &rcol );
+  fixpoint_column_cleanup( &ocol );
+
+  bench_reductions( left );
+  bench_packed( left, out );
+  for ( size_t n = 64; n <= ( 1 << 20 ); n *= 16 )
+    bench_sort( n );
+
+  free( left );
+  free( right );
+  free( out );
+  free( flags );
+  return 0;
+}
@@ -0,0 +1,575 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fixpoint_column.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FIXPOINT_COLUMN_X86 1
+#endif
+
+////////////////////////////////////////////////////////////////////////
+// Helper functions
+////////////////////////////////////////////////////////////////////////
+
+// Alignment of the whole and frac arrays (one AVX2 register)
+#define COLUMN_ALIGN 32
+
+// Helper function to allocate a zeroed, COLUMN_ALIGN aligned array
+static void *
+column_alloc( size_t nbytes ) {
+  //aligned_alloc requires a size that is a multiple of the alignment
+  size_t size = (nbytes + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN;
+  if (size == 0) size = COLUMN_ALIGN;
+  void *buf = aligned_alloc(COLUMN_ALIGN, size);
+  if (buf) memset(buf, 0, size);
+  return buf;
+}
+
+static bool
+column_sign( const fixpoint_column_t *col, size_t i ) {
+  return (col->sign[i / 64] >> (i % 64)) & 1;
+}
+
+static void
+column_set_sign( fixpoint_column_t *col, size_t i, bool negative ) {
+  uint64_t bit = (uint64_t)1 << (i % 64);
+  col->sign[i / 64] = negative ? (col->sign[i / 64] | bit) : (col->sign[i / 64] & ~bit);
+}
+
+// Get the count (at most 8) sign bits starting at element i, which
+// must be a multiple of count (so the bits are in one word)
+static unsigned
+column_sign_bits( const fixpoint_column_t *col, size_t i, unsigned count ) {
+  return (unsigned)(col->sign[i / 64] >> (i % 64)) & ((1u << count) - 1);
+}
+
+// Set the count (at most 8) sign bits starting at element i
+static void
+column_set_sign_bits( fixpoint_column_t *col, size_t i, unsigned count, unsigned bits ) {
+  uint64_t mask = (uint64_t)((1u << count) - 1) << (i % 64);
+  col->sign[i / 64] = (col->sign[i / 64] & ~mask) | ((uint64_t)bits << (i % 64));
+}
+
+////////////////////////////////////////////////////////////////////////
+// Scalar kernels
+//
+// These process elements [begin, size) one at a time using the
+// fixpoint.c functions. They are the fallback when no SIMD
+// instruction set is available, and handle the elements left over
+// after the SIMD loops.
+////////////////////////////////////////////////////////////////////////
+
+static result_t
+scalar_add_sub( fixpoint_column_t *result, const fixpoint_column_t *left,
+                const fixpoint_column_t *right, result_t *flags, bool is_sub, size_t begin ) {
+  result_t all = RESULT_OK;
+  for (size_t i = begin; i < result->size; i++) {
+    fixpoint_t l, r, res;
+    fixpoint_column_get(&l, left, i);
+    fixpoint_column_get(&r, right, i);
+    result_t ret = is_sub ? fixpoint_sub(&res, &l, &r) : fixpoint_add(&res, &l, &r);
+    fixpoint_column_set(result, i, &res);
+    if (flags) flags[i] = ret;
+    all |= ret;
+  }
+  return all;
+}
+
+static result_t
+scalar_mul( fixpoint_column_t *result, const fixpoint_column_t *left,
+            const fixpoint_column_t *right, result_t *flags, size_t begin ) {
+  result_t all = RESULT_OK;
+  for (size_t i = begin; i < result->size; i++) {
+    fixpoint_t l, r, res;
+    fixpoint_column_get(&l, left, i);
+    fixpoint_column_get(&r, right, i);
+    result_t ret = fixpoint_mul(&res, &l, &r);
+    fixpoint_column_set(result, i, &res);
+    if (flags) flags[i] = ret;
+    all |= ret;
+  }
+  return all;
+}
+
+static void
+scalar_compare( int *result, const fixpoint_column_t *left,
+                const fixpoint_column_t *right, size_t begin ) {
+  for (size_t i = begin; i < left->size; i++) {
+    fixpoint_t l, r;
+    fixpoint_column_get(&l, left, i);
+    fixpoint_column_get(&r, right, i);
+    result[i] = fixpoint_compare(&l, &r);
+  }
+}
+
+static result_t
+scalar_add_sub_all( fixpoint_column_t *result, const fixpoint_column_t *left,
+                    const fixpoint_column_t *right, result_t *flags, bool is_sub ) {
+  return scalar_add_sub(result, left, right, flags, is_sub, 0);
+}
+
+static result_t
+scalar_mul_all( fixpoint_column_t *result, const fixpoint_column_t *left,
+                const fixpoint_column_t *right, result_t *flags ) {
+  return scalar_mul(result, left, right, flags, 0);
+}
+
+static void
+scalar_compare_all( int *result, const fixpoint_column_t *left, const fixpoint_column_t *right ) {
+  scalar_compare(result, left, right, 0);
+}
+
+#ifdef FIXPOINT_COLUMN_X86
+
+////////////////////////////////////////////////////////////////////////
+// SSE4.1 kernels
+//
+// The SIMD kernels follow the same steps as fixpoint_inline_add_sub
+// and fixpoint_inline_mul, with every comparison turned into a
+// lane mask and every selection into a blend, so they produce
+// bit-identical results.
+////////////////////////////////////////////////////////////////////////
+
+#define SSE41 __attribute__((target("sse4.1")))
+
+// Unsigned a < b for 32 bit lanes (as a mask)
+SSE41 static __m128i
+sse41_ltu32( __m128i a, __m128i b ) {
+  const __m128i bias = _mm_set1_epi32((int)0x80000000);
+  return _mm_cmpgt_epi32(_mm_xor_si128(b, bias), _mm_xor_si128(a, bias));
+}
+
+// Expand 4 sign bits to 32 bit lane masks
+SSE41 static __m128i
+sse41_expand_signs32( unsigned bits ) {
+  const __m128i sel = _mm_setr_epi32(1, 2, 4, 8);
+  return _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32((int)bits), sel), sel);
+}
+
+// Expand 2 sign bits to 64 bit lane masks
+SSE41 static __m128i
+sse41_expand_signs64( unsigned bits ) {
+  const __m128i sel = _mm_set_epi64x(2, 1);
+  return _mm_cmpeq_epi64(_mm_and_si128(_mm_set1_epi64x(bits), sel), sel);
+}
+
+SSE41 static int
+sse41_or_lanes( __m128i v ) {
+  v = _mm_or_si128(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2)));
+  v = _mm_or_si128(v, _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(v);
+}
+
+SSE41 static result_t
+sse41_add_sub( fixpoint_column_t *result, const fixpoint_column_t *left,
+               const fixpoint_column_t *right, result_t *flags, bool is_sub ) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi32(-1);
+  const __m128i sub_mask = is_sub ? ones : zero;
+  const __m128i overflow_flag = _mm_set1_epi32(RESULT_OVERFLOW);
+  __m128i all = zero;
+  size_t i = 0;
+
+  for (; i + 4 <= result->size; i += 4) {
+    __m128i lw = _mm_loadu_si128((const __m128i *)(left->whole + i));
+    __m128i lf = _mm_loadu_si128((const __m128i *)(left->frac + i));
+    __m128i rw = _mm_loadu_si128((const __m128i *)(right->whole + i));
+    __m128i rf = _mm_loadu_si128((const __m128i *)(right->frac + i));
+    __m128i ls = sse41_expand_signs32(column_sign_bits(left, i, 4));
+    __m128i rs = _mm_xor_si128(sse41_expand_signs32(column_sign_bits(right, i, 4)), sub_mask);
+    __m128i same = _mm_xor_si128(_mm_xor_si128(ls, rs), ones);
+
+    //sum of the magnitudes, with the carry out of bit 63
+    __m128i sf = _mm_add_epi32(lf, rf);
+    __m128i cf = sse41_ltu32(sf, lf);
+    __m128i t = _mm_add_epi32(lw, rw);
+    __m128i sw = _mm_sub_epi32(t, cf);
+    __m128i carry = _mm_or_si128(sse41_ltu32(t, lw), _mm_and_si128(cf, _mm_cmpeq_epi32(sw, zero)));
+
+    //absolute difference of the magnitudes, with the borrow
+    __m128i df = _mm_sub_epi32(lf, rf);
+    __m128i bf = sse41_ltu32(lf, rf);
+    __m128i dw = _mm_add_epi32(_mm_sub_epi32(lw, rw), bf);
+    __m128i borrow = _mm_or_si128(sse41_ltu32(lw, rw), _mm_and_si128(_mm_cmpeq_epi32(lw, rw), bf));
+    __m128i nf = _mm_sub_epi32(zero, df);
+    __m128i nw = _mm_sub_epi32(_mm_xor_si128(dw, ones), _mm_cmpeq_epi32(df, zero));
+    df = _mm_blendv_epi8(df, nf, borrow);
+    dw = _mm_blendv_epi8(dw, nw, borrow);
+
+    __m128i mw = _mm_blendv_epi8(dw, sw, same);
+    __m128i mf = _mm_blendv_epi8(df, sf, same);
+    __m128i overflow = _mm_and_si128(same, carry);
+    __m128i nonzero = _mm_xor_si128(_mm_cmpeq_epi32(_mm_or_si128(mw, mf), zero), ones);
+    __m128i neg = _mm_and_si128(_mm_xor_si128(ls, _mm_andnot_si128(same, borrow)),
+                                _mm_or_si128(nonzero, overflow));
+
+    _mm_storeu_si128((__m128i *)(result->whole + i), mw);
+    _mm_storeu_si128((__m128i *)(result->frac + i), mf);
+    column_set_sign_bits(result, i, 4, (unsigned)_mm_movemask_ps(_mm_castsi128_ps(neg)));
+    __m128i fl = _mm_and_si128(overflow, overflow_flag);
+    if (flags) _mm_storeu_si128((__m128i *)(flags + i), fl);
+    all = _mm_or_si128(all, fl);
+  }
+
+  return sse41_or_lanes(all) | scalar_add_sub(result, left, right, flags, is_sub, i);
+}
+
+SSE41 static result_t
+sse41_mul( fixpoint_column_t *result, const fixpoint_column_t *left,
+           const fixpoint_column_t *right, result_t *flags ) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i low32 = _mm_set1_epi64x(0xFFFFFFFF);
+  const __m128i overflow_flag = _mm_set1_epi64x(RESULT_OVERFLOW);
+  const __m128i underflow_flag = _mm_set1_epi64x(RESULT_UNDERFLOW);
+  __m128i all = zero;
+  size_t i = 0;
+
+  for (; i + 2 <= result->size; i += 2) {
+    //2 elements, widened to 64 bit lanes
+    __m128i lw = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i *)(left->whole + i)));
+    __m128i lf = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i *)(left->frac + i)));
+    __m128i rw = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i *)(right->whole + i)));
+    __m128i rf = _mm_cvtepu32_epi64(_mm_loadl_epi64((const __m128i *)(right->frac + i)));
+    __m128i neg = sse41_expand_signs64(column_sign_bits(left, i, 2) ^ column_sign_bits(right, i, 2));
+
+    __m128i p0 = _mm_mul_epu32(lf, rf);
+    __m128i p1 = _mm_mul_epu32(lf, rw);
+    __m128i p2 = _mm_mul_epu32(lw, rf);
+    __m128i p3 = _mm_mul_epu32(lw, rw);
+    __m128i middle = _mm_add_epi64(_mm_add_epi64(p1, p2), _mm_srli_epi64(p0, 32));
+    __m128i final_whole = _mm_add_epi64(_mm_and_si128(p3, low32), _mm_srli_epi64(middle, 32));
+
+    __m128i overflow = _mm_or_si128(_mm_srli_epi64(p3, 32), _mm_srli_epi64(final_whole, 32));
+    overflow = _mm_andnot_si128(_mm_cmpeq_epi64(overflow, zero), overflow_flag);
+    __m128i underflow = _mm_andnot_si128(_mm_cmpeq_epi64(_mm_and_si128(p0, low32), zero), underflow_flag);
+    __m128i fl = _mm_or_si128(overflow, underflow);
+    __m128i exact_zero = _mm_and_si128(_mm_cmpeq_epi64(fl, zero),
+                                       _mm_cmpeq_epi64(_mm_and_si128(_mm_or_si128(final_whole, middle), low32), zero));
+    neg = _mm_andnot_si128(exact_zero, neg);
+
+    //gather the low 32 bits of each 64 bit lane
+    __m128i w = _mm_shuffle_epi32(final_whole, _MM_SHUFFLE(3, 1, 2, 0));
+    __m128i f = _mm_shuffle_epi32(middle, _MM_SHUFFLE(3, 1, 2, 0));
+    _mm_storel_epi64((__m128i *)(result->whole + i), w);
+    _mm_storel_epi64((__m128i *)(result->frac + i), f);
+    column_set_sign_bits(result, i, 2, (unsigned)_mm_movemask_pd(_mm_castsi128_pd(neg)));
+    fl = _mm_shuffle_epi32(fl, _MM_SHUFFLE(3, 1, 2, 0));
+    if (flags) _mm_storel_epi64((__m128i *)(flags + i), fl);
+    all = _mm_or_si128(all, fl);
+  }
+
+  return sse41_or_lanes(all) | scalar_mul(result, left, right, flags, i);
+}
+
+SSE41 static void
+sse41_compare( int *result, const fixpoint_column_t *left, const fixpoint_column_t *right ) {
+  size_t i = 0;
+
+  for (; i + 4 <= left->size; i += 4) {
+    __m128i lw = _mm_loadu_si128((const __m128i *)(left->whole + i));
+    __m128i lf = _mm_loadu_si128((const __m128i *)(left->frac + i));
+    __m128i rw = _mm_loadu_si128((const __m128i *)(right->whole + i));
+    __m128i rf = _mm_loadu_si128((const __m128i *)(right->frac + i));
+    __m128i ls = sse41_expand_signs32(column_sign_bits(left, i, 4));
+    __m128i rs = sse41_expand_signs32(column_sign_bits(right, i, 4));
+
+    //masks are -1 for true, so lt - gt is -1, 0 or 1
+    __m128i wc = _mm_sub_epi32(sse41_ltu32(lw, rw), sse41_ltu32(rw, lw));
+    __m128i fc = _mm_sub_epi32(sse41_ltu32(lf, rf), sse41_ltu32(rf, lf));
+    __m128i whole_equal = _mm_cmpeq_epi32(wc, _mm_setzero_si128());
+    __m128i mag_cmp = _mm_blendv_epi8(wc, fc, whole_equal);
+    __m128i same_sign_cmp = _mm_sub_epi32(_mm_xor_si128(mag_cmp, ls), ls);
+    __m128i sign_cmp = _mm_sub_epi32(ls, rs);
+    __m128i cmp = _mm_blendv_epi8(same_sign_cmp, sign_cmp, _mm_xor_si128(ls, rs));
+    _mm_storeu_si128((__m128i *)(result + i), cmp);
+  }
+
+  scalar_compare(result, left, right, i);
+}
+
+////////////////////////////////////////////////////////////////////////
+// AVX2 kernels (same steps as the SSE4.1 kernels, twice as wide)
+////////////////////////////////////////////////////////////////////////
+
+#define AVX2 __attribute__((target("avx2")))
+
+AVX2 static __m256i
+avx2_ltu32( __m256i a, __m256i b ) {
+  const __m256i bias = _mm256_set1_epi32((int)0x80000000);
+  return _mm256_cmpgt_epi32(_mm256_xor_si256(b, bias), _mm256_xor_si256(a, bias));
+}
+
+AVX2 static __m256i
+avx2_expand_signs32( unsigned bits ) {
+  const __m256i sel = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+  return _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32((int)bits), sel), sel);
+}
+
+AVX2 static __m256i
+avx2_expand_signs64( unsigned bits ) {
+  const __m256i sel = _mm256_setr_epi64x(1, 2, 4, 8);
+  return _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_set1_epi64x(bits), sel), sel);
+}
+
+AVX2 static int
+avx2_or_lanes( __m256i v ) {
+  __m128i x = _mm_or_si128(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+  x = _mm_or_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 0, 3, 2)));
+  x = _mm_or_si128(x, _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 3, 0, 1)));
+  return _mm_cvtsi128_si32(x);
+}
+
+// Gather the low 32 bits of the four 64 bit lanes
+AVX2 static __m128i
+avx2_low32( __m256i v ) {
+  const __m256i idx = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+  return _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(v, idx));
+}
+
+AVX2 static result_t
+avx2_add_sub( fixpoint_column_t *result, const fixpoint_column_t *left,
+              const fixpoint_column_t *right, result_t *flags, bool is_sub ) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ones = _mm256_set1_epi32(-1);
+  const __m256i sub_mask = is_sub ? ones : zero;
+  const __m256i overflow_flag = _mm256_set1_epi32(RESULT_OVERFLOW);
+  __m256i all = zero;
+  size_t i = 0;
+
+  for (; i + 8 <= result->size; i += 8) {
+    __m256i lw = _mm256_loadu_si256((const __m256i *)(left->whole + i));
+    __m256i lf = _mm256_loadu_si256((const __m256i *)(left->frac + i));
+    __m256i rw = _mm256_loadu_si256((const __m256i *)(right->whole + i));
+    __m256i rf = _mm256_loadu_si256((const __m256i *)(right->frac + i));
+    __m256i ls = avx2_expand_signs32(column_sign_bits(left, i, 8));
+    __m256i rs = _mm256_xor_si256(avx2_expand_signs32(column_sign_bits(right, i, 8)), sub_mask);
+    __m256i same = _mm256_xor_si256(_mm256_xor_si256(ls, rs), ones);
+
+    //sum of the magnitudes, with the carry out of bit 63
+    __m256i sf = _mm256_add_epi32(lf, rf);
+    __m256i cf = avx2_ltu32(sf, lf);
+    __m256i t = _mm256_add_epi32(lw, rw);
+    __m256i sw = _mm256_sub_epi32(t, cf);
+    __m256i carry = _mm256_or_si256(avx2_ltu32(t, lw), _mm256_and_si256(cf, _mm256_cmpeq_epi32(sw, zero)));
+
+    //absolute difference of the magnitudes, with the borrow
+    __m256i df = _mm256_sub_epi32(lf, rf);
+    __m256i bf = avx2_ltu32(lf, rf);
+    __m256i dw = _mm256_add_epi32(_mm256_sub_epi32(lw, rw), bf);
+    __m256i borrow = _mm256_or_si256(avx2_ltu32(lw, rw), _mm256_and_si256(_mm256_cmpeq_epi32(lw, rw), bf));
+    __m256i nf = _mm256_sub_epi32(zero, df);
+    __m256i nw = _mm256_sub_epi32(_mm256_xor_si256(dw, ones), _mm256_cmpeq_epi32(df, zero));
+    df = _mm256_blendv_epi8(df, nf, borrow);
+    dw = _mm256_blendv_epi8(dw, nw, borrow);
+
+    __m256i mw = _mm256_blendv_epi8(dw, sw, same);
+    __m256i mf = _mm256_blendv_epi8(df, sf, same);
+    __m256i overflow = _mm256_and_si256(same, carry);
+    __m256i nonzero = _mm256_xor_si256(_mm256_cmpeq_epi32(_mm256_or_si256(mw, mf), zero), ones);
+    __m256i neg = _mm256_and_si256(_mm256_xor_si256(ls, _mm256_andnot_si256(same, borrow)),
+                                   _mm256_or_si256(nonzero, overflow));
+
+    _mm256_storeu_si256((__m256i *)(result->whole + i), mw);
+    _mm256_storeu_si256((__m256i *)(result->frac + i), mf);
+    column_set_sign_bits(result, i, 8, (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(neg)));
+    __m256i fl = _mm256_and_si256(overflow, overflow_flag);
+    if (flags) _mm256_storeu_si256((__m256i *)(flags + i), fl);
+    all = _mm256_or_si256(all, fl);
+  }
+
+  return avx2_or_lanes(all) | scalar_add_sub(result, left, right, flags, is_sub, i);
+}
+
+AVX2 static result_t
+avx2_mul( fixpoint_column_t *result, const fixpoint_column_t *left,
+          const fixpoint_column_t *right, result_t *flags ) {
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i low32 = _mm256_set1_epi64x(0xFFFFFFFF);
+  const __m256i overflow_flag = _mm256_set1_epi64x(RESULT_OVERFLOW);
+  const __m256i underflow_flag = _mm256_set1_epi64x(RESULT_UNDERFLOW);
+  __m256i all = zero;
+  size_t i = 0;
+
+  for (; i + 4 <= result->size; i += 4) {
+    //4 elements, widened to 64 bit lanes
+    __m256i lw = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(left->whole + i)));
+    __m256i lf = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(left->frac + i)));
+    __m256i rw = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(right->whole + i)));
+    __m256i rf = _mm256_cvtepu32_epi64(_mm_loadu_si128((const __m128i *)(right->frac + i)));
+    __m256i neg = avx2_expand_signs64(column_sign_bits(left, i, 4) ^ column_sign_bits(right, i, 4));
+
+    __m256i p0 = _mm256_mul_epu32(lf, rf);
+    __m256i p1 = _mm256_mul_epu32(lf, rw);
+    __m256i p2 = _mm256_mul_epu32(lw, rf);
+    __m256i p3 = _mm256_mul_epu32(lw, rw);
+    __m256i middle = _mm256_add_epi64(_mm256_add_epi64(p1, p2), _mm256_srli_epi64(p0, 32));
+    __m256i final_whole = _mm256_add_epi64(_mm256_and_si256(p3, low32), _mm256_srli_epi64(middle, 32));
+
+    __m256i overflow = _mm256_or_si256(_mm256_srli_epi64(p3, 32), _mm256_srli_epi64(final_whole, 32));
+    overflow = _mm256_andnot_si256(_mm256_cmpeq_epi64(overflow, zero), overflow_flag);
+    __m256i underflow = _mm256_andnot_si256(_mm256_cmpeq_epi64(_mm256_and_si256(p0, low32), zero),
+                                            underflow_flag);
+    __m256i fl = _mm256_or_si256(overflow, underflow);
+    __m256i exact_zero = _mm256_and_si256(
+      _mm256_cmpeq_epi64(fl, zero),
+      _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_or_si256(final_whole, middle), low32), zero));
+    neg = _mm256_andnot_si256(exact_zero, neg);
+
+    _mm_storeu_si128((__m128i *)(result->whole + i), avx2_low32(final_whole));
+    _mm_storeu_si128((__m128i *)(result->frac + i), avx2_low32(middle));
+    column_set_sign_bits(result, i, 4, (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(neg)));
+    __m128i fl32 = avx2_low32(fl);
+    if (flags) _mm_storeu_si128((__m128i *)(flags + i), fl32);
+    all = _mm256_or_si256(all, fl);
+  }
+
+  return avx2_or_lanes(all) | scalar_mul(result, left, right, flags, i);
+}
+
+AVX2 static void
+avx2_compare( int *result, const fixpoint_column_t *left, const fixpoint_column_t *right ) {
+  const __m256i zero = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 8 <= left->size; i += 8) {
+    __m256i lw = _mm256_loadu_si256((const __m256i *)(left->whole + i));
+    __m256i lf = _mm256_loadu_si256((const __m256i *)(left->frac + i));
+    __m256i rw = _mm256_loadu_si256((const __m256i *)(right->whole + i));
+    __m256i rf = _mm256_loadu_si256((const __m256i *)(right->frac + i));
+    __m256i ls = avx2_expand_signs32(column_sign_bits(left, i, 8));
+    __m256i rs = avx2_expand_signs32(column_sign_bits(right, i, 8));
+
+    //masks are -1 for true, so lt - gt is -1, 0 or 1
+    __m256i wc = _mm256_sub_epi32(avx2_ltu32(lw, rw), avx2_ltu32(rw, lw));
+    __m256i fc = _mm256_sub_epi32(avx2_ltu32(lf, rf), avx2_ltu32(rf, lf));
+    __m256i whole_equal = _mm256_cmpeq_epi32(wc, zero);
+    __m256i mag_cmp = _mm256_blendv_epi8(wc, fc, whole_equal);
+    __m256i same_sign_cmp = _mm256_sub_epi32(_mm256_xor_si256(mag_cmp, ls), ls);
+    __m256i sign_cmp = _mm256_sub_epi32(ls, rs);
+    __m256i cmp = _mm256_blendv_epi8(same_sign_cmp, sign_cmp, _mm256_xor_si256(ls, rs));
+    _mm256_storeu_si256((__m256i *)(result + i), cmp);
+  }
+
+  scalar_compare(result, left, right, i);
+}
+
+#endif // FIXPOINT_COLUMN_X86
+
+////////////////////////////////////////////////////////////////////////
+// Kernel selection
+////////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  result_t (*add_sub)( fixpoint_column_t *, const fixpoint_column_t *,
+                       const fixpoint_column_t *, result_t *, bool );
+  result_t (*mul)( fixpoint_column_t *, const fixpoint_column_t *,
+                   const fixpoint_column_t *, result_t * );
+  void (*compare)( int *, const fixpoint_column_t *, const fixpoint_column_t * );
+} column_kernels_t;
+
+static const column_kernels_t column_kernels[] = {
+  [FIXPOINT_ISA_SCALAR] = { scalar_add_sub_all, scalar_mul_all, scalar_compare_all },
+#ifdef FIXPOINT_COLUMN_X86
+  [FIXPOINT_ISA_SSE41] = { sse41_add_sub, sse41_mul, sse41_compare },
+  [FIXPOINT_ISA_AVX2] = { avx2_add_sub, avx2_mul, avx2_compare },
+#endif
+};
+
+static const column_kernels_t *
+column_get_kernels( void ) {
+  return &column_kernels[fixpoint_get_isa()];
+}
+
+////////////////////////////////////////////////////////////////////////
+// Column API functions
+////////////////////////////////////////////////////////////////////////
+
+bool
+fixpoint_column_init( fixpoint_column_t *col, size_t n ) {
+  col->whole = column_alloc(n * sizeof(uint32_t));
+  col->frac = column_alloc(n * sizeof(uint32_t));
+  col->sign = calloc(n / 64 + 1, sizeof(uint64_t));
+  col->size = n;
+  if (!col->whole || !col->frac || !col->sign) {
+    fixpoint_column_cleanup(col);
+    return false;
+  }
+  return true;
+}
+
+void
+fixpoint_column_cleanup( fixpoint_column_t *col ) {
+  free(col->whole);
+  free(col->frac);
+  free(col->sign);
+  col->whole = NULL;
+  col->frac = NULL;
+  col->sign = NULL;
+  col->size = 0;
+}
+
+void
+fixpoint_column_get( fixpoint_t *val, const fixpoint_column_t *col, size_t i ) {
+  val->whole = col->whole[i];
+  val->frac = col->frac[i];
+  val->negative = column_sign(col, i);
+}
+
+void
+fixpoint_column_set( fixpoint_column_t *col, size_t i, const fixpoint_t *val ) {
+  col->whole[i] = val->whole;
+  col->frac[i] = val->frac;
+  column_set_sign(col, i, val->negative);
+}
+
+void
+fixpoint_column_from_array( fixpoint_column_t *col, const fixpoint_t *vals ) {
+  for (size_t i = 0; i < col->size; i++) {
+    col->whole[i] = vals[i].whole;
+    col->frac[i] = vals[i].frac;
+  }
+  //build the sign bitmap a word at a time
+  for (size_t w = 0; w * 64 < col->size; w++) {
+    uint64_t bits = 0;
+    for (size_t k = 0; k < 64 && w * 64 + k < col->size; k++) {
+      bits |= (uint64_t)vals[w * 64 + k].negative << k;
+    }
+    col->sign[w] = bits;
+  }
+}
+
+void
+fixpoint_column_to_array( fixpoint_t *vals, const fixpoint_column_t *col ) {
+  for (size_t i = 0; i < col->size; i++) {
+    fixpoint_column_get(&vals[i], col, i);
+  }
+}
+
+result_t
+fixpoint_column_add( fixpoint_column_t *result, const fixpoint_column_t *left,
+                     const fixpoint_column_t *right, result_t *flags ) {
+  assert(result->size == left->size && result->size == right->size);
+  return column_get_kernels()->add_sub(result, left, right, flags, false);
+}
+
+result_t
+fixpoint_column_sub( fixpoint_column_t *result, const fixpoint_column_t *left,
+                     const fixpoint_column_t *right, result_t *flags ) {
+  assert(result->size == left->size && result->size == right->size);
+  return column_get_kernels()->add_sub(result, left, right, flags, true);
+}
+
+result_t
+fixpoint_column_mul( fixpoint_column_t *result, const fixpoint_column_t *left,
+                     const fixpoint_column_t *right, result_t *flags ) {
+  assert(result->size == left->size && result->size == right->size);
+  return column_get_kernels()->mul(result, left, right, flags);
+}
+
+void
+fixpoint_column_compare( int *result, const fixpoint_column_t *left,
+                         const fixpoint_column_t *right ) {
+  assert(left->size == right->size);
+  column_get_kernels()->compare(result, left, right);
+}
@@ -0,0 +1,120 @@
+#ifndef FIXPOINT_COLUMN_H
+#define FIXPOINT_COLUMN_H
+
+#include "fixpoint.h"
+
+////////////////////////////////////////////////////////////////////////
+// Data types
+////////////////////////////////////////////////////////////////////////
+
+//! Structure-of-arrays container for a column of fixpoint_t values.
+//! Element i has whole part whole[i], fractional part frac[i], and
+//! is negative if bit (i % 64) of sign[i / 64] is set. Compared to
+//! an array of fixpoint_t this avoids the padding after the sign,
+//! and lets the arithmetic kernels use SIMD instructions.
+typedef struct {
+  uint32_t *whole;  //!< whole parts
+  uint32_t *frac;   //!< fractional parts
+  uint64_t *sign;   //!< sign bitmap, one bit per element
+  size_t size;      //!< number of elements
+} fixpoint_column_t;
+
+////////////////////////////////////////////////////////////////////////
+// Column API functions
+//
+// All columns passed to one arithmetic function must have the same
+// size. The result column may be the same as one of the inputs.
+// The arithmetic functions use the instruction set selected by
+// fixpoint_get_isa/fixpoint_set_isa.
+////////////////////////////////////////////////////////////////////////
+
+//! Allocate storage for a column of n values, all initialized to 0.
+//! The whole and frac arrays are 32 byte aligned.
+//!
+//! @param col pointer to the fixpoint_column_t to initialize
+//! @param n number of elements
+//! @return true if successful, false if memory could not be allocated
+bool
+fixpoint_column_init( fixpoint_column_t *col, size_t n );
+
+//! Free the storage of a column initialized by fixpoint_column_init.
+//!
+//! @param col pointer to the fixpoint_column_t to clean up
+void
+fixpoint_column_cleanup( fixpoint_column_t *col );
+
+//! Get element i of a column.
+//!
+//! @param val pointer to the fixpoint_t where the element is stored
+//! @param col pointer to the column
+//! @param i index of the element (must be less than col->size)
+void
+fixpoint_column_get( fixpoint_t *val, const fixpoint_column_t *col, size_t i );
+
+//! Set element i of a column.
+//!
+//! @param col pointer to the column
+//! @param i index of the element (must be less than col->size)
+//! @param val pointer to the value to store
+void
+fixpoint_column_set( fixpoint_column_t *col, size_t i, const fixpoint_t *val );
+
+//! Copy an array of col->size fixpoint_t values into a column.
+//!
+//! @param col pointer to the column
+//! @param vals array of col->size values
+void
+fixpoint_column_from_array( fixpoint_column_t *col, const fixpoint_t *vals );
+
+//! Copy the values in a column to an array of col->size fixpoint_t values.
+//!
+//! @param vals array of col->size values where the elements are stored
+//! @param col pointer to the column
+void
+fixpoint_column_to_array( fixpoint_t *vals, const fixpoint_column_t *col );
+
+//! Element-wise fixpoint_add of two columns. Element i of result,
+//! and flags[i], are identical to what fixpoint_add computes.
+//!
+//! @param result pointer to the column where the sums are stored
+//! @param left pointer to the column of left values
+//! @param right pointer to the column of right values
+//! @param flags array of per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_column_add( fixpoint_column_t *result, const fixpoint_column_t *left,
+                     const fixpoint_column_t *right, result_t *flags );
+
+//! Element-wise fixpoint_sub of two columns (see fixpoint_column_add).
+//!
+//! @param result pointer to the column where the differences are stored
+//! @param left pointer to the column of minuends
+//! @param right pointer to the column of subtrahends
+//! @param flags array of per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_column_sub( fixpoint_column_t *result, const fixpoint_column_t *left,
+                     const fixpoint_column_t *right, result_t *flags );
+
+//! Element-wise fixpoint_mul of two columns (see fixpoint_column_add).
+//!
+//! @param result pointer to the column where the products are stored
+//! @param left pointer to the column of left values
+//! @param right pointer to the column of right values
+//! @param flags array of per-element result_t values (may be NULL)
+//! @return the bitwise OR of all the per-element results
+result_t
+fixpoint_column_mul( fixpoint_column_t *result, const fixpoint_column_t *left,
+                     const fixpoint_column_t *right, result_t *flags );
+
+//! Element-wise fixpoint_compare of two columns.
+//!
+//! @param result array of left->size ints where the comparison
+//!               results (-1, 0, or 1) are stored
+//! @param left pointer to the column of left values
+//! @param right pointer to the column of right values
+void
+fixpoint_column_compare( int *result, const fixpoint_column_t *left,
+                         const fixpoint_column_t *right );
+
+#endif // FIXPOINT_COLUMN_H
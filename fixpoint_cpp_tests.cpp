@@ -0,0 +1,237 @@
+#include <cstdlib>
+#include <cstring>
+#include "tctest.h"
+#include "fixpoint.h"
+#include "fixpoint.hpp"
+
+using fixpoint::Fixpoint;
+
+// Test fixture: random values to check the C++ wrapper against
+// the C functions with
+#define NUM_VALS 2000
+
+typedef struct {
+  Fixpoint vals[NUM_VALS];
+} TestObjs;
+
+// Functions to create and destroy the text fixture
+TestObjs *setup( void );
+void cleanup( TestObjs *objs );
+
+// Macro to check that a Fixpoint and a fixpoint_t are identical
+#define TEST_SAME( fp, val ) \
+do { \
+  ASSERT( (fp).whole() == (val).whole ); \
+  ASSERT( (fp).frac() == (val).frac ); \
+  ASSERT( (fp).is_negative() == (val).negative ); \
+} while ( 0 )
+
+// Seeds for test_rand
+#define TEST_RAND_SEED 0x9E3779B97F4A7C15ULL
+#define TEST_RAND_SEED2 0x2545F4914F6CDD1DULL
+
+// Pseudo-random values for the randomized tests (xorshift64): advances
+// *state and returns the new value
+static uint64_t test_rand( uint64_t *state ) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
+// Constants are folded at compile time
+constexpr Fixpoint one_and_half( 1, 0x80000000 );
+constexpr Fixpoint neg_three_eighths( 0, 0x60000000, true );
+static_assert( one_and_half * neg_three_eighths == Fixpoint( 0, 0x90000000, true ), "mul" );
+static_assert( one_and_half + neg_three_eighths == Fixpoint( 1, 0x20000000 ), "add" );
+static_assert( neg_three_eighths - one_and_half == Fixpoint( 1, 0xE0000000, true ), "sub" );
+static_assert( -Fixpoint() == Fixpoint() && !( -Fixpoint() ).is_negative(), "negate 0" );
+static_assert( neg_three_eighths < Fixpoint() && Fixpoint() <= one_and_half, "compare" );
+static_assert( [] {
+  char buf[FIXPOINT_STR_MAX_SIZE] = { };
+  auto res = fixpoint::to_chars( buf, buf + sizeof( buf ), neg_three_eighths, 10 );
+  return res.ptr - buf == 6 && buf[0] == '-' && buf[3] == '3' && buf[5] == '5';
+}(), "to_chars" );
+static_assert( [] {
+  Fixpoint val;
+  const char str[] = "-0.375";
+  auto res = fixpoint::from_chars( str, str + 6, val, 10 );
+  return res.ec == std::errc() && res.ptr == str + 6 && val == neg_three_eighths;
+}(), "from_chars" );
+
+int main( int argc, char **argv ) {
+  if ( argc > 1 )
+    tctest_testname_to_execute = argv[1];
+
+  TEST_INIT();
+
+  TEST_RUN_ALL();
+
+  TEST_FINI();
+}
+
+TestObjs *setup( void ) {
+  TestObjs *objs = new TestObjs;
+
+  //random values of all sizes, including 0, max and repeated values
+  uint64_t rng = TEST_RAND_SEED;
+  for ( int i = 0; i < NUM_VALS; i++ ) {
+    test_rand( &rng );
+    objs->vals[i] = Fixpoint( (uint32_t)( ( rng >> 32 ) >> ( i % 33 ) ), (uint32_t)( ( rng & 0xFFFFFFFF ) >> ( ( i / 2 ) % 33 ) ), rng & 1 );
+  }
+  objs->vals[0] = Fixpoint();
+  objs->vals[1] = Fixpoint( 0, 0, true );
+  objs->vals[2] = Fixpoint( 0xFFFFFFFF, 0xFFFFFFFF );
+  objs->vals[3] = Fixpoint( 0xFFFFFFFF, 0xFFFFFFFF, true );
+  objs->vals[4] = objs->vals[5];
+
+  return objs;
+}
+
+void cleanup( TestObjs *objs ) {
+  delete objs;
+}
+
+TEST_CASE( test_arithmetic ) {
+  for ( int i = 0; i < NUM_VALS; i++ ) {
+    for ( int j = i % 16; j < NUM_VALS; j += 16 ) {
+      const Fixpoint &a = objs->vals[i], &b = objs->vals[j];
+      fixpoint_t expected;
+      Fixpoint result;
+
+      ASSERT( Fixpoint::add( result, a, b ) == fixpoint_add( &expected, &a.c_val(), &b.c_val() ) );
+      TEST_SAME( result, expected );
+      TEST_SAME( a + b, expected );
+      ASSERT( Fixpoint::sub( result, a, b ) == fixpoint_sub( &expected, &a.c_val(), &b.c_val() ) );
+      TEST_SAME( result, expected );
+      TEST_SAME( a - b, expected );
+      ASSERT( Fixpoint::mul( result, a, b ) == fixpoint_mul( &expected, &a.c_val(), &b.c_val() ) );
+      TEST_SAME( result, expected );
+      TEST_SAME( a * b, expected );
+
+      int cmp = fixpoint_compare( &a.c_val(), &b.c_val() );
+      ASSERT( Fixpoint::compare( a, b ) == cmp );
+      ASSERT( ( a == b ) == ( cmp == 0 ) );
+      ASSERT( ( a < b ) == ( cmp < 0 ) );
+      ASSERT( ( a >= b ) == ( cmp >= 0 ) );
+    }
+
+    fixpoint_t expected = objs->vals[i].c_val();
+    fixpoint_negate( &expected );
+    TEST_SAME( -objs->vals[i], expected );
+  }
+}
+
+TEST_CASE( test_to_chars ) {
+  for ( int i = 0; i < NUM_VALS; i++ ) {
+    const Fixpoint &a = objs->vals[i];
+    fixpoint_str_t expected;
+    char buf[FIXPOINT_STR_MAX_SIZE];
+
+    fixpoint_format_hex( &expected, &a.c_val() );
+    auto res = fixpoint::to_chars( buf, buf + sizeof( buf ), a );
+    ASSERT( res.ec == std::errc() );
+    ASSERT( res.ptr - buf == (long) strlen( expected.str ) );
+    ASSERT( memcmp( buf, expected.str, res.ptr - buf ) == 0 );
+
+    fixpoint_format_dec( &expected, &a.c_val() );
+    res = fixpoint::to_chars( buf, buf + sizeof( buf ), a, 10 );
+    ASSERT( res.ec == std::errc() );
+    ASSERT( res.ptr - buf == (long) strlen( expected.str ) );
+    ASSERT( memcmp( buf, expected.str, res.ptr - buf ) == 0 );
+
+    //too small a buffer
+    size_t len = strlen( expected.str );
+    res = fixpoint::to_chars( buf, buf + len - 1, a, 10 );
+    ASSERT( res.ec == std::errc::value_too_large );
+    ASSERT( res.ptr == buf + len - 1 );
+  }
+}
+
+TEST_CASE( test_from_chars ) {
+  //strings the C parsers accept (formatted values, with more or fewer
+  //digits) and reject, which the wrapper must parse identically
+  //(accepting a string means consuming all of it)
+  const char *strs[] = {
+    "0.0", "-0.0", "1.8", "-ABCDEF01.23456789", "fedcba98.7", "000000001.0", "123456789.0",
+    "1.123456789", "1.", ".5", "-", "", "1.5x", "4294967296.0", "0.00000000011641532182693481445312",
+    "0.000000000116415321826934814453125", "0.000000000349245965480804443359375",
+    "0.0000000003492459654808044433593751", "00000000000.5", "12345678901.5", "0.1e5",
+  };
+  for ( const char *str : strs ) {
+    for ( int base = 10; base <= 16; base += 6 ) {
+      fixpoint_str_t s;
+      strcpy( s.str, str );
+      fixpoint_t expected;
+      bool ok = base == 10 ? fixpoint_parse_dec( &expected, &s ) : fixpoint_parse_hex( &expected, &s );
+
+      Fixpoint val;
+      const char *end = str + strlen( str );
+      auto res = fixpoint::from_chars( str, end, val, base );
+      ASSERT( ok == ( res.ec == std::errc() && res.ptr == end ) );
+      if ( ok ) {
+        TEST_SAME( val, expected );
+      }
+    }
+  }
+
+  //decimal strings just below the tie between the largest value and
+  //2^32 round down to the largest value (they are too long for a
+  //fixpoint_str_t, so only the wrapper can parse them)
+  const char *long_strs[] = {
+    "4294967295.99999999988358467817306518554687", "4294967295.9999999998835846781730651855468749",
+  };
+  for ( const char *str : long_strs ) {
+    ASSERT( strlen( str ) >= FIXPOINT_STR_MAX_SIZE );
+    Fixpoint val;
+    const char *end = str + strlen( str );
+    auto res = fixpoint::from_chars( str, end, val, 10 );
+    ASSERT( res.ec == std::errc() && res.ptr == end );
+    ASSERT( val == Fixpoint( 0xFFFFFFFF, 0xFFFFFFFF ) );
+  }
+
+  //random decimal strings with up to 30 frac digits (many of them
+  //0s, to get close to ties)
+  uint64_t rng = TEST_RAND_SEED2;
+  for ( int i = 0; i < 100000; i++ ) {
+    fixpoint_str_t s;
+    int len = 0;
+    test_rand( &rng );
+    int whole_digits = 1 + rng % 10, frac_digits = 1 + ( rng >> 8 ) % 30;
+    for ( int j = 0; j < whole_digits + frac_digits; j++ ) {
+      test_rand( &rng );
+      if ( j == whole_digits )
+        s.str[len++] = '.';
+      s.str[len++] = ( rng & 3 ) ? '0' : (char)( '0' + ( rng >> 32 ) % 10 );
+    }
+    s.str[len] = '\0';
+
+    fixpoint_t expected;
+    bool ok = fixpoint_parse_dec( &expected, &s );
+    Fixpoint val;
+    auto res = fixpoint::from_chars( s.str, s.str + len, val, 10 );
+    ASSERT( ok == ( res.ec == std::errc() && res.ptr == s.str + len ) );
+    if ( ok ) {
+      TEST_SAME( val, expected );
+    }
+  }
+
+  //formatted values parse back to the same value in both
+  for ( int i = 0; i < NUM_VALS; i++ ) {
+    const Fixpoint &a = objs->vals[i];
+    for ( int base = 10; base <= 16; base += 6 ) {
+      fixpoint_str_t s;
+      if ( base == 10 )
+        fixpoint_format_dec( &s, &a.c_val() );
+      else
+        fixpoint_format_hex( &s, &a.c_val() );
+      Fixpoint val;
+      const char *end = s.str + strlen( s.str );
+      auto res = fixpoint::from_chars( s.str, end, val, base );
+      ASSERT( res.ec == std::errc() && res.ptr == end );
+      TEST_SAME( val, a.c_val() );
+    }
+  }
+}
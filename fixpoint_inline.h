@@ -0,0 +1,178 @@
+#ifndef FIXPOINT_INLINE_H
+#define FIXPOINT_INLINE_H
+
+#include "fixpoint.h"
+
+////////////////////////////////////////////////////////////////////////
+// Inline fast path
+//
+// static inline versions of the accessors and of add, sub, mul and
+// compare, so that calls from other translation units can be inlined
+// without link-time optimization. The out-of-line functions in
+// fixpoint.c are implemented with these, so both compute identical
+// results, and the out-of-line symbols remain available.
+//
+// Including this header makes the fixpoint_inline_* functions
+// available. Defining FIXPOINT_INLINE before including fixpoint.h
+// (or this header) also makes calls to fixpoint_init,
+// fixpoint_get_whole, fixpoint_get_frac, fixpoint_is_negative,
+// fixpoint_negate, fixpoint_add, fixpoint_sub, fixpoint_mul and
+// fixpoint_compare use the inline versions.
+////////////////////////////////////////////////////////////////////////
+
+// Combine the whole and fractional parts of a fixpoint_t value into
+// a single 64 bit magnitude
+static inline uint64_t
+fixpoint_inline_magnitude( const fixpoint_t *val ) {
+  return ((uint64_t)val->whole << 32) | val->frac;
+}
+
+// Store a 64 bit magnitude and sign in a fixpoint_t
+static inline void
+fixpoint_inline_store( fixpoint_t *result, uint64_t mag, bool negative ) {
+  result->whole = (uint32_t)(mag >> 32);
+  result->frac = (uint32_t)mag;
+  result->negative = negative;
+}
+
+// Shared core of fixpoint_add and fixpoint_sub: computes left + right
+// (or left - right if is_sub is true) on the 64 bit magnitudes.
+// Both the sum and the difference of the magnitudes are computed
+// unconditionally (with carry/borrow from the compiler builtins) and
+// the right one is selected afterwards, so that mixed-sign inputs
+// do not cause hard to predict branches.
+static inline result_t
+fixpoint_inline_add_sub( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right,
+                         bool is_sub ) {
+  uint64_t left_mag = fixpoint_inline_magnitude(left);
+  uint64_t right_mag = fixpoint_inline_magnitude(right);
+  bool same_sign = left->negative == (right->negative ^ is_sub);
+
+  //magnitudes add when the (effective) signs agree
+  uint64_t sum;
+  bool carry = __builtin_add_overflow(left_mag, right_mag, &sum);
+
+  //otherwise they subtract, and the sign flips if right was bigger
+  uint64_t diff;
+  bool borrow = __builtin_sub_overflow(left_mag, right_mag, &diff);
+  uint64_t borrow_mask = -(uint64_t)borrow;
+  diff = (diff ^ borrow_mask) - borrow_mask;
+
+  uint64_t mag = same_sign ? sum : diff;
+  bool overflow = same_sign & carry;
+  //an overflowed result keeps its sign even if it wrapped to 0,
+  //otherwise 0 is never negative
+  bool negative = (left->negative ^ (!same_sign & borrow)) & (mag != 0 || overflow);
+
+  fixpoint_inline_store(result, mag, negative);
+  return overflow ? RESULT_OVERFLOW : RESULT_OK;
+}
+
+//! Inline version of fixpoint_init.
+static inline void
+fixpoint_inline_init( fixpoint_t *val, uint32_t whole, uint32_t frac, bool negative ) {
+  val->whole = whole;
+  val->frac = frac;
+  val->negative = negative;
+}
+
+//! Inline version of fixpoint_get_whole.
+static inline uint32_t
+fixpoint_inline_get_whole( const fixpoint_t *val ) {
+  return val->whole;
+}
+
+//! Inline version of fixpoint_get_frac.
+static inline uint32_t
+fixpoint_inline_get_frac( const fixpoint_t *val ) {
+  return val->frac;
+}
+
+//! Inline version of fixpoint_is_negative.
+static inline bool
+fixpoint_inline_is_negative( const fixpoint_t *val ) {
+  return val->negative;
+}
+
+//! Inline version of fixpoint_negate.
+static inline void
+fixpoint_inline_negate( fixpoint_t *val ) {
+  //0 is never negative
+  val->negative = !val->negative & ((val->whole | val->frac) != 0);
+}
+
+//! Inline version of fixpoint_add.
+static inline result_t
+fixpoint_inline_add( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return fixpoint_inline_add_sub(result, left, right, false);
+}
+
+//! Inline version of fixpoint_sub.
+static inline result_t
+fixpoint_inline_sub( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  return fixpoint_inline_add_sub(result, left, right, true);
+}
+
+//! Inline version of fixpoint_mul.
+static inline result_t
+fixpoint_inline_mul( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  //multiplies both parts first number by both parts second and stores in 64 bit
+  uint64_t p0 = (uint64_t)left->frac * right->frac;
+  uint64_t p1 = (uint64_t)left->frac * right->whole;
+  uint64_t p2 = (uint64_t)left->whole * right->frac;
+  uint64_t p3 = (uint64_t)left->whole * right->whole;
+
+  //handles adding together the parts and truncating the bits
+  uint64_t middle_sum = p1 + p2 + (p0 >> 32);
+  result->whole = (uint32_t)p3 + (uint32_t)(middle_sum >> 32);
+
+  result->frac = (uint32_t)middle_sum;
+  //sign handling
+  result->negative = left->negative ^ right->negative;
+
+  //check overflow/underflow
+  result_t ret = RESULT_OK;
+
+  //overflow
+  uint64_t final_whole = (uint64_t)(uint32_t)p3 + (uint32_t)(middle_sum >> 32);
+  if ((p3 >> 32) != 0 || (final_whole >> 32) != 0) {
+    ret |= RESULT_OVERFLOW;
+  }
+
+  //underflow
+  if ((p0 & 0xFFFFFFFF) != 0) {
+    ret |= RESULT_UNDERFLOW;
+  }
+  if (ret == RESULT_OK && result->whole == 0 && result->frac == 0) {
+    result->negative = false;
+  }
+
+  return ret;
+}
+
+//! Inline version of fixpoint_compare (doesn't branch on the signs).
+static inline int
+fixpoint_inline_compare( const fixpoint_t *left, const fixpoint_t *right ) {
+  uint64_t left_mag = fixpoint_inline_magnitude(left);
+  uint64_t right_mag = fixpoint_inline_magnitude(right);
+  int mag_cmp = (left_mag > right_mag) - (left_mag < right_mag);
+  //if differing signs the negative is smallest, if both
+  //negative the magnitude comparison is reversed
+  int sign_cmp = (int)right->negative - (int)left->negative;
+  int same_sign_cmp = left->negative ? -mag_cmp : mag_cmp;
+  return sign_cmp ? sign_cmp : same_sign_cmp;
+}
+
+#ifdef FIXPOINT_INLINE
+#define fixpoint_init fixpoint_inline_init
+#define fixpoint_get_whole fixpoint_inline_get_whole
+#define fixpoint_get_frac fixpoint_inline_get_frac
+#define fixpoint_is_negative fixpoint_inline_is_negative
+#define fixpoint_negate fixpoint_inline_negate
+#define fixpoint_add fixpoint_inline_add
+#define fixpoint_sub fixpoint_inline_sub
+#define fixpoint_mul fixpoint_inline_mul
+#define fixpoint_compare fixpoint_inline_compare
+#endif
+
+#endif // FIXPOINT_INLINE_H
@@ -0,0 +1,211 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fixpoint_io.h"
+
+////////////////////////////////////////////////////////////////////////
+// Helper functions
+////////////////////////////////////////////////////////////////////////
+
+// Helper function to map a whole file read-only, with the given
+// madvise advice. An empty file is mapped as a NULL buffer with
+// length 0.
+static bool
+map_file( const char *filename, const char **buf, size_t *len, int advice ) {
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) < 0) {
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return false;
+  }
+
+  *len = (size_t)st.st_size;
+  *buf = NULL;
+  if (*len > 0) {
+    void *p = mmap(NULL, *len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (p == MAP_FAILED) {
+      int saved = errno;
+      close(fd);
+      errno = saved;
+      return false;
+    }
+    madvise(p, *len, advice);
+    *buf = p;
+  }
+
+  //the mapping stays valid after the descriptor is closed
+  close(fd);
+  return true;
+}
+
+static void
+unmap_file( const char *buf, size_t len ) {
+  if (len > 0) {
+    munmap((void *)buf, len);
+  }
+}
+
+// Value of the endian field of a binary file header written on this
+// machine, and as read on a machine of the other byte order
+#define BINARY_ENDIAN 0x01020304u
+#define BINARY_ENDIAN_SWAPPED 0x04030201u
+
+// Number of sign words following the magnitudes of count values
+// (as allocated by fixpoint_packed_init)
+static uint64_t
+binary_sign_words( uint64_t count ) {
+  return count / 64 + 1;
+}
+
+// Checksum of an array of 64 bit words (FNV-1a on words instead of
+// bytes), continuing from the checksum h of the preceding words
+static uint64_t
+binary_checksum( const uint64_t *words, size_t n, uint64_t h ) {
+  for (size_t i = 0; i < n; i++) {
+    h = (h ^ words[i]) * 0x100000001B3ULL;
+  }
+  return h;
+}
+
+// Checksum of the data of a packed array (the magnitudes, then the
+// sign words), starting from the FNV-1a offset basis
+static uint64_t
+binary_data_checksum( const fixpoint_packed_t *packed ) {
+  uint64_t h = binary_checksum(packed->mag, packed->size, 0xCBF29CE484222325ULL);
+  return binary_checksum(packed->sign, binary_sign_words(packed->size), h);
+}
+
+// Helper function to write a whole buffer to a file descriptor,
+// retrying after short writes and interrupted calls
+static bool
+write_all( int fd, const void *buf, size_t len ) {
+  const char *p = buf;
+  while (len > 0) {
+    ssize_t n = write(fd, p, len);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    p += n;
+    len -= (size_t)n;
+  }
+  return true;
+}
+
+////////////////////////////////////////////////////////////////////////
+// File API functions
+////////////////////////////////////////////////////////////////////////
+
+fixpoint_io_status_t
+fixpoint_parse_hex_file( const char *filename, fixpoint_t *vals, size_t max_vals,
+                         size_t *count, size_t *error_offset ) {
+  const char *buf;
+  size_t len;
+  *count = 0;
+  //the mapping is read front to back exactly once
+  if (!map_file(filename, &buf, &len, MADV_SEQUENTIAL)) {
+    return FIXPOINT_IO_ERROR;
+  }
+
+  size_t end_offset;
+  *count = fixpoint_parse_hex_buffer(vals, max_vals, buf, len, &end_offset);
+  unmap_file(buf, len);
+
+  if (end_offset == len) {
+    return FIXPOINT_IO_OK;
+  }
+  *error_offset = end_offset;
+  return *count < max_vals ? FIXPOINT_IO_MALFORMED : FIXPOINT_IO_FULL;
+}
+
+fixpoint_io_status_t
+fixpoint_write_binary_file( const char *filename, const fixpoint_packed_t *packed, bool checksum ) {
+  uint64_t nsign = binary_sign_words(packed->size);
+  fixpoint_binary_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, "FIXPOINT", sizeof(header.magic));
+  header.version = FIXPOINT_BINARY_VERSION;
+  header.endian = BINARY_ENDIAN;
+  header.count = packed->size;
+  if (checksum) {
+    header.flags = FIXPOINT_BINARY_CHECKSUM;
+    header.checksum = binary_data_checksum(packed);
+  }
+
+  int fd = open(filename, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+  if (fd < 0) {
+    return FIXPOINT_IO_ERROR;
+  }
+  if (!write_all(fd, &header, sizeof(header))
+      || !write_all(fd, packed->mag, packed->size * sizeof(uint64_t))
+      || !write_all(fd, packed->sign, nsign * sizeof(uint64_t))) {
+    int saved = errno;
+    close(fd);
+    errno = saved;
+    return FIXPOINT_IO_ERROR;
+  }
+  return close(fd) == 0 ? FIXPOINT_IO_OK : FIXPOINT_IO_ERROR;
+}
+
+fixpoint_io_status_t
+fixpoint_map_binary_file( fixpoint_binary_file_t *file, const char *filename, bool verify ) {
+  const char *buf;
+  size_t len;
+  memset(file, 0, sizeof(*file));
+  //start reading the whole file in ahead of the first accesses
+  if (!map_file(filename, &buf, &len, MADV_WILLNEED)) {
+    return FIXPOINT_IO_ERROR;
+  }
+
+  //check the header (the mapping is page aligned, so the header and
+  //the arrays after it are aligned)
+  fixpoint_io_status_t status = FIXPOINT_IO_OK;
+  const fixpoint_binary_header_t *header = (const fixpoint_binary_header_t *)buf;
+  size_t data_len = len - sizeof(*header);
+  if (len < sizeof(*header) || memcmp(header->magic, "FIXPOINT", sizeof(header->magic)) != 0) {
+    status = FIXPOINT_IO_MALFORMED;
+  } else if (header->endian != BINARY_ENDIAN) {
+    status = header->endian == BINARY_ENDIAN_SWAPPED ? FIXPOINT_IO_UNSUPPORTED : FIXPOINT_IO_MALFORMED;
+  } else if (header->version != FIXPOINT_BINARY_VERSION
+             || (header->flags & ~(uint32_t)FIXPOINT_BINARY_CHECKSUM) != 0) {
+    status = FIXPOINT_IO_UNSUPPORTED;
+  } else if (header->count >= data_len / sizeof(uint64_t)
+             || (header->count + binary_sign_words(header->count)) * sizeof(uint64_t) != data_len) {
+    status = FIXPOINT_IO_MALFORMED;
+  }
+  if (status != FIXPOINT_IO_OK) {
+    unmap_file(buf, len);
+    return status;
+  }
+
+  file->map = buf;
+  file->map_len = len;
+  file->packed.size = header->count;
+  file->packed.mag = (uint64_t *)(buf + sizeof(*header));
+  file->packed.sign = file->packed.mag + header->count;
+
+  if (verify) {
+    bool has_checksum = (header->flags & FIXPOINT_BINARY_CHECKSUM) != 0;
+    if ((has_checksum && header->checksum != binary_data_checksum(&file->packed))
+        || !fixpoint_packed_validate(&file->packed, NULL)) {
+      fixpoint_unmap_binary_file(file);
+      return FIXPOINT_IO_MALFORMED;
+    }
+  }
+  return FIXPOINT_IO_OK;
+}
+
+void
+fixpoint_unmap_binary_file( fixpoint_binary_file_t *file ) {
+  unmap_file(file->map, file->map_len);
+  memset(file, 0, sizeof(*file));
+}
@@ -0,0 +1,106 @@
+#ifndef FIXPOINT_IO_H
+#define FIXPOINT_IO_H
+
+#include "fixpoint.h"
+#include "fixpoint_packed.h"
+
+////////////////////////////////////////////////////////////////////////
+// Data types
+////////////////////////////////////////////////////////////////////////
+
+//! Outcome of a file operation.
+typedef enum {
+  FIXPOINT_IO_OK,          //!< success
+  FIXPOINT_IO_ERROR,       //!< a system call failed (errno is set)
+  FIXPOINT_IO_MALFORMED,   //!< the file contents are not well-formed
+  FIXPOINT_IO_FULL,        //!< the file has more values than fit in the array
+  FIXPOINT_IO_UNSUPPORTED, //!< unknown file version or byte order
+} fixpoint_io_status_t;
+
+//! Version of the binary file format written by
+//! fixpoint_write_binary_file.
+#define FIXPOINT_BINARY_VERSION 1
+
+//! Flag in the header of a binary file: the header has a checksum of
+//! the data.
+#define FIXPOINT_BINARY_CHECKSUM 1
+
+//! Header of a binary file of fixpoint_t values. All fields are in
+//! the byte order of the machine that wrote the file (given by the
+//! endian field). The header is followed by the data of a
+//! fixpoint_packed_t of count values: the count 64 bit magnitudes,
+//! then the count / 64 + 1 64 bit sign words.
+typedef struct {
+  char magic[8];      //!< "FIXPOINT"
+  uint32_t version;   //!< FIXPOINT_BINARY_VERSION
+  uint32_t endian;    //!< 0x01020304
+  uint64_t count;     //!< number of values
+  uint32_t flags;     //!< FIXPOINT_BINARY_CHECKSUM or 0
+  uint32_t reserved;  //!< 0
+  uint64_t checksum;  //!< checksum of the data, if flags has
+                      //!< FIXPOINT_BINARY_CHECKSUM
+  uint64_t pad[3];    //!< 0 (the data starts 64 bytes into the file)
+} fixpoint_binary_header_t;
+
+//! A binary file mapped read-only by fixpoint_map_binary_file.
+typedef struct {
+  fixpoint_packed_t packed; //!< the values; the arrays point into the
+                            //!< read-only mapping, so must not be modified
+  const char *map;          //!< start of the mapping
+  size_t map_len;           //!< length of the mapping
+} fixpoint_binary_file_t;
+
+////////////////////////////////////////////////////////////////////////
+// File API functions
+////////////////////////////////////////////////////////////////////////
+
+//! Parse a file of newline-delimited formatted base-16 values (see
+//! fixpoint_parse_hex_buffer). The file is memory-mapped and parsed
+//! in place, without copying each line.
+//!
+//! @param filename name of the file to parse
+//! @param vals array where the parsed values are stored
+//! @param max_vals number of elements in vals
+//! @param count set to the number of values stored in vals
+//! @param error_offset if FIXPOINT_IO_MALFORMED is returned, set to the
+//!                     byte offset of the first malformed line (if
+//!                     FIXPOINT_IO_FULL is returned, set to the offset
+//!                     of the first line that was not parsed)
+//! @return FIXPOINT_IO_OK, FIXPOINT_IO_ERROR, FIXPOINT_IO_MALFORMED,
+//!         or FIXPOINT_IO_FULL
+fixpoint_io_status_t
+fixpoint_parse_hex_file( const char *filename, fixpoint_t *vals, size_t max_vals,
+                         size_t *count, size_t *error_offset );
+
+//! Write a packed array of values to a binary file (see
+//! fixpoint_binary_header_t), replacing the file if it exists.
+//!
+//! @param filename name of the file to write
+//! @param packed pointer to the packed array to write
+//! @param checksum true to store a checksum of the data in the header
+//! @return FIXPOINT_IO_OK or FIXPOINT_IO_ERROR
+fixpoint_io_status_t
+fixpoint_write_binary_file( const char *filename, const fixpoint_packed_t *packed, bool checksum );
+
+//! Map a binary file written by fixpoint_write_binary_file read-only,
+//! without copying or converting the values: file->packed points into
+//! the mapping, so pages are only read as the values are used. The
+//! header is always checked. If verify is true, the checksum (if the
+//! file has one) and the signs (see fixpoint_packed_validate) are
+//! checked too, which reads the whole file.
+//!
+//! @param file pointer to the fixpoint_binary_file_t to initialize
+//! @param filename name of the file to map
+//! @param verify true to check the data as well as the header
+//! @return FIXPOINT_IO_OK, FIXPOINT_IO_ERROR, FIXPOINT_IO_MALFORMED,
+//!         or FIXPOINT_IO_UNSUPPORTED
+fixpoint_io_status_t
+fixpoint_map_binary_file( fixpoint_binary_file_t *file, const char *filename, bool verify );
+
+//! Unmap a binary file mapped by fixpoint_map_binary_file.
+//!
+//! @param file pointer to the fixpoint_binary_file_t to clean up
+void
+fixpoint_unmap_binary_file( fixpoint_binary_file_t *file );
+
+#endif // FIXPOINT_IO_H
@@ -0,0 +1,119 @@
+#include <stdlib.h>
+#include <string.h>
+#include "fixpoint_packed.h"
+
+////////////////////////////////////////////////////////////////////////
+// Helper functions
+////////////////////////////////////////////////////////////////////////
+
+// Alignment of the mag array (two magnitudes per SSE register)
+#define PACKED_ALIGN 16
+
+// Number of elements in sign word w of a packed array of size n
+static size_t
+packed_word_count( size_t n, size_t w ) {
+  return n - w * 64 < 64 ? n - w * 64 : 64;
+}
+
+////////////////////////////////////////////////////////////////////////
+// Packed API functions
+////////////////////////////////////////////////////////////////////////
+
+bool
+fixpoint_packed_init( fixpoint_packed_t *packed, size_t n ) {
+  //aligned_alloc requires a size that is a multiple of the alignment
+  size_t size = (n * sizeof(uint64_t) + PACKED_ALIGN - 1) / PACKED_ALIGN * PACKED_ALIGN;
+  if (size == 0) size = PACKED_ALIGN;
+  packed->mag = aligned_alloc(PACKED_ALIGN, size);
+  if (packed->mag) memset(packed->mag, 0, size);
+  packed->sign = calloc(n / 64 + 1, sizeof(uint64_t));
+  packed->size = n;
+  if (!packed->mag || !packed->sign) {
+    fixpoint_packed_cleanup(packed);
+    return false;
+  }
+  return true;
+}
+
+void
+fixpoint_packed_cleanup( fixpoint_packed_t *packed ) {
+  free(packed->mag);
+  free(packed->sign);
+  packed->mag = NULL;
+  packed->sign = NULL;
+  packed->size = 0;
+}
+
+void
+fixpoint_packed_get( fixpoint_t *val, const fixpoint_packed_t *packed, size_t i ) {
+  uint64_t mag = packed->mag[i];
+  val->whole = (uint32_t)(mag >> 32);
+  val->frac = (uint32_t)mag;
+  val->negative = ((packed->sign[i / 64] >> (i % 64)) & 1) & (mag != 0);
+}
+
+void
+fixpoint_packed_set( fixpoint_packed_t *packed, size_t i, const fixpoint_t *val ) {
+  uint64_t mag = ((uint64_t)val->whole << 32) | val->frac;
+  uint64_t bit = (uint64_t)1 << (i % 64);
+  uint64_t negative = -(uint64_t)(val->negative & (mag != 0));
+  packed->mag[i] = mag;
+  packed->sign[i / 64] = (packed->sign[i / 64] & ~bit) | (bit & negative);
+}
+
+bool
+fixpoint_pack( fixpoint_packed_t *packed, const fixpoint_t *vals ) {
+  bool negative_zero = false;
+  //build the sign bitmap a word at a time, without branching on
+  //the signs
+  for (size_t w = 0; w * 64 < packed->size; w++) {
+    const fixpoint_t *v = vals + w * 64;
+    uint64_t *mag = packed->mag + w * 64;
+    size_t count = packed_word_count(packed->size, w);
+    uint64_t bits = 0;
+    for (size_t k = 0; k < count; k++) {
+      uint64_t m = ((uint64_t)v[k].whole << 32) | v[k].frac;
+      mag[k] = m;
+      bits |= (uint64_t)(v[k].negative & (m != 0)) << k;
+      negative_zero |= v[k].negative & (m == 0);
+    }
+    packed->sign[w] = bits;
+  }
+  return !negative_zero;
+}
+
+void
+fixpoint_unpack( fixpoint_t *vals, const fixpoint_packed_t *packed ) {
+  for (size_t w = 0; w * 64 < packed->size; w++) {
+    fixpoint_t *v = vals + w * 64;
+    const uint64_t *mag = packed->mag + w * 64;
+    size_t count = packed_word_count(packed->size, w);
+    uint64_t bits = packed->sign[w];
+    for (size_t k = 0; k < count; k++) {
+      uint64_t m = mag[k];
+      v[k].whole = (uint32_t)(m >> 32);
+      v[k].frac = (uint32_t)m;
+      v[k].negative = ((bits >> k) & 1) & (m != 0);
+    }
+  }
+}
+
+bool
+fixpoint_packed_validate( const fixpoint_packed_t *packed, size_t *bad_index ) {
+  for (size_t w = 0; w * 64 < packed->size; w++) {
+    const uint64_t *mag = packed->mag + w * 64;
+    size_t count = packed_word_count(packed->size, w);
+    //bits of the elements with magnitude 0, and of the unused elements
+    uint64_t zeros = count < 64 ? ~(uint64_t)0 << count : 0;
+    for (size_t k = 0; k < count; k++) {
+      zeros |= (uint64_t)(mag[k] == 0) << k;
+    }
+    uint64_t bad = packed->sign[w] & zeros;
+    if (bad != 0) {
+      size_t i = w * 64 + __builtin_ctzll(bad);
+      if (bad_index) *bad_index = i < packed->size ? i : packed->size;
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,93 @@
+#ifndef FIXPOINT_PACKED_H
+#define FIXPOINT_PACKED_H
+
+#include "fixpoint.h"
+
+////////////////////////////////////////////////////////////////////////
+// Data types
+////////////////////////////////////////////////////////////////////////
+
+//! Compact storage for an array of fixpoint_t values: element i has
+//! the 64 bit magnitude mag[i] (whole part in the high 32 bits,
+//! fractional part in the low 32 bits), and is negative if bit
+//! (i % 64) of sign[i / 64] is set. This takes 8.125 bytes per value
+//! instead of sizeof(fixpoint_t) == 12, and both arrays can be
+//! written to or mapped from a file as they are.
+//!
+//! The packed form holds values, not flagged results: an element with
+//! magnitude 0 is never negative. A negative 0 (which a fixpoint_t can
+//! only hold as an overflowed result) is stored as 0.
+typedef struct {
+  uint64_t *mag;    //!< magnitudes
+  uint64_t *sign;   //!< sign bitmap, one bit per element
+  size_t size;      //!< number of elements
+} fixpoint_packed_t;
+
+////////////////////////////////////////////////////////////////////////
+// Packed API functions
+////////////////////////////////////////////////////////////////////////
+
+//! Allocate storage for n packed values, all initialized to 0.
+//! The mag array is 16 byte aligned.
+//!
+//! @param packed pointer to the fixpoint_packed_t to initialize
+//! @param n number of elements
+//! @return true if successful, false if memory could not be allocated
+bool
+fixpoint_packed_init( fixpoint_packed_t *packed, size_t n );
+
+//! Free the storage of a fixpoint_packed_t initialized by
+//! fixpoint_packed_init.
+//!
+//! @param packed pointer to the fixpoint_packed_t to clean up
+void
+fixpoint_packed_cleanup( fixpoint_packed_t *packed );
+
+//! Get element i of a packed array.
+//!
+//! @param val pointer to the fixpoint_t where the element is stored
+//! @param packed pointer to the packed array
+//! @param i index of the element (must be less than packed->size)
+void
+fixpoint_packed_get( fixpoint_t *val, const fixpoint_packed_t *packed, size_t i );
+
+//! Set element i of a packed array. A negative 0 is stored as 0.
+//!
+//! @param packed pointer to the packed array
+//! @param i index of the element (must be less than packed->size)
+//! @param val pointer to the value to store
+void
+fixpoint_packed_set( fixpoint_packed_t *packed, size_t i, const fixpoint_t *val );
+
+//! Pack an array of packed->size fixpoint_t values. Negative 0s are
+//! stored as 0.
+//!
+//! @param packed pointer to the packed array
+//! @param vals array of packed->size values
+//! @return true if no value was a negative 0, false otherwise
+bool
+fixpoint_pack( fixpoint_packed_t *packed, const fixpoint_t *vals );
+
+//! Unpack the values in a packed array to an array of packed->size
+//! fixpoint_t values. The sign bits of elements with magnitude 0 are
+//! ignored, so the unpacked 0s are never negative even if the packed
+//! array is not valid (see fixpoint_packed_validate).
+//!
+//! @param vals array of packed->size values where the elements are stored
+//! @param packed pointer to the packed array
+void
+fixpoint_unpack( fixpoint_t *vals, const fixpoint_packed_t *packed );
+
+//! Check that a packed array (e.g., one read from a file) is valid:
+//! no element with magnitude 0 has its sign bit set, and the unused
+//! bits of the last sign word are 0.
+//!
+//! @param packed pointer to the packed array
+//! @param bad_index if not NULL and the array is not valid, set to the
+//!                  index of the first invalid element (or to
+//!                  packed->size if only the unused bits are set)
+//! @return true if the packed array is valid, false otherwise
+bool
+fixpoint_packed_validate( const fixpoint_packed_t *packed, size_t *bad_index );
+
+#endif // FIXPOINT_PACKED_H
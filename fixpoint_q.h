@@ -0,0 +1,224 @@
+#ifndef FIXPOINT_Q_H
+#define FIXPOINT_Q_H
+
+#include "fixpoint.h"
+
+////////////////////////////////////////////////////////////////////////
+// Qm.n formats
+//
+// Families of fixed point types with m integer bits (including the
+// sign bit) and n fractional bits, stored as two's complement 16, 32
+// or 64 bit words (m + n must be the word size): a value is the
+// word divided by 2^n. They take a half or a quarter of the space
+// of a fixpoint_t when the range and precision of a smaller format
+// are enough.
+//
+// FIXPOINT_Q_DEFINE16(name, n), FIXPOINT_Q_DEFINE32(name, n) and
+// FIXPOINT_Q_DEFINE64(name, n) define the type fixpoint_<name>_t and
+// these static inline functions (for a 32 bit word):
+//
+//   fixpoint_<name>_t fixpoint_<name>_from_raw( int32_t raw );
+//   int32_t fixpoint_<name>_raw( fixpoint_<name>_t val );
+//   result_t fixpoint_<name>_add( fixpoint_<name>_t *result,
+//                                 fixpoint_<name>_t left, fixpoint_<name>_t right );
+//   result_t fixpoint_<name>_sub( ... same as add ... );
+//   result_t fixpoint_<name>_mul( ... same as add ... );
+//   int fixpoint_<name>_compare( fixpoint_<name>_t left, fixpoint_<name>_t right );
+//   void fixpoint_<name>_format_hex( fixpoint_str_t *s, fixpoint_<name>_t val );
+//   result_t fixpoint_<name>_to_fixpoint( fixpoint_t *result, fixpoint_<name>_t val );
+//   result_t fixpoint_<name>_from_fixpoint( fixpoint_<name>_t *result, const fixpoint_t *val );
+//
+// The results and flags follow the same contract as fixpoint_add,
+// fixpoint_sub and fixpoint_mul: the exact result is truncated
+// towards 0 to n fractional bits (RESULT_UNDERFLOW if nonzero bits
+// were discarded), and if it is outside the range of the format
+// its low word bits are stored (RESULT_OVERFLOW). Conversions follow
+// the same contract. format_hex uses the format of
+// fixpoint_format_hex (the fractional digits are the n fractional
+// bits, padded with 0 bits to a multiple of 4).
+//
+// The formats fixpoint_q8_8_t, fixpoint_q16_16_t, fixpoint_q8_24_t
+// and (if the compiler has a 128 bit integer type) fixpoint_q32_32_t
+// are predefined.
+////////////////////////////////////////////////////////////////////////
+
+// Format a value with magnitude mag (n fractional bits) as hex
+static inline void
+fixpoint_q_format_hex( fixpoint_str_t *s, uint64_t mag, bool negative, unsigned n ) {
+  static const char digits[16] = {
+    '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f',
+  };
+  char *p = s->str;
+  *p = '-';
+  p += negative;
+
+  //whole digits without leading 0s (at least one)
+  uint64_t whole = n < 64 ? mag >> n : 0;
+  int whole_digits = whole ? (67 - __builtin_clzll(whole)) / 4 : 1;
+  for (int i = whole_digits - 1; i >= 0; i--) {
+    p[i] = digits[whole & 0xF];
+    whole >>= 4;
+  }
+  p += whole_digits;
+  *p++ = '.';
+
+  //frac bits left-aligned in 64 bits, then digits without trailing
+  //0s (at least one)
+  uint64_t frac = n ? mag << (64 - n) : 0;
+  do {
+    *p++ = digits[frac >> 60];
+    frac <<= 4;
+  } while (frac != 0);
+  *p = '\0';
+}
+
+// Convert a value with magnitude mag (n <= 64 fractional bits) to a
+// fixpoint_t
+static inline result_t
+fixpoint_q_to_fixpoint( fixpoint_t *result, uint64_t mag, bool negative, unsigned n ) {
+  //shift to 32 fractional bits
+  uint64_t fixed;
+  result_t ret = RESULT_OK;
+  if (n <= 32) {
+    fixed = mag << (32 - n);
+    if (n < 32 && (mag >> (32 + n)) != 0) {
+      ret |= RESULT_OVERFLOW;
+    }
+  } else {
+    fixed = mag >> (n - 32);
+    if ((mag & ((((uint64_t)1 << (n - 32)) - 1))) != 0) {
+      ret |= RESULT_UNDERFLOW;
+    }
+  }
+  result->whole = (uint32_t)(fixed >> 32);
+  result->frac = (uint32_t)fixed;
+  //only an exact 0 is never negative
+  result->negative = negative & (fixed != 0 || ret != RESULT_OK);
+  return ret;
+}
+
+// Convert a fixpoint_t to a value with n fractional bits in a word of
+// word_bits bits, returned sign extended to 64 bits
+static inline result_t
+fixpoint_q_from_fixpoint( int64_t *raw, const fixpoint_t *val, unsigned word_bits, unsigned n ) {
+  uint64_t mag = ((uint64_t)val->whole << 32) | val->frac;
+  bool negative = val->negative;
+
+  //shift to n fractional bits (the magnitude, in 96 bits if n > 32)
+  uint64_t shifted, high;
+  result_t ret = RESULT_OK;
+  if (n <= 32) {
+    shifted = mag >> (32 - n);
+    high = 0;
+    if (n < 32 && (mag & ((((uint64_t)1 << (32 - n)) - 1))) != 0) {
+      ret |= RESULT_UNDERFLOW;
+    }
+  } else {
+    shifted = mag << (n - 32);
+    high = mag >> (96 - n);
+  }
+
+  //the range is -2^(word_bits - 1) to 2^(word_bits - 1) - 1
+  uint64_t limit = (uint64_t)1 << (word_bits - 1);
+  if (high != 0 || shifted > limit - !negative) {
+    ret |= RESULT_OVERFLOW;
+  }
+  uint64_t bits = negative ? -shifted : shifted;
+  //keep the low word_bits bits, sign extended
+  unsigned unused = 64 - word_bits;
+  *raw = (int64_t)(bits << unused) >> unused;
+  return ret;
+}
+
+#define FIXPOINT_Q_DEFINE( name, word_t, uword_t, wide_t, uwide_t, word_bits, n ) \
+\
+typedef struct { \
+  word_t raw; /* value * 2^n */ \
+} fixpoint_##name##_t; \
+\
+static inline fixpoint_##name##_t \
+fixpoint_##name##_from_raw( word_t raw ) { \
+  fixpoint_##name##_t val = { raw }; \
+  return val; \
+} \
+\
+static inline word_t \
+fixpoint_##name##_raw( fixpoint_##name##_t val ) { \
+  return val.raw; \
+} \
+\
+static inline result_t \
+fixpoint_##name##_add( fixpoint_##name##_t *result, fixpoint_##name##_t left, \
+                       fixpoint_##name##_t right ) { \
+  return __builtin_add_overflow(left.raw, right.raw, &result->raw) ? RESULT_OVERFLOW : RESULT_OK; \
+} \
+\
+static inline result_t \
+fixpoint_##name##_sub( fixpoint_##name##_t *result, fixpoint_##name##_t left, \
+                       fixpoint_##name##_t right ) { \
+  return __builtin_sub_overflow(left.raw, right.raw, &result->raw) ? RESULT_OVERFLOW : RESULT_OK; \
+} \
+\
+static inline result_t \
+fixpoint_##name##_mul( fixpoint_##name##_t *result, fixpoint_##name##_t left, \
+                       fixpoint_##name##_t right ) { \
+  /* truncate the magnitude of the exact product towards 0 */ \
+  wide_t product = (wide_t)left.raw * right.raw; \
+  bool negative = product < 0; \
+  uwide_t mag = negative ? -(uwide_t)product : (uwide_t)product; \
+  uwide_t truncated = mag >> (n); \
+  result_t ret = (mag & ((((uwide_t)1) << (n)) - 1)) != 0 ? RESULT_UNDERFLOW : RESULT_OK; \
+  /* the range is -2^(word_bits - 1) to 2^(word_bits - 1) - 1 */ \
+  if (truncated > (((uwide_t)1) << ((word_bits) - 1)) - !negative) { \
+    ret |= RESULT_OVERFLOW; \
+  } \
+  result->raw = (word_t)(uword_t)(negative ? -truncated : truncated); \
+  return ret; \
+} \
+\
+static inline int \
+fixpoint_##name##_compare( fixpoint_##name##_t left, fixpoint_##name##_t right ) { \
+  return (left.raw > right.raw) - (left.raw < right.raw); \
+} \
+\
+static inline void \
+fixpoint_##name##_format_hex( fixpoint_str_t *s, fixpoint_##name##_t val ) { \
+  uint64_t mag = val.raw < 0 ? -(uint64_t)val.raw : (uint64_t)val.raw; \
+  fixpoint_q_format_hex(s, mag, val.raw < 0, (n)); \
+} \
+\
+static inline result_t \
+fixpoint_##name##_to_fixpoint( fixpoint_t *result, fixpoint_##name##_t val ) { \
+  uint64_t mag = val.raw < 0 ? -(uint64_t)val.raw : (uint64_t)val.raw; \
+  return fixpoint_q_to_fixpoint(result, mag, val.raw < 0, (n)); \
+} \
+\
+static inline result_t \
+fixpoint_##name##_from_fixpoint( fixpoint_##name##_t *result, const fixpoint_t *val ) { \
+  int64_t raw; \
+  result_t ret = fixpoint_q_from_fixpoint(&raw, val, (word_bits), (n)); \
+  result->raw = (word_t)raw; \
+  return ret; \
+}
+
+//! Define a Qm.n format stored in 16 bits (m = 16 - n).
+#define FIXPOINT_Q_DEFINE16( name, n ) \
+  FIXPOINT_Q_DEFINE( name, int16_t, uint16_t, int32_t, uint32_t, 16, n )
+
+//! Define a Qm.n format stored in 32 bits (m = 32 - n).
+#define FIXPOINT_Q_DEFINE32( name, n ) \
+  FIXPOINT_Q_DEFINE( name, int32_t, uint32_t, int64_t, uint64_t, 32, n )
+
+//! Define a Qm.n format stored in 64 bits (m = 64 - n); requires a
+//! 128 bit integer type for the products.
+#define FIXPOINT_Q_DEFINE64( name, n ) \
+  FIXPOINT_Q_DEFINE( name, int64_t, uint64_t, __int128, unsigned __int128, 64, n )
+
+FIXPOINT_Q_DEFINE16( q8_8, 8 )
+FIXPOINT_Q_DEFINE32( q16_16, 16 )
+FIXPOINT_Q_DEFINE32( q8_24, 24 )
+#ifdef __SIZEOF_INT128__
+FIXPOINT_Q_DEFINE64( q32_32, 32 )
+#endif
+
+#endif // FIXPOINT_Q_H
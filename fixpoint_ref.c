@@ -0,0 +1,383 @@
+#include <stdio.h>
+#include <string.h>
+#include "fixpoint_ref.h"
+
+////////////////////////////////////////////////////////////////////////
+// Reference implementations, see fixpoint_ref.h
+////////////////////////////////////////////////////////////////////////
+
+static void
+ref_negate( fixpoint_t *val ) {
+  if (!(val->whole == 0 && val->frac == 0)) {
+    val->negative = !val->negative;
+  } else {
+    val->negative = false;
+  }
+}
+
+// Helper function to add two values with the same sign
+static result_t
+handle_addition( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  result->whole = left->whole + right->whole;
+  result->frac = left->frac + right->frac;
+  result->negative = left->negative;
+  //if overflow in the fraction occurs, add one to the whole
+  if (result->frac < left->frac || result->frac < right->frac) {
+    result->whole += 1;
+  }
+  //if overflow occurs
+  if (result->whole < left->whole || result->whole < right->whole) {
+    return RESULT_OVERFLOW;
+  }
+  return RESULT_OK;
+
+}
+
+static void
+handle_whole_sub_calc( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  if (left->whole > right->whole) {
+    result->whole = left->whole - right->whole;
+    result->negative = left->negative;
+  }
+  else if (right->whole > left->whole) {
+    result->whole = right->whole - left->whole;
+    result->negative = !left->negative;
+  }
+  else {
+    result->whole = 0;
+  }
+}
+
+// Helper function for left > right fraction case
+static void
+handle_left_frac_greater_case( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  if(result->whole == 0) {
+    result->negative = left->negative;
+    result->frac = left->frac - right->frac;
+  } else {
+    if((!result->negative && !left->negative) || (result->negative && left->negative)){
+      uint64_t borrowed_calc = 0x100000000ULL + left->frac - right->frac;
+      result->frac = (uint32_t)borrowed_calc;
+    } else if ((result->negative && !left->negative) || (!result->negative && left->negative)){
+      result->whole -= 1;
+      uint64_t borrowed_calc = 0x100000000ULL + right->frac - left->frac;
+      result->frac = (uint32_t)borrowed_calc;
+    }
+  }
+}
+
+// Helper function for right > left fraction case  
+static void
+handle_right_frac_greater_case( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  if(result->whole == 0) {
+    result->negative = !left->negative;
+    result->frac = right->frac - left->frac;
+  } else {
+    if((!result->negative && !left->negative) || (result->negative && left->negative)){
+      result->whole -= 1;
+      uint64_t borrowed_calc = 0x100000000ULL + left->frac - right->frac;
+      result->frac = (uint32_t)borrowed_calc;
+    } else if ((result->negative && !left->negative) || (!result->negative && left->negative)){
+      uint64_t borrowed_calc = 0x100000000ULL + right->frac - left->frac;
+      result->frac = (uint32_t)borrowed_calc;
+    }
+  }
+}
+
+// Helper function to handle subtraction fraction calculation
+static void
+handle_sub_fraction_calc( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  if (left->frac > right->frac) {
+    handle_left_frac_greater_case(result, left, right);
+  } else if (right->frac > left->frac) {
+    handle_right_frac_greater_case(result, left, right);
+  } else {
+    if(result->whole == 0) {
+      result->negative = false;
+    }
+    result->frac = 0;
+  }
+}
+
+// Helper function to check if character is valid hex
+static bool
+is_valid_hex_char( char c ) {
+  return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+}
+
+// Helper function to validate whole part of hex string
+static bool
+validate_hex_whole_part( const char *str, int *cx, bool negative ) {
+  while (str[*cx] != '.') {
+    if (!is_valid_hex_char(str[*cx])) {
+      return false;
+    }
+    (*cx)++;
+  }
+  (*cx)++;
+  if ((((*cx) > 10 || (*cx) < 3) && negative) || (((*cx) > 9 || (*cx) < 2) && !negative)) {
+    return false;
+  }
+  return true;
+}
+
+// Helper function to validate fraction part of hex string
+static bool
+validate_hex_frac_part( const char *str, int *cx, int *digitsInFrac ) {
+  while (str[*cx] != '\0' && *digitsInFrac <= 8) {
+    (*digitsInFrac)++;
+    if (!is_valid_hex_char(str[*cx])) {
+      return false;
+    }
+    (*cx)++;
+  }
+  if (*digitsInFrac > 8 || *digitsInFrac < 1) {
+    return false;
+  }
+  return true;
+}
+
+// Helper function to validate hex string format
+static bool
+validate_hex_string( const char *str, int *cx, bool negative, int *digitsInFrac ) {
+  return validate_hex_whole_part(str, cx, negative) && 
+         validate_hex_frac_part(str, cx, digitsInFrac);
+}
+
+result_t
+fixpoint_ref_add( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  //if opposite signs, negates the negative one and calls sub
+  if (left->negative ^ right->negative) {
+    if(left->negative) {
+      fixpoint_t newLeft = *left;
+      ref_negate(&newLeft);
+      result_t to_return = fixpoint_ref_sub(result, &newLeft, right);
+      //negates if left was negative because should be neg after
+      ref_negate(result);
+      return to_return;
+    }
+    if(right->negative) {
+      fixpoint_t newRight = *right;
+      ref_negate(&newRight);
+      return fixpoint_ref_sub(result, left, &newRight);
+    }
+  }
+
+  //executes addition
+  return handle_addition( result, left, right );
+}
+result_t
+fixpoint_ref_sub( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right ) {
+  //if opposite signs, negates the negative one and calls add
+  if (left->negative ^ right->negative) {
+    if(left->negative) {
+      fixpoint_t newLeft = *left;
+      ref_negate(&newLeft);
+      result_t res = fixpoint_ref_add(result, &newLeft, right);
+      //manually set the sign since negate won't work on zero
+      if (res == RESULT_OVERFLOW && result->whole == 0 && result->frac == 0) {
+        result->negative = true;
+      } else {
+        ref_negate(result);
+      }
+      return res;
+    }
+    if(right->negative) {
+      fixpoint_t newRight = *right;
+      ref_negate(&newRight);
+      return fixpoint_ref_add(result, left, &newRight);
+    }
+  }
+
+  //takes into account which whole is bigger and subtracts/sets negative
+  handle_whole_sub_calc (result, left, right);
+
+  //handle fraction calculation
+  handle_sub_fraction_calc(result, left, right);
+  return RESULT_OK;
+}
+
+void
+fixpoint_ref_format_hex( fixpoint_str_t *s, const fixpoint_t *val ) {
+  int cx = 0;
+  //adds - for negative
+  if (val->negative) {
+    s->str[0] = '-';
+    cx = 1;
+  }
+ 
+  //adds hexstring and '.' for whole
+  cx += snprintf(s->str + cx, FIXPOINT_STR_MAX_SIZE - cx, "%x.", val->whole);
+
+  //if just 0, adds 0 to frac, if not, adds hexstring then removes all trailing 0s
+  if (val->frac == 0) {
+    cx += snprintf(s->str + cx, FIXPOINT_STR_MAX_SIZE - cx, "%d", 0);
+  } else {
+    cx += snprintf(s->str + cx, FIXPOINT_STR_MAX_SIZE - cx, "%08x", val->frac);
+    while (s->str[cx - 1] == '0') {
+      s->str[cx - 1] = '\0';
+      cx--;
+    }
+  }
+}
+
+bool
+fixpoint_ref_parse_hex( fixpoint_t *val, const fixpoint_str_t *s ) {
+  //buffer for parsing making sure everything is right
+  int cx = 0;
+  int digitsInFrac = 0;
+  //allow adding trailing 0s by modifying base string
+  char newStr [FIXPOINT_STR_MAX_SIZE];
+  strcpy(newStr, s->str);
+
+  //determing if negative
+  if (newStr[0] == '-') {
+    val->negative = true;
+    cx++;
+  } else {
+    val->negative = false;
+  }
+
+  //validate string format
+  if (!validate_hex_string(newStr, &cx, val->negative, &digitsInFrac)) {
+    return 0;
+  }
+
+  //add 0s to end of string
+  int len = strlen(newStr);
+  while (digitsInFrac < 8) {
+      newStr[len++] = '0';
+      digitsInFrac++;
+  }
+  newStr[len] = '\0';
+
+  //put values in correct spots
+  if(!val->negative) sscanf (newStr, "%x%*c%x", &val->whole, &val->frac);
+  if(val->negative) sscanf (newStr, "%*c%x%*c%x", &val->whole, &val->frac);
+
+  //success
+  return 1;
+}
+
+void
+fixpoint_ref_format_dec( fixpoint_str_t *s, const fixpoint_t *val ) {
+  int cx = 0;
+  if (val->negative) {
+    s->str[cx++] = '-';
+  }
+
+  //whole digits by repeated division by 10 (least significant first)
+  char whole[10];
+  int nwhole = 0;
+  uint32_t w = val->whole;
+  do {
+    whole[nwhole++] = (char)('0' + w % 10);
+    w /= 10;
+  } while (w != 0);
+  while (nwhole > 0) {
+    s->str[cx++] = whole[--nwhole];
+  }
+  s->str[cx++] = '.';
+
+  //all 32 digits of frac / 2^32 by long division
+  char digits[32];
+  uint64_t rem = val->frac;
+  const uint64_t denom = 0x100000000ULL;
+  for (int i = 0; i < 32; i++) {
+    rem *= 10;
+    digits[i] = (char)(rem / denom);
+    rem %= denom;
+  }
+
+  //round to 10 digits: up if the rest is more than half, or exactly
+  //half and the last kept digit is odd
+  bool rest_nonzero = false;
+  for (int i = 11; i < 32; i++) {
+    if (digits[i] != 0) {
+      rest_nonzero = true;
+    }
+  }
+  if (digits[10] > 5 || (digits[10] == 5 && (rest_nonzero || digits[9] % 2 == 1))) {
+    int i = 9;
+    while (digits[i] == 9) {
+      digits[i--] = 0;
+    }
+    digits[i]++;
+  }
+
+  int nfrac = 10;
+  while (nfrac > 1 && digits[nfrac - 1] == 0) {
+    nfrac--;
+  }
+  for (int i = 0; i < nfrac; i++) {
+    s->str[cx++] = (char)('0' + digits[i]);
+  }
+  s->str[cx] = '\0';
+}
+
+bool
+fixpoint_ref_parse_dec( fixpoint_t *val, const fixpoint_str_t *s ) {
+  const char *str = s->str;
+  int cx = 0;
+  val->negative = (str[0] == '-');
+  if (val->negative) {
+    cx++;
+  }
+
+  //whole part
+  uint64_t whole = 0;
+  int nwhole = 0;
+  while (str[cx] >= '0' && str[cx] <= '9') {
+    whole = whole * 10 + (uint64_t)(str[cx++] - '0');
+    if (++nwhole > 10) {
+      return false;
+    }
+  }
+  if (nwhole == 0 || whole > 0xFFFFFFFFULL || str[cx++] != '.') {
+    return false;
+  }
+
+  //fraction digits
+  char digits[FIXPOINT_STR_MAX_SIZE];
+  int nfrac = 0;
+  while (str[cx] >= '0' && str[cx] <= '9') {
+    digits[nfrac++] = (char)(str[cx++] - '0');
+  }
+  if (nfrac == 0 || str[cx] != '\0') {
+    return false;
+  }
+
+  //double the decimal fraction 33 times: each digit carried out of
+  //the front is the next bit (32 frac bits, then the rounding bit)
+  uint64_t bits = 0;
+  for (int b = 0; b < 33; b++) {
+    int carry = 0;
+    for (int i = nfrac - 1; i >= 0; i--) {
+      int d = digits[i] * 2 + carry;
+      digits[i] = (char)(d % 10);
+      carry = d / 10;
+    }
+    bits = (bits << 1) | (uint64_t)carry;
+  }
+  bool rest_nonzero = false;
+  for (int i = 0; i < nfrac; i++) {
+    if (digits[i] != 0) {
+      rest_nonzero = true;
+    }
+  }
+
+  uint64_t frac = bits >> 1;
+  if ((bits & 1) && (rest_nonzero || (frac & 1))) {
+    frac++;
+  }
+  if (frac == 0x100000000ULL) {
+    frac = 0;
+    whole++;
+  }
+  if (whole > 0xFFFFFFFFULL) {
+    return false;
+  }
+  val->whole = (uint32_t)whole;
+  val->frac = (uint32_t)frac;
+  return true;
+}
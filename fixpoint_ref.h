@@ -0,0 +1,47 @@
+#ifndef FIXPOINT_REF_H
+#define FIXPOINT_REF_H
+
+#include "fixpoint.h"
+
+////////////////////////////////////////////////////////////////////////
+// Reference implementations
+//
+// These are the original (straightforward, unoptimized) versions of
+// functions in fixpoint.c that have since been rewritten for speed,
+// and straightforward versions of newer functions.
+// They are not part of the library: they are only linked into the
+// benchmark program (as the baseline the optimized versions are
+// compared against) and the unit tests (to check that the optimized
+// versions compute the same results).
+////////////////////////////////////////////////////////////////////////
+
+//! Original version of fixpoint_add.
+//! Note that it misses the overflow when both whole parts are
+//! 0xFFFFFFFF and the fractional parts carry.
+result_t
+fixpoint_ref_add( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
+
+//! Original version of fixpoint_sub (same caveat as fixpoint_ref_add).
+result_t
+fixpoint_ref_sub( fixpoint_t *result, const fixpoint_t *left, const fixpoint_t *right );
+
+//! Original version of fixpoint_format_hex (uses snprintf).
+void
+fixpoint_ref_format_hex( fixpoint_str_t *s, const fixpoint_t *val );
+
+//! Original version of fixpoint_parse_hex (validates, then uses sscanf).
+bool
+fixpoint_ref_parse_hex( fixpoint_t *val, const fixpoint_str_t *s );
+
+//! Straightforward version of fixpoint_format_dec: generates all 32
+//! exact fractional digits by long division, then rounds the digit
+//! string.
+void
+fixpoint_ref_format_dec( fixpoint_str_t *s, const fixpoint_t *val );
+
+//! Straightforward version of fixpoint_parse_dec: converts the
+//! fraction one bit at a time by doubling the decimal digits.
+bool
+fixpoint_ref_parse_dec( fixpoint_t *val, const fixpoint_str_t *s );
+
+#endif // FIXPOINT_REF_H
@@ -1,7 +1,16 @@
 #include <stdlib.h>
+#include <math.h>
 #include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
 #include "tctest.h"
 #include "fixpoint.h"
+#include "fixpoint_inline.h"
+#include "fixpoint_q.h"
+#include "fixpoint_ref.h"
+#include "fixpoint_column.h"
+#include "fixpoint_io.h"
+#include "fixpoint_packed.h"
 
 // Test fixture: defines some fixpoint_t instances
 // that can be used by test functions
@@ -53,6 +62,23 @@ do { \
   (val)->negative = n; \
 } while ( 0 )
 
+// Seeds for test_rand (two, so that tests that need a second
+// stream of values don't repeat the first one)
+#define TEST_RAND_SEED 0x9E3779B97F4A7C15ULL
+#define TEST_RAND_SEED2 0x2545F4914F6CDD1DULL
+
+// Pseudo-random values for the randomized tests (xorshift64): advances
+// *state and returns the new value
+static uint64_t
+test_rand( uint64_t *state ) {
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  *state = x;
+  return x;
+}
+
 // Macro to check two fixpoint_t instances for exact equality
 #define TEST_EQUAL( val1, val2 ) \
 do { \
@@ -65,55 +91,20 @@ do { \
 // to a temporary instance of fixpoint_str_t
 #define FIXPOINT_STR( strlit ) &( ( fixpoint_str_t ) { .str = (strlit) } )
 
-// Prototypes for test functions
-void test_init( TestObjs *objs );
-void test_get_whole( TestObjs *objs );
-void test_get_frac( TestObjs *objs );
-void test_is_negative( TestObjs *objs );
-void test_negate( TestObjs *objs );
-void test_add( TestObjs *objs );
-void test_sub( TestObjs *objs );
-void test_mul( TestObjs *objs );
-void test_compare( TestObjs *objs );
-void test_format_hex( TestObjs *objs );
-void test_parse_hex( TestObjs *objs );
-// Additional comprehensive test functions
-void test_add_2( TestObjs *objs );
-void test_sub_2( TestObjs *objs );
-void test_mul_2( TestObjs *objs );
-void test_compare_2( TestObjs *objs );
-void test_negate_2( TestObjs *objs );
-void test_format_hex_2( TestObjs *objs );
-void test_parse_hex_2( TestObjs *objs );
-void test_negate_2( TestObjs *objs );
-void test_is_negative_2( TestObjs *objs );
-
+// The tests are defined with TEST_CASE(), and executed in order of
+// definition by TEST_RUN_ALL(). The optional argument selects the
+// tests to execute by name, as a glob pattern (e.g., "test_parse_*").
 int main( int argc, char **argv ) {
   if ( argc > 1 )
     tctest_testname_to_execute = argv[1];
 
+  //a test stuck in a loop fails instead of hanging the whole run
+  //(TCTEST_TIMEOUT overrides this)
+  tctest_timeout = 60;
+
   TEST_INIT();
 
-  TEST( test_init );
-  TEST( test_get_whole );
-  TEST( test_get_frac );
-  TEST( test_is_negative );
-  TEST( test_negate );
-  TEST( test_add );
-  TEST( test_sub );
-  TEST( test_mul );
-  TEST( test_compare );
-  TEST( test_format_hex );
-  TEST( test_parse_hex );
-  // Additional comprehensive tests
-  TEST( test_is_negative_2 );
-  TEST( test_add_2 );
-  TEST( test_sub_2 );
-  TEST( test_mul_2 );
-  TEST( test_compare_2 );
-  TEST( test_negate_2 );
-  TEST( test_format_hex_2 );
-  TEST( test_parse_hex_2 );
+  TEST_RUN_ALL();
 
   TEST_FINI();
 }
@@ -159,7 +150,7 @@ void cleanup( TestObjs *objs ) {
   free( objs );
 }
 
-void test_init( TestObjs *objs ) {
+TEST_CASE( test_init ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -176,7 +167,7 @@ void test_init( TestObjs *objs ) {
   ASSERT( val.negative == true );
 }
 
-void test_get_whole( TestObjs *objs ) {
+TEST_CASE( test_get_whole ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -191,7 +182,7 @@ void test_get_whole( TestObjs *objs ) {
   ASSERT( fixpoint_get_whole( &objs->neg_eleven ) == 11 );
 }
 
-void test_get_frac( TestObjs *objs ) {
+TEST_CASE( test_get_frac ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -206,7 +197,7 @@ void test_get_frac( TestObjs *objs ) {
   ASSERT( fixpoint_get_frac( &objs->neg_eleven ) == 0 );
 }
 
-void test_is_negative( TestObjs *objs ) {
+TEST_CASE( test_is_negative ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -221,7 +212,7 @@ void test_is_negative( TestObjs *objs ) {
   ASSERT( fixpoint_is_negative( &objs->neg_eleven ) == true );
 }
 
-void test_negate( TestObjs *objs ) {
+TEST_CASE( test_negate ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -257,7 +248,7 @@ void test_negate( TestObjs *objs ) {
   ASSERT( false == result.negative );
 }
 
-void test_add( TestObjs *objs ) {
+TEST_CASE( test_add ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
   fixpoint_t result;
@@ -290,7 +281,7 @@ void test_add( TestObjs *objs ) {
   ASSERT( fixpoint_add( &result, &neg_max, &neg_min ) == RESULT_OVERFLOW );
 }
 
-void test_sub( TestObjs *objs ) {
+TEST_CASE( test_sub ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -311,7 +302,7 @@ void test_sub( TestObjs *objs ) {
   ASSERT( fixpoint_sub( &result, &neg_min, &objs->max ) == RESULT_OVERFLOW );
 }
 
-void test_mul( TestObjs *objs ) {
+TEST_CASE( test_mul ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -328,7 +319,7 @@ void test_mul( TestObjs *objs ) {
   ASSERT( false == result.negative );
 }
 
-void test_compare( TestObjs *objs ) {
+TEST_CASE( test_compare ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -339,7 +330,7 @@ void test_compare( TestObjs *objs ) {
   ASSERT( 1 == fixpoint_compare( &objs->one_half, &objs->neg_three_eighths ) );
 }
 
-void test_format_hex( TestObjs *objs ) {
+TEST_CASE( test_format_hex ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -373,7 +364,7 @@ void test_format_hex( TestObjs *objs ) {
   ASSERT( 0 == strcmp( "-b.0", s.str ) );
 }
 
-void test_parse_hex( TestObjs *objs ) {
+TEST_CASE( test_parse_hex ) {
   // Note: don't modify the provided test functions.
   // Instead, add new test functions containing your new tests.
 
@@ -414,7 +405,7 @@ void test_parse_hex( TestObjs *objs ) {
   // your own test functions.
 }
 
-void test_is_negative_2 (TestObjs *objs) {
+TEST_CASE( test_is_negative_2 ) {
   fixpoint_t result;
 
   //getting is_negative on negative 0 should be true
@@ -423,7 +414,7 @@ void test_is_negative_2 (TestObjs *objs) {
   ASSERT( fixpoint_is_negative( &result ) == true );
 }
 
-void test_add_2( TestObjs *objs ) {
+TEST_CASE( test_add_2 ) {
   fixpoint_t result;
   
   // Test adding two negative numbers
@@ -504,7 +495,7 @@ void test_add_2( TestObjs *objs ) {
 
 }
 
-void test_sub_2( TestObjs *objs ) {
+TEST_CASE( test_sub_2 ) {
   fixpoint_t result;
   
   // Test subtracting same values (should result in zero)
@@ -659,7 +650,7 @@ void test_sub_2( TestObjs *objs ) {
 
 }
 
-void test_mul_2( TestObjs *objs ) {
+TEST_CASE( test_mul_2 ) {
   fixpoint_t result;
     
   // Test multiplication by one
@@ -721,7 +712,7 @@ void test_mul_2( TestObjs *objs ) {
 
 }
 
-void test_compare_2( TestObjs *objs ) {
+TEST_CASE( test_compare_2 ) {
   // Test comparing equal values
   ASSERT( 0 == fixpoint_compare(&objs->zero, &objs->zero) );
   ASSERT( 0 == fixpoint_compare(&objs->one, &objs->one) );
@@ -743,7 +734,7 @@ void test_compare_2( TestObjs *objs ) {
   ASSERT( 1 == fixpoint_compare(&pos_eleven, &objs->neg_eleven) );
 }
 
-void test_negate_2( TestObjs *objs ) {
+TEST_CASE( test_negate_2 ) {
   fixpoint_t result;
   
   // Test negating negative zero (from overflow)
@@ -760,7 +751,7 @@ void test_negate_2( TestObjs *objs ) {
   TEST_EQUAL(&objs->one_and_one_half, &result);
 }
 
-void test_format_hex_2( TestObjs *objs ) {
+TEST_CASE( test_format_hex_2 ) {
   fixpoint_str_t s;
   
   // Test formatting large values
@@ -782,7 +773,7 @@ void test_format_hex_2( TestObjs *objs ) {
   ASSERT( 0 == strcmp("-f.1234", s.str) );
 }
 
-void test_parse_hex_2( TestObjs *objs ) {
+TEST_CASE( test_parse_hex_2 ) {
   // NOTE: These tests will be useful when parse_hex is implemented
   fixpoint_t val;
   
@@ -809,4 +800,1627 @@ void test_parse_hex_2( TestObjs *objs ) {
   ASSERT( val.whole == 0xABC );
   ASSERT( val.frac == 0xDEF00000 );
   ASSERT( val.negative == false );
-}
\ No newline at end of file
+}
+
+TEST_CASE( test_add_sub_overflow ) {
+  fixpoint_t result;
+
+  //whole parts both 0xFFFFFFFF with a carry out of the fraction
+  ASSERT( RESULT_OVERFLOW == fixpoint_add(&result, &objs->max, &objs->max) );
+  ASSERT( result.whole == 0xFFFFFFFF );
+  ASSERT( result.frac == 0xFFFFFFFE );
+  ASSERT( result.negative == false );
+
+  ASSERT( RESULT_OVERFLOW == fixpoint_add(&result, &objs->neg_max, &objs->neg_max) );
+  ASSERT( result.whole == 0xFFFFFFFF );
+  ASSERT( result.frac == 0xFFFFFFFE );
+  ASSERT( result.negative == true );
+
+  ASSERT( RESULT_OVERFLOW == fixpoint_sub(&result, &objs->max, &objs->neg_max) );
+  ASSERT( result.whole == 0xFFFFFFFF );
+  ASSERT( result.frac == 0xFFFFFFFE );
+  ASSERT( result.negative == false );
+
+  //overflow that wraps to exactly 0 keeps the sign
+  ASSERT( RESULT_OVERFLOW == fixpoint_add(&result, &objs->neg_max, &objs->neg_min) );
+  ASSERT( result.whole == 0 );
+  ASSERT( result.frac == 0 );
+  ASSERT( result.negative == true );
+}
+
+TEST_CASE( test_add_sub_matches_ref ) {
+  static const uint32_t parts[] = {
+    0, 1, 2, 0x7FFFFFFF, 0x80000000, 0xC0000000, 0xFFFFFFFE, 0xFFFFFFFF,
+  };
+  const size_t nparts = sizeof(parts) / sizeof(parts[0]);
+  const size_t nvals = nparts * nparts * 2;
+
+  for (size_t i = 0; i < nvals * nvals; i++) {
+    size_t l = i / nvals, r = i % nvals;
+    fixpoint_t left, right, expected, actual;
+    TEST_FIXPOINT_INIT( &left, parts[l / (nparts * 2)], parts[(l / 2) % nparts], l % 2 );
+    TEST_FIXPOINT_INIT( &right, parts[r / (nparts * 2)], parts[(r / 2) % nparts], r % 2 );
+    //zero is never negative on input
+    if (left.whole == 0 && left.frac == 0) left.negative = false;
+    if (right.whole == 0 && right.frac == 0) right.negative = false;
+
+    for (int op = 0; op < 2; op++) {
+      result_t expected_res = op ? fixpoint_ref_sub(&expected, &left, &right)
+                                 : fixpoint_ref_add(&expected, &left, &right);
+      result_t actual_res = op ? fixpoint_sub(&actual, &left, &right)
+                               : fixpoint_add(&actual, &left, &right);
+      TEST_EQUAL( &expected, &actual );
+      //the reference misses overflows when both whole parts are
+      //0xFFFFFFFF (see test_add_sub_overflow)
+      if (expected_res != actual_res) {
+        ASSERT( actual_res == RESULT_OVERFLOW );
+        ASSERT( left.whole == 0xFFFFFFFF && right.whole == 0xFFFFFFFF );
+      }
+    }
+  }
+}
+
+TEST_CASE( test_batch_ops ) {
+  const fixpoint_t vals[] = {
+    objs->zero, objs->one, objs->neg_one, objs->max, objs->neg_max, objs->min,
+    objs->neg_min, objs->one_half, objs->neg_three_eighths, objs->neg_whole_max,
+    objs->ten_and_quarter, objs->neg_ten_point_sevenfive,
+  };
+  enum { NVALS = sizeof(vals) / sizeof(vals[0]), N = NVALS * NVALS };
+  fixpoint_t left[N], right[N], result[N], expected;
+  result_t flags[N];
+  int cmp[N];
+
+  for (int i = 0; i < N; i++) {
+    left[i] = vals[i / NVALS];
+    right[i] = vals[i % NVALS];
+  }
+
+  //every element should match the scalar function
+  result_t all = fixpoint_add_n(result, left, right, N, flags);
+  for (int i = 0; i < N; i++) {
+    ASSERT( flags[i] == fixpoint_add(&expected, &left[i], &right[i]) );
+    TEST_EQUAL( &expected, &result[i] );
+  }
+  ASSERT( all == RESULT_OVERFLOW );
+
+  fixpoint_sub_n(result, left, right, N, flags);
+  for (int i = 0; i < N; i++) {
+    ASSERT( flags[i] == fixpoint_sub(&expected, &left[i], &right[i]) );
+    TEST_EQUAL( &expected, &result[i] );
+  }
+
+  all = fixpoint_mul_n(result, left, right, N, flags);
+  for (int i = 0; i < N; i++) {
+    ASSERT( flags[i] == fixpoint_mul(&expected, &left[i], &right[i]) );
+    TEST_EQUAL( &expected, &result[i] );
+  }
+  ASSERT( all == (RESULT_OVERFLOW | RESULT_UNDERFLOW) );
+
+  fixpoint_compare_n(cmp, left, right, N);
+  for (int i = 0; i < N; i++) {
+    ASSERT( cmp[i] == fixpoint_compare(&left[i], &right[i]) );
+  }
+
+  //flags are optional, and n == 0 does nothing
+  ASSERT( RESULT_OK == fixpoint_add_n(result, &objs->one, &objs->one, 1, NULL) );
+  ASSERT( result[0].whole == 2 );
+  ASSERT( RESULT_OK == fixpoint_mul_n(result, left, right, 0, NULL) );
+}
+
+TEST_CASE( test_column ) {
+  //not a multiple of 8 and more than one sign word, so the SIMD
+  //kernels' leftover elements and sign word boundaries are covered
+  enum { N = 150 };
+  const fixpoint_t edge[] = {
+    objs->zero, objs->one, objs->neg_one, objs->max, objs->neg_max, objs->min,
+    objs->neg_min, objs->whole_max, objs->neg_whole_max, objs->one_half,
+  };
+  const int nedge = sizeof(edge) / sizeof(edge[0]);
+  fixpoint_t left[N], right[N], out[N], expected;
+  result_t flags[N];
+  int cmp[N];
+  uint64_t rng = TEST_RAND_SEED2;
+
+  for (int i = 0; i < N; i++) {
+    if (i < nedge * nedge) {
+      left[i] = edge[i / nedge];
+      right[i] = edge[i % nedge];
+    } else {
+      //xorshift64
+      for (int k = 0; k < 2; k++) {
+        test_rand( &rng );
+        fixpoint_t *v = k ? &right[i] : &left[i];
+        //small whole parts on one side so mul doesn't always overflow
+        TEST_FIXPOINT_INIT( v, (uint32_t)(rng >> 32) >> (k * 20), (uint32_t)rng, rng >> 63 );
+      }
+    }
+  }
+
+  fixpoint_column_t lcol, rcol, res;
+  ASSERT( fixpoint_column_init(&lcol, N) );
+  ASSERT( fixpoint_column_init(&rcol, N) );
+  ASSERT( fixpoint_column_init(&res, N) );
+  fixpoint_column_from_array(&lcol, left);
+  fixpoint_column_from_array(&rcol, right);
+
+  //round trip
+  fixpoint_column_to_array(out, &lcol);
+  for (int i = 0; i < N; i++) {
+    TEST_EQUAL( &left[i], &out[i] );
+  }
+
+  fixpoint_isa_t best = fixpoint_get_isa();
+  for (int isa = FIXPOINT_ISA_SCALAR; isa <= FIXPOINT_ISA_AVX2; isa++) {
+    if (!fixpoint_set_isa(isa)) {
+      continue;
+    }
+
+    fixpoint_column_add(&res, &lcol, &rcol, flags);
+    fixpoint_column_to_array(out, &res);
+    for (int i = 0; i < N; i++) {
+      ASSERT( flags[i] == fixpoint_add(&expected, &left[i], &right[i]) );
+      TEST_EQUAL( &expected, &out[i] );
+    }
+
+    fixpoint_column_sub(&res, &lcol, &rcol, flags);
+    fixpoint_column_to_array(out, &res);
+    for (int i = 0; i < N; i++) {
+      ASSERT( flags[i] == fixpoint_sub(&expected, &left[i], &right[i]) );
+      TEST_EQUAL( &expected, &out[i] );
+    }
+
+    fixpoint_column_mul(&res, &lcol, &rcol, flags);
+    fixpoint_column_to_array(out, &res);
+    for (int i = 0; i < N; i++) {
+      ASSERT( flags[i] == fixpoint_mul(&expected, &left[i], &right[i]) );
+      TEST_EQUAL( &expected, &out[i] );
+    }
+
+    fixpoint_column_compare(cmp, &lcol, &rcol);
+    for (int i = 0; i < N; i++) {
+      ASSERT( cmp[i] == fixpoint_compare(&left[i], &right[i]) );
+    }
+
+    //result column can be one of the inputs
+    fixpoint_t one_val;
+    ASSERT( RESULT_OK == fixpoint_column_sub(&lcol, &lcol, &lcol, NULL) );
+    fixpoint_column_get(&one_val, &lcol, 3);
+    ASSERT( one_val.whole == 0 && one_val.frac == 0 && !one_val.negative );
+    fixpoint_column_from_array(&lcol, left);
+  }
+  fixpoint_set_isa(best);
+
+  fixpoint_column_cleanup(&lcol);
+  fixpoint_column_cleanup(&rcol);
+  fixpoint_column_cleanup(&res);
+}
+
+TEST_CASE( test_format_hex_matches_ref ) {
+  fixpoint_str_t expected, actual;
+  uint64_t rng = TEST_RAND_SEED;
+
+  //every number of leading/trailing zero nibbles, then random values
+  for (int i = 0; i < 2000; i++) {
+    test_rand( &rng );
+    uint32_t whole = (uint32_t)(rng >> 32), frac = (uint32_t)rng;
+    if (i < 33 * 33) {
+      whole = (i / 33 == 32) ? 0 : whole >> (i / 33);
+      frac = (i % 33 == 32) ? 0 : frac << (i % 33);
+    }
+    fixpoint_t val;
+    TEST_FIXPOINT_INIT( &val, whole, frac, i & 1 );
+    fixpoint_ref_format_hex(&expected, &val);
+    fixpoint_format_hex(&actual, &val);
+    ASSERT( 0 == strcmp(expected.str, actual.str) );
+  }
+
+  //negative zero (e.g. from an overflow) keeps its sign
+  fixpoint_t neg_zero = objs->zero;
+  neg_zero.negative = true;
+  fixpoint_format_hex(&actual, &neg_zero);
+  ASSERT( 0 == strcmp("-0.0", actual.str) );
+}
+
+TEST_CASE( test_parse_hex_matches_ref ) {
+  static const char *strs[] = {
+    "", "-", ".", "-.", "0.", ".0", "-0.0", "--1.0", "1.0-", "1..0", "1.0.", " 1.0", "1.0 ",
+    "12345678.12345678", "123456789.1", "1.123456789", "-12345678.9abcdef0", "00000000.00000000",
+    "000000000.0", "fFfFfFfF.FfFfFfFf", "g.0", "0.g", "1.0\n", "+1.0", "0x1.0",
+  };
+  fixpoint_t expected, actual;
+
+  for (size_t i = 0; i < sizeof(strs) / sizeof(strs[0]); i++) {
+    fixpoint_str_t s = { { 0 } };
+    strcpy(s.str, strs[i]);
+    bool ok = fixpoint_ref_parse_hex(&expected, &s);
+    ASSERT( ok == fixpoint_parse_hex(&actual, &s) );
+    if (ok) {
+      TEST_EQUAL( &expected, &actual );
+    }
+  }
+
+  //random strings over an alphabet that makes well-formed ones likely
+  static const char alphabet[] = "0123456789abcdefABCDEF.-g ";
+  uint64_t rng = TEST_RAND_SEED;
+  for (int i = 0; i < 50000; i++) {
+    fixpoint_str_t s = { { 0 } };
+    test_rand( &rng );
+    int len = rng % 21;
+    for (int k = 0; k < len; k++) {
+      test_rand( &rng );
+      s.str[k] = (rng % 5 == 0) ? '.' : alphabet[(rng >> 8) % (sizeof(alphabet) - 1)];
+    }
+    bool ok = fixpoint_ref_parse_hex(&expected, &s);
+    ASSERT( ok == fixpoint_parse_hex(&actual, &s) );
+    if (ok) {
+      TEST_EQUAL( &expected, &actual );
+    }
+  }
+
+  //every formatted value parses back to itself
+  fixpoint_str_t s;
+  fixpoint_format_hex(&s, &objs->neg_ten_point_sevenfive);
+  ASSERT( fixpoint_parse_hex(&actual, &s) );
+  TEST_EQUAL( &objs->neg_ten_point_sevenfive, &actual );
+}
+
+TEST_CASE( test_parse_hex_buffer ) {
+  fixpoint_t vals[300];
+  size_t offset;
+
+  //last line doesn't need a newline
+  const char *text = "1.0\n-b.0\nffffffff.ffffffff\n0.8";
+  ASSERT( 4 == fixpoint_parse_hex_buffer(vals, 300, text, strlen(text), &offset) );
+  ASSERT( offset == strlen(text) );
+  TEST_EQUAL( &objs->one, &vals[0] );
+  TEST_EQUAL( &objs->neg_eleven, &vals[1] );
+  TEST_EQUAL( &objs->max, &vals[2] );
+  TEST_EQUAL( &objs->one_half, &vals[3] );
+
+  //malformed lines (including empty ones) stop parsing at their offset
+  text = "1.0\n\n0.8\n";
+  ASSERT( 1 == fixpoint_parse_hex_buffer(vals, 300, text, strlen(text), &offset) );
+  ASSERT( offset == 4 );
+  text = "-ffffffff.ffffffff\n1.0\n-ffffffff.ffffffff\n123456789.0\n-ffffffff.ffffffff\n";
+  ASSERT( 3 == fixpoint_parse_hex_buffer(vals, 300, text, strlen(text), &offset) );
+  ASSERT( offset == 42 );
+  text = "1.0\r\n";
+  ASSERT( 0 == fixpoint_parse_hex_buffer(vals, 300, text, strlen(text), &offset) );
+  ASSERT( offset == 0 );
+
+  //the buffer doesn't need a NUL terminator
+  text = "1.0\n0.8junk";
+  ASSERT( 2 == fixpoint_parse_hex_buffer(vals, 300, text, 7, &offset) );
+  ASSERT( offset == 7 );
+
+  //a NUL inside a line makes it malformed, whether the line is parsed
+  //in place or (near the end of the buffer) from a copy
+  fixpoint_isa_t best = fixpoint_get_isa();
+  for (int isa = FIXPOINT_ISA_SCALAR; isa <= FIXPOINT_ISA_AVX2; isa++) {
+    if (!fixpoint_set_isa(isa)) {
+      continue;
+    }
+    ASSERT( 0 == fixpoint_parse_hex_buffer(vals, 300, "1.0\0zz", 6, &offset) );
+    ASSERT( offset == 0 );
+    ASSERT( 1 == fixpoint_parse_hex_buffer(vals, 300, "1.0\n1.0\0zz", 10, &offset) );
+    ASSERT( offset == 4 );
+    text = "1.0\n1.0\0zz\nffffffff.ffffffff\nffffffff.ffffffff\nffffffff.ffffffff\n";
+    ASSERT( 1 == fixpoint_parse_hex_buffer(vals, 300, text, 11 + 3 * 18, &offset) );
+    ASSERT( offset == 4 );
+    text = "1.0\n1.0\0";
+    ASSERT( 1 == fixpoint_parse_hex_buffer(vals, 300, text, 8, &offset) );
+    ASSERT( offset == 4 );
+  }
+  ASSERT( fixpoint_set_isa(best) );
+
+  //stops when the array is full
+  text = "1.0\n0.8\n64.0\n";
+  ASSERT( 2 == fixpoint_parse_hex_buffer(vals, 2, text, strlen(text), &offset) );
+  ASSERT( offset == 8 );
+
+  //many lines of every length agree with fixpoint_parse_hex
+  static char big[300 * FIXPOINT_STR_MAX_SIZE];
+  fixpoint_t expected[300];
+  size_t len = 0;
+  uint64_t rng = TEST_RAND_SEED;
+  for (int i = 0; i < 300; i++) {
+    test_rand( &rng );
+    fixpoint_t val;
+    TEST_FIXPOINT_INIT( &val, (uint32_t)(rng >> 32) >> (rng % 32), (uint32_t)rng << (rng % 29), rng & 1 );
+    fixpoint_str_t s;
+    fixpoint_format_hex(&s, &val);
+    ASSERT( fixpoint_parse_hex(&expected[i], &s) );
+    strcpy(big + len, s.str);
+    len += strlen(s.str);
+    big[len++] = '\n';
+  }
+  ASSERT( 300 == fixpoint_parse_hex_buffer(vals, 300, big, len, &offset) );
+  ASSERT( offset == len );
+  for (int i = 0; i < 300; i++) {
+    TEST_EQUAL( &expected[i], &vals[i] );
+  }
+}
+
+TEST_CASE( test_parse_hex_file ) {
+  char filename[] = "/tmp/fixpoint_tests_XXXXXX";
+  int fd = mkstemp(filename);
+  ASSERT( fd >= 0 );
+  const char *text = "1.0\n-b.0\n0.8\nnot hex\n";
+  ASSERT( write(fd, text, strlen(text)) == (ssize_t)strlen(text) );
+  close(fd);
+
+  fixpoint_t vals[4];
+  size_t count, offset;
+  fixpoint_io_status_t status = fixpoint_parse_hex_file(filename, vals, 4, &count, &offset);
+  unlink(filename);
+  ASSERT( FIXPOINT_IO_MALFORMED == status );
+  ASSERT( count == 3 );
+  ASSERT( offset == 13 );
+  TEST_EQUAL( &objs->neg_eleven, &vals[1] );
+
+  ASSERT( FIXPOINT_IO_ERROR == fixpoint_parse_hex_file(filename, vals, 4, &count, &offset) );
+}
+
+TEST_CASE( test_parse_hex_isa ) {
+  (void) objs;
+  fixpoint_isa_t best = fixpoint_get_isa();
+  static const char alphabet[] = "0123456789abcdefABCDEF.-g \n";
+  fixpoint_t expected, actual;
+
+  for (int isa = FIXPOINT_ISA_SCALAR; isa <= FIXPOINT_ISA_AVX2; isa++) {
+    if (!fixpoint_set_isa(isa)) {
+      continue;
+    }
+
+    //random strings, with garbage after the terminator that
+    //the SIMD parsers read but must ignore
+    uint64_t rng = TEST_RAND_SEED;
+    for (int i = 0; i < 50000; i++) {
+      fixpoint_str_t s;
+      test_rand( &rng );
+      int len = rng % 21;
+      for (int k = 0; k < FIXPOINT_STR_MAX_SIZE; k++) {
+        test_rand( &rng );
+        s.str[k] = (rng % 5 == 0) ? '.' : alphabet[(rng >> 8) % (sizeof(alphabet) - 1)];
+      }
+      s.str[len] = '\0';
+      bool ok = fixpoint_ref_parse_hex(&expected, &s);
+      ASSERT( ok == fixpoint_parse_hex(&actual, &s) );
+      if (ok) {
+        TEST_EQUAL( &expected, &actual );
+      }
+    }
+
+    //every digit count, both signs
+    for (int w = 1; w <= 9; w++) {
+      for (int f = 1; f <= 9; f++) {
+        fixpoint_str_t s;
+        memset(s.str, 'a', sizeof(s.str));
+        int k = 0;
+        if ((w + f) & 1) {
+          s.str[k++] = '-';
+        }
+        for (int d = 0; d < w; d++) {
+          s.str[k++] = "123456789"[d];
+        }
+        s.str[k++] = '.';
+        for (int d = 0; d < f; d++) {
+          s.str[k++] = "fedcba987"[d];
+        }
+        s.str[k] = '\0';
+        bool ok = fixpoint_ref_parse_hex(&expected, &s);
+        ASSERT( ok == (w <= 8 && f <= 8) );
+        ASSERT( ok == fixpoint_parse_hex(&actual, &s) );
+        if (ok) {
+          TEST_EQUAL( &expected, &actual );
+        }
+      }
+    }
+
+    //a buffer of formatted values, long enough to use the in-place path
+    char buf[200 * FIXPOINT_STR_MAX_SIZE];
+    fixpoint_t vals[200], parsed[200];
+    size_t len = 0, offset;
+    for (int i = 0; i < 200; i++) {
+      fixpoint_str_t s;
+      test_rand( &rng );
+      fixpoint_init(&vals[i], (uint32_t)(rng >> 32) >> (rng % 32), (uint32_t)rng, rng & 1);
+      fixpoint_format_hex(&s, &vals[i]);
+      memcpy(buf + len, s.str, strlen(s.str));
+      len += strlen(s.str);
+      buf[len++] = '\n';
+    }
+    ASSERT( 200 == fixpoint_parse_hex_buffer(parsed, 200, buf, len, &offset) );
+    ASSERT( offset == len );
+    for (int i = 0; i < 200; i++) {
+      TEST_EQUAL( &vals[i], &parsed[i] );
+    }
+  }
+
+  ASSERT( fixpoint_set_isa(best) );
+}
+
+TEST_CASE( test_format_dec ) {
+  fixpoint_str_t s;
+
+  fixpoint_format_dec( &s, &objs->zero );
+  ASSERT( 0 == strcmp( "0.0", s.str ) );
+
+  fixpoint_format_dec( &s, &objs->one_half );
+  ASSERT( 0 == strcmp( "0.5", s.str ) );
+
+  fixpoint_format_dec( &s, &objs->neg_three_eighths );
+  ASSERT( 0 == strcmp( "-0.375", s.str ) );
+
+  fixpoint_format_dec( &s, &objs->one_hundred );
+  ASSERT( 0 == strcmp( "100.0", s.str ) );
+
+  fixpoint_format_dec( &s, &objs->neg_ten_and_quarter );
+  ASSERT( 0 == strcmp( "-10.25", s.str ) );
+
+  fixpoint_format_dec( &s, &objs->max );
+  ASSERT( 0 == strcmp( "4294967295.9999999998", s.str ) );
+
+  fixpoint_format_dec( &s, &objs->neg_min );
+  ASSERT( 0 == strcmp( "-0.0000000002", s.str ) );
+
+  //2^-11 = 0.00048828125 and 3 * 2^-11 = 0.00146484375 are halfway
+  //between two 10 digit values: ties round to even
+  fixpoint_t val;
+  TEST_FIXPOINT_INIT( &val, 0, 0x00200000, false );
+  fixpoint_format_dec( &s, &val );
+  ASSERT( 0 == strcmp( "0.0004882812", s.str ) );
+  TEST_FIXPOINT_INIT( &val, 0, 0x00600000, false );
+  fixpoint_format_dec( &s, &val );
+  ASSERT( 0 == strcmp( "0.0014648438", s.str ) );
+
+  //rounding carries through 9s (0.00089629995636...)
+  TEST_FIXPOINT_INIT( &val, 1234567890, 0x003ABD6B, false );
+  fixpoint_format_dec( &s, &val );
+  ASSERT( 0 == strcmp( "1234567890.0008963", s.str ) );
+}
+
+TEST_CASE( test_parse_dec ) {
+  fixpoint_str_t s;
+  fixpoint_t val;
+
+  strcpy( s.str, "0.5" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  TEST_EQUAL( &objs->one_half, &val );
+
+  strcpy( s.str, "-0.375" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  TEST_EQUAL( &objs->neg_three_eighths, &val );
+
+  strcpy( s.str, "-10.2500000000000000000000000000" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  TEST_EQUAL( &objs->neg_ten_and_quarter, &val );
+
+  strcpy( s.str, "4294967295.9999999998" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  TEST_EQUAL( &objs->max, &val );
+
+  //rounds up to 2^32
+  strcpy( s.str, "4294967295.9999999999" );
+  ASSERT( !fixpoint_parse_dec( &val, &s ) );
+
+  //rounds up into the whole part
+  strcpy( s.str, "6.9999999999" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  ASSERT( 7 == fixpoint_get_whole( &val ) );
+  ASSERT( 0 == fixpoint_get_frac( &val ) );
+
+  //exactly halfway values (2^-33 and 3 * 2^-33) round to even,
+  //anything past halfway rounds up
+  strcpy( s.str, "0.000000000116415321826934814453125" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  ASSERT( 0 == fixpoint_get_frac( &val ) );
+  strcpy( s.str, "0.0000000001164153218269348144531251" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  ASSERT( 1 == fixpoint_get_frac( &val ) );
+  strcpy( s.str, "0.000000000349245965480804443359375" );
+  ASSERT( fixpoint_parse_dec( &val, &s ) );
+  ASSERT( 2 == fixpoint_get_frac( &val ) );
+
+  static const char *invalid[] = {
+    "", "-", ".", "1.", ".5", "-.5", "1.5.", "+1.0", "1 .0", " 1.0", "1.0 ", "1.0\n",
+    "4294967296.0", "00000000001.0", "1.0x", "1e3.0", "1,5", "--1.0", "0x1.0", "a.0",
+  };
+  for ( size_t i = 0; i < sizeof( invalid ) / sizeof( invalid[0] ); i++ ) {
+    strcpy( s.str, invalid[i] );
+    ASSERT( !fixpoint_parse_dec( &val, &s ) );
+  }
+}
+
+TEST_CASE( test_dec_matches_ref ) {
+  (void) objs;
+  fixpoint_str_t expected, actual;
+  fixpoint_t expected_val, actual_val;
+  uint64_t rng = TEST_RAND_SEED;
+
+  //random values, some with few frac bits set: the fast versions
+  //match the reference ones, and parsing gives back the value
+  for (int i = 0; i < 20000; i++) {
+    test_rand( &rng );
+    uint32_t whole = (uint32_t)(rng >> 32) >> (i % 32);
+    uint32_t frac = (uint32_t)rng & ~((1u << (i % 31)) - 1);
+    fixpoint_t val;
+    TEST_FIXPOINT_INIT( &val, whole, frac, i & 1 );
+    fixpoint_ref_format_dec(&expected, &val);
+    fixpoint_format_dec(&actual, &val);
+    ASSERT( 0 == strcmp(expected.str, actual.str) );
+    ASSERT( fixpoint_parse_dec(&actual_val, &actual) );
+    TEST_EQUAL( &val, &actual_val );
+  }
+
+  //random strings over an alphabet that makes well-formed ones likely
+  static const char alphabet[] = "0123456789-";
+  for (int i = 0; i < 50000; i++) {
+    fixpoint_str_t s = { { 0 } };
+    test_rand( &rng );
+    int len = rng % (FIXPOINT_STR_MAX_SIZE - 1);
+    int dot = (rng >> 8) % 13;
+    for (int k = 0; k < len; k++) {
+      test_rand( &rng );
+      s.str[k] = (k == dot || rng % 41 == 0) ? '.' : alphabet[(rng >> 8) % (sizeof(alphabet) - 1)];
+    }
+    if (rng & 0x100) {
+      s.str[0] = '9';
+    }
+    bool ok = fixpoint_ref_parse_dec(&expected_val, &s);
+    ASSERT( ok == fixpoint_parse_dec(&actual_val, &s) );
+    if (ok) {
+      TEST_EQUAL( &expected_val, &actual_val );
+    }
+  }
+
+  //the batch versions match the scalar ones
+  fixpoint_t vals[64], parsed[64];
+  fixpoint_str_t strs[64];
+  bool ok[64];
+  for (int i = 0; i < 64; i++) {
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &vals[i], (uint32_t)(rng >> 32), (uint32_t)rng, rng & 1 );
+  }
+  fixpoint_format_dec_n(strs, vals, 64);
+  strcpy(strs[5].str, "5.");
+  ASSERT( 63 == fixpoint_parse_dec_n(parsed, strs, 64, ok) );
+  for (int i = 0; i < 64; i++) {
+    ASSERT( ok[i] == (i != 5) );
+    if (i != 5) {
+      fixpoint_format_dec(&expected, &vals[i]);
+      ASSERT( 0 == strcmp(expected.str, strs[i].str) );
+      TEST_EQUAL( &vals[i], &parsed[i] );
+    }
+  }
+  ASSERT( 63 == fixpoint_parse_dec_n(parsed, strs, 64, NULL) );
+}
+
+TEST_CASE( test_fma ) {
+  fixpoint_t result, product, expected;
+
+  //exact cases agree with mul then add
+  ASSERT( fixpoint_fma( &result, &objs->one_half, &objs->neg_eleven, &objs->one ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 4, 0x80000000, true );
+  TEST_EQUAL( &expected, &result );
+
+  ASSERT( fixpoint_fma( &result, &objs->neg_one, &objs->neg_two, &objs->neg_two ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( !fixpoint_is_negative( &result ) );
+
+  ASSERT( fixpoint_fma( &result, &objs->zero, &objs->neg_one, &objs->neg_three_eighths ) == RESULT_OK );
+  TEST_EQUAL( &objs->neg_three_eighths, &result );
+
+  //fixpoint_mul truncates min * 1.5 to min, so mul then add of
+  //-2 * min gives -min, but the exact sum is -min / 2, which
+  //truncates to (negative) 0
+  fixpoint_t neg_two_min, neg_zero;
+  TEST_FIXPOINT_INIT( &neg_two_min, 0, 2, true );
+  TEST_FIXPOINT_INIT( &neg_zero, 0, 0, true );
+  ASSERT( fixpoint_mul( &product, &objs->min, &objs->one_and_one_half ) == RESULT_UNDERFLOW );
+  ASSERT( fixpoint_add( &result, &product, &neg_two_min ) == RESULT_OK );
+  TEST_EQUAL( &objs->neg_min, &result );
+  ASSERT( fixpoint_fma( &result, &objs->min, &objs->one_and_one_half, &neg_two_min ) == RESULT_UNDERFLOW );
+  TEST_EQUAL( &neg_zero, &result );
+
+  //max * max overflows, even when a large addend is subtracted
+  ASSERT( fixpoint_fma( &result, &objs->max, &objs->max, &objs->neg_max ) & RESULT_OVERFLOW );
+  //max + max * min carries out of the whole part
+  ASSERT( fixpoint_fma( &result, &objs->max, &objs->min, &objs->max ) == (RESULT_OVERFLOW | RESULT_UNDERFLOW) );
+  //an overflowing product can be brought back in range by the addend
+  fixpoint_t big;
+  TEST_FIXPOINT_INIT( &big, 0x10000, 0, false );
+  ASSERT( fixpoint_mul( &product, &big, &big ) == RESULT_OVERFLOW );
+  ASSERT( fixpoint_fma( &result, &big, &big, &objs->neg_max ) == RESULT_OK );
+  TEST_EQUAL( &objs->min, &result );
+
+  //random values against 128 bit arithmetic (whole parts small
+  //enough that the exact sum fits in a signed __int128), and against
+  //mul then add when the product is exact
+  uint64_t rng = TEST_RAND_SEED;
+  for (int i = 0; i < 100000; i++) {
+    fixpoint_t a, b, c;
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &a, (uint32_t)(rng >> 34), (uint32_t)rng, rng & 1 );
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &b, (uint32_t)(rng >> 34) >> (i % 30), (uint32_t)rng, rng & 1 );
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &c, (uint32_t)(rng >> 32), (uint32_t)rng, rng & 1 );
+    if (i % 4 == 0) {
+      //make the product exact
+      a.frac &= 0xFFFF0000;
+      b.frac &= 0xFFFF0000;
+      a.whole >>= 16;
+      b.whole >>= 16;
+    }
+
+    __int128 prod = (__int128)(((uint64_t)a.whole << 32) | a.frac) * (((uint64_t)b.whole << 32) | b.frac);
+    __int128 add = (__int128)(((uint64_t)c.whole << 32) | c.frac) << 32;
+    __int128 sum = (a.negative ^ b.negative ? -prod : prod) + (c.negative ? -add : add);
+    unsigned __int128 mag = sum < 0 ? -(unsigned __int128)sum : (unsigned __int128)sum;
+    result_t ret = ((mag >> 96) != 0 ? RESULT_OVERFLOW : 0) | ((uint32_t)mag != 0 ? RESULT_UNDERFLOW : 0);
+    TEST_FIXPOINT_INIT( &expected, (uint32_t)(mag >> 64), (uint32_t)(mag >> 32), sum < 0 );
+
+    ASSERT( fixpoint_fma( &result, &a, &b, &c ) == ret );
+    TEST_EQUAL( &expected, &result );
+
+    if (fixpoint_mul( &product, &a, &b ) == RESULT_OK) {
+      fixpoint_t sum2;
+      ASSERT( fixpoint_add( &sum2, &product, &c ) == ret );
+      TEST_EQUAL( &sum2, &result );
+    }
+  }
+}
+
+TEST_CASE( test_sum_n ) {
+  fixpoint_t result, expected;
+
+  ASSERT( fixpoint_sum_n( &result, NULL, 0 ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+
+  fixpoint_t cancel[2] = { objs->ten_and_half, objs->neg_ten_and_half };
+  ASSERT( fixpoint_sum_n( &result, cancel, 2 ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( !fixpoint_is_negative( &result ) );
+
+  //max + max overflows when chained, but the exact sum is in range
+  fixpoint_t vals[3] = { objs->max, objs->max, objs->neg_max };
+  ASSERT( fixpoint_add( &result, &vals[0], &vals[1] ) == RESULT_OVERFLOW );
+  ASSERT( fixpoint_sum_n( &result, vals, 3 ) == RESULT_OK );
+  TEST_EQUAL( &objs->max, &result );
+  ASSERT( fixpoint_sum_n( &result, vals, 2 ) == RESULT_OVERFLOW );
+
+  //random values (odd and even n) against 128 bit arithmetic
+  uint64_t rng = TEST_RAND_SEED2;
+  fixpoint_t rand_vals[257];
+  for (size_t n = 0; n <= 257; n += 16 + n % 3) {
+    __int128 sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      test_rand( &rng );
+      //mostly small values with some large ones, so both
+      //outcomes occur
+      uint32_t whole = (uint32_t)(rng >> 32) >> (i % 4 == 0 ? 0 : 8);
+      TEST_FIXPOINT_INIT( &rand_vals[i], whole, (uint32_t)rng, rng & 1 );
+      __int128 mag = ((__int128)whole << 32) | (uint32_t)rng;
+      sum += (rng & 1) ? -mag : mag;
+    }
+    unsigned __int128 mag = sum < 0 ? -(unsigned __int128)sum : (unsigned __int128)sum;
+    TEST_FIXPOINT_INIT( &expected, (uint32_t)(mag >> 32), (uint32_t)mag, sum < 0 );
+    ASSERT( fixpoint_sum_n( &result, rand_vals, n ) == ((mag >> 64) != 0 ? RESULT_OVERFLOW : RESULT_OK) );
+    TEST_EQUAL( &expected, &result );
+  }
+}
+
+TEST_CASE( test_dot_n ) {
+  fixpoint_t result, expected;
+
+  ASSERT( fixpoint_dot_n( &result, NULL, NULL, 0 ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+
+  //1.5 * 100 + -11 * 0.5 + -9.5 * -1 = 154
+  fixpoint_t left[3] = { objs->one_and_one_half, objs->neg_eleven, objs->neg_nine_and_half };
+  fixpoint_t right[3] = { objs->one_hundred, objs->one_half, objs->neg_one };
+  ASSERT( fixpoint_dot_n( &result, left, right, 3 ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 154, 0, false );
+  TEST_EQUAL( &expected, &result );
+
+  //products that overflow (big * big) or underflow (min * 0.5)
+  //on their own cancel exactly
+  fixpoint_t big, neg_big;
+  TEST_FIXPOINT_INIT( &big, 0x10000, 0, false );
+  TEST_FIXPOINT_INIT( &neg_big, 0x10000, 0, true );
+  fixpoint_t big_left[4] = { big, big, objs->min, objs->min };
+  fixpoint_t big_right[4] = { big, neg_big, objs->one_half, objs->one_half };
+  ASSERT( fixpoint_dot_n( &result, big_left, big_right, 4 ) == RESULT_OK );
+  TEST_EQUAL( &objs->min, &result );
+  ASSERT( fixpoint_dot_n( &result, big_left, big_right, 1 ) == RESULT_OVERFLOW );
+  ASSERT( fixpoint_dot_n( &result, big_left + 2, big_right + 2, 1 ) == RESULT_UNDERFLOW );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( fixpoint_dot_n( &result, &objs->max, &objs->max, 1 ) == (RESULT_OVERFLOW | RESULT_UNDERFLOW) );
+
+  //a single product is the same as fixpoint_fma with a 0 addend
+  uint64_t rng = TEST_RAND_SEED;
+  for (int i = 0; i < 10000; i++) {
+    fixpoint_t a, b, fma_result;
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &a, (uint32_t)(rng >> 32) >> (i % 32), (uint32_t)rng, rng & 1 );
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &b, (uint32_t)(rng >> 32) >> (i % 29), (uint32_t)rng, rng & 1 );
+    ASSERT( fixpoint_dot_n( &result, &a, &b, 1 ) == fixpoint_fma( &fma_result, &a, &b, &objs->zero ) );
+    TEST_EQUAL( &fma_result, &result );
+  }
+
+  //random vectors against 128 bit arithmetic (whole parts small
+  //enough that the exact sum fits in a signed __int128)
+  fixpoint_t rand_left[101], rand_right[101];
+  for (size_t n = 1; n <= 101; n += 10) {
+    __int128 sum = 0;
+    for (size_t i = 0; i < n; i++) {
+      test_rand( &rng );
+      TEST_FIXPOINT_INIT( &rand_left[i], (uint32_t)(rng >> 32) >> 16, (uint32_t)rng, rng & 1 );
+      test_rand( &rng );
+      TEST_FIXPOINT_INIT( &rand_right[i], (uint32_t)(rng >> 32) >> (n % 32), (uint32_t)rng, (rng >> 1) & 1 );
+      __int128 prod = (__int128)(((uint64_t)rand_left[i].whole << 32) | rand_left[i].frac)
+                    * (((uint64_t)rand_right[i].whole << 32) | rand_right[i].frac);
+      sum += rand_left[i].negative ^ rand_right[i].negative ? -prod : prod;
+    }
+    unsigned __int128 mag = sum < 0 ? -(unsigned __int128)sum : (unsigned __int128)sum;
+    result_t ret = ((mag >> 96) != 0 ? RESULT_OVERFLOW : 0) | ((uint32_t)mag != 0 ? RESULT_UNDERFLOW : 0);
+    TEST_FIXPOINT_INIT( &expected, (uint32_t)(mag >> 64), (uint32_t)(mag >> 32), sum < 0 );
+    ASSERT( fixpoint_dot_n( &result, rand_left, rand_right, n ) == ret );
+    TEST_EQUAL( &expected, &result );
+  }
+}
+
+TEST_CASE( test_div ) {
+  fixpoint_t result, expected;
+
+  ASSERT( fixpoint_div( &result, &objs->one, &objs->neg_two ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 0, 0x80000000, true );
+  TEST_EQUAL( &expected, &result );
+
+  ASSERT( fixpoint_div( &result, &objs->neg_ten_and_half, &objs->neg_three_eighths ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 28, 0, false );
+  TEST_EQUAL( &expected, &result );
+
+  ASSERT( fixpoint_div( &result, &objs->zero, &objs->neg_eleven ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( !fixpoint_is_negative( &result ) );
+
+  //1/3 is truncated
+  fixpoint_t three;
+  TEST_FIXPOINT_INIT( &three, 3, 0, false );
+  ASSERT( fixpoint_div( &result, &objs->one, &three ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0, 0x55555555, false );
+  TEST_EQUAL( &expected, &result );
+
+  //min / 2 truncates to (negative) 0
+  ASSERT( fixpoint_div( &result, &objs->neg_min, &objs->neg_two ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0, 0, false );
+  TEST_EQUAL( &expected, &result );
+  ASSERT( fixpoint_div( &result, &objs->min, &objs->neg_two ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0, 0, true );
+  TEST_EQUAL( &expected, &result );
+
+  ASSERT( fixpoint_div( &result, &objs->max, &objs->one_half ) == RESULT_OVERFLOW );
+  ASSERT( fixpoint_div( &result, &objs->max, &objs->min ) == RESULT_OVERFLOW );
+  ASSERT( fixpoint_div( &result, &objs->max, &objs->one ) == RESULT_OK );
+  TEST_EQUAL( &objs->max, &result );
+
+  //divide by zero saturates
+  ASSERT( fixpoint_div( &result, &objs->neg_one, &objs->zero ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->neg_max, &result );
+  ASSERT( fixpoint_div( &result, &objs->zero, &objs->zero ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->max, &result );
+
+  //random values against 128 bit arithmetic
+  uint64_t rng = TEST_RAND_SEED;
+  for (int i = 0; i < 100000; i++) {
+    fixpoint_t a, b;
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &a, (uint32_t)(rng >> 32) >> (i % 32), (uint32_t)rng, rng & 1 );
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &b, (uint32_t)(rng >> 32) >> (i % 31), (uint32_t)rng >> (i % 29), rng & 1 );
+    if (b.whole == 0 && b.frac == 0) {
+      continue;
+    }
+
+    unsigned __int128 num = (unsigned __int128)(((uint64_t)a.whole << 32) | a.frac) << 32;
+    uint64_t den = ((uint64_t)b.whole << 32) | b.frac;
+    unsigned __int128 q = num / den;
+    result_t ret = ((q >> 64) != 0 ? RESULT_OVERFLOW : 0) | (num % den != 0 ? RESULT_UNDERFLOW : 0);
+    bool negative = (a.negative ^ b.negative) && (ret != RESULT_OK || (uint64_t)q != 0);
+    TEST_FIXPOINT_INIT( &expected, (uint32_t)(q >> 32), (uint32_t)q, negative );
+
+    ASSERT( fixpoint_div( &result, &a, &b ) == ret );
+    TEST_EQUAL( &expected, &result );
+  }
+}
+
+TEST_CASE( test_div_recip ) {
+  fixpoint_t result, expected;
+  fixpoint_recip_t recip;
+
+  fixpoint_recip_init( &recip, &objs->neg_three_eighths );
+  ASSERT( fixpoint_div_recip( &result, &objs->neg_ten_and_half, &recip ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 28, 0, false );
+  TEST_EQUAL( &expected, &result );
+
+  fixpoint_recip_init( &recip, &objs->zero );
+  ASSERT( fixpoint_div_recip( &result, &objs->neg_one, &recip ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->neg_max, &result );
+
+  //same results as fixpoint_div for random dividends and divisors
+  //(including powers of 2, min and max, which are edge cases for
+  //the normalization), one at a time and as an array
+  fixpoint_t divisors[64 + 4];
+  for (int i = 0; i < 64; i++) {
+    TEST_FIXPOINT_INIT( &divisors[i], i >= 32 ? 1u << (i - 32) : 0, i < 32 ? 1u << i : 0, i & 1 );
+  }
+  divisors[64] = objs->min;
+  divisors[65] = objs->max;
+  divisors[66] = objs->neg_max;
+  divisors[67] = objs->one_hundred;
+
+  uint64_t rng = TEST_RAND_SEED2;
+  fixpoint_t left[256], quot[256];
+  result_t flags[256];
+  for (int i = 0; i < 2000; i++) {
+    fixpoint_t divisor;
+    if (i < 68) {
+      divisor = divisors[i];
+    } else {
+      test_rand( &rng );
+      TEST_FIXPOINT_INIT( &divisor, (uint32_t)((rng >> 32) >> (i % 33)), (uint32_t)rng >> (i % 31), rng & 1 );
+    }
+    fixpoint_recip_init( &recip, &divisor );
+
+    for (int j = 0; j < 256; j++) {
+      test_rand( &rng );
+      TEST_FIXPOINT_INIT( &left[j], (uint32_t)(rng >> 32) >> (j % 32), (uint32_t)rng, rng & 1 );
+    }
+    result_t all = fixpoint_div_recip_n( quot, left, &recip, 256, flags );
+    result_t expected_all = RESULT_OK;
+    for (int j = 0; j < 256; j++) {
+      result_t ret = fixpoint_div( &expected, &left[j], &divisor );
+      expected_all |= ret;
+      ASSERT( flags[j] == ret );
+      TEST_EQUAL( &expected, &quot[j] );
+      ASSERT( fixpoint_div_recip( &result, &left[j], &recip ) == ret );
+      TEST_EQUAL( &expected, &result );
+    }
+    ASSERT( all == expected_all );
+    ASSERT( fixpoint_div_recip_n( quot, left, &recip, 256, NULL ) == expected_all );
+  }
+}
+
+TEST_CASE( test_sqrt ) {
+  fixpoint_t result, expected;
+
+  ASSERT( fixpoint_sqrt( &result, &objs->zero ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( fixpoint_sqrt( &result, &objs->one ) == RESULT_OK );
+  TEST_EQUAL( &objs->one, &result );
+  ASSERT( fixpoint_sqrt( &result, &objs->one_hundred ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 10, 0, false );
+  TEST_EQUAL( &expected, &result );
+
+  //sqrt(0.5) = 0.B504F333F9DE...
+  ASSERT( fixpoint_sqrt( &result, &objs->one_half ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0, 0xB504F333, false );
+  TEST_EQUAL( &expected, &result );
+  ASSERT( fixpoint_sqrt( &result, &objs->max ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0xFFFF, 0xFFFFFFFF, false );
+  TEST_EQUAL( &expected, &result );
+  ASSERT( fixpoint_sqrt( &result, &objs->min ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 0, 0x10000, false );
+  TEST_EQUAL( &expected, &result );
+
+  //negative zero is fine, negative values are not
+  fixpoint_t neg_zero;
+  TEST_FIXPOINT_INIT( &neg_zero, 0, 0, true );
+  ASSERT( fixpoint_sqrt( &result, &neg_zero ) == RESULT_OK );
+  ASSERT( result.whole == 0 && result.frac == 0 );
+  ASSERT( fixpoint_sqrt( &result, &objs->neg_min ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->zero, &result );
+
+  //random values against 128 bit arithmetic
+  uint64_t rng = TEST_RAND_SEED;
+  for (int i = 0; i < 100000; i++) {
+    fixpoint_t a;
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &a, (uint32_t)(rng >> 32) >> (i % 32), (uint32_t)rng >> (i % 29), false );
+
+    unsigned __int128 n = (unsigned __int128)(((uint64_t)a.whole << 32) | a.frac) << 32;
+    result_t ret = fixpoint_sqrt( &result, &a );
+    uint64_t r = ((uint64_t)result.whole << 32) | result.frac;
+    ASSERT( !fixpoint_is_negative( &result ) );
+    ASSERT( (unsigned __int128)r * r <= n );
+    ASSERT( (unsigned __int128)(r + 1) * (r + 1) > n );
+    ASSERT( ret == ((unsigned __int128)r * r == n ? RESULT_OK : RESULT_UNDERFLOW) );
+  }
+}
+
+// Check that a result of fixpoint_exp/log/sin/cos is within one unit
+// (2^-32) of the exact value (computed with long double) truncated
+// towards 0, plus a relative tolerance for exp
+static bool
+near_truncated( const fixpoint_t *result, long double exact, long double rel ) {
+  if ((exact < 0) != fixpoint_is_negative( result ) && floorl( fabsl( exact ) * 4294967296.0L ) != 0) {
+    return false;
+  }
+  long double expected = floorl( fabsl( exact ) * 4294967296.0L );
+  long double actual = result->whole * 4294967296.0L + result->frac;
+  return fabsl( actual - expected ) <= 1.0L + expected * rel;
+}
+
+TEST_CASE( test_exp_log_sin_cos ) {
+  fixpoint_t result, expected, neg_zero;
+  TEST_FIXPOINT_INIT( &neg_zero, 0, 0, true );
+
+  //exact cases
+  ASSERT( fixpoint_exp( &result, &objs->zero ) == RESULT_OK );
+  TEST_EQUAL( &objs->one, &result );
+  ASSERT( fixpoint_log( &result, &objs->one ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( fixpoint_sin( &result, &objs->zero ) == RESULT_OK );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( fixpoint_cos( &result, &neg_zero ) == RESULT_OK );
+  TEST_EQUAL( &objs->one, &result );
+
+  //e = 2.B7E151628AED2A6A...
+  ASSERT( fixpoint_exp( &result, &objs->one ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 2, 0xB7E15162, false );
+  TEST_EQUAL( &expected, &result );
+  //ln(0.5) = -0.B17217F7D1CF79AB...
+  ASSERT( fixpoint_log( &result, &objs->one_half ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0, 0xB17217F7, true );
+  TEST_EQUAL( &expected, &result );
+
+  //out of range
+  ASSERT( fixpoint_exp( &result, &objs->one_hundred ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->max, &result );
+  ASSERT( fixpoint_exp( &result, &objs->neg_max ) == RESULT_UNDERFLOW );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( fixpoint_log( &result, &objs->zero ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->neg_max, &result );
+  ASSERT( fixpoint_log( &result, &objs->neg_one ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->neg_max, &result );
+
+  //random values against long double
+  uint64_t rng = TEST_RAND_SEED2;
+  for (int i = 0; i < 100000; i++) {
+    fixpoint_t a, b;
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &a, (uint32_t)((rng >> 32) >> (i % 32 + 1)), (uint32_t)rng, rng & 1 );
+    long double x = (a.whole * 4294967296.0L + a.frac) / 4294967296.0L;
+    if (a.negative) {
+      x = -x;
+    }
+
+    if (a.whole == 0 && a.frac == 0) {
+      continue;
+    }
+    ASSERT( fixpoint_sin( &result, &a ) == RESULT_UNDERFLOW );
+    ASSERT( near_truncated( &result, sinl( x ), 0.0L ) );
+    ASSERT( fixpoint_cos( &result, &a ) == RESULT_UNDERFLOW );
+    ASSERT( near_truncated( &result, cosl( x ), 0.0L ) );
+
+    //exp for |x| < 22 (larger values overflow or underflow)
+    TEST_FIXPOINT_INIT( &b, a.whole % 22, a.frac, a.negative );
+    long double y = (b.whole * 4294967296.0L + b.frac) / 4294967296.0L;
+    if (b.negative) {
+      y = -y;
+    }
+    ASSERT( fixpoint_exp( &result, &b ) == (b.whole == 0 && b.frac == 0 ? RESULT_OK : RESULT_UNDERFLOW) );
+    ASSERT( near_truncated( &result, expl( y ), 0x1p-57L ) );
+
+    //log of |x|
+    a.negative = false;
+    result_t ret = fixpoint_log( &result, &a );
+    ASSERT( ret == (x == 1.0L ? RESULT_OK : RESULT_UNDERFLOW) );
+    ASSERT( near_truncated( &result, logl( fabsl( x ) ), 0.0L ) );
+  }
+}
+
+TEST_CASE( test_inline ) {
+  fixpoint_t val;
+  fixpoint_inline_init( &val, 0x1234, 0x5678, true );
+  ASSERT( fixpoint_inline_get_whole( &val ) == 0x1234 );
+  ASSERT( fixpoint_inline_get_frac( &val ) == 0x5678 );
+  ASSERT( fixpoint_inline_is_negative( &val ) );
+  fixpoint_inline_negate( &val );
+  ASSERT( !fixpoint_inline_is_negative( &val ) );
+  fixpoint_inline_negate( &val );
+  ASSERT( fixpoint_inline_is_negative( &val ) );
+  val = objs->zero;
+  fixpoint_inline_negate( &val );
+  ASSERT( !fixpoint_inline_is_negative( &val ) );
+
+  //same results as the out-of-line functions, including the edge
+  //cases for overflow and the sign of 0
+  uint64_t rng = TEST_RAND_SEED;
+  for (int i = 0; i < 100000; i++) {
+    fixpoint_t a, b, expected, result;
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &a, (uint32_t)((rng >> 32) >> (i % 33)), (uint32_t)rng, rng & 1 );
+    test_rand( &rng );
+    if (i % 8 == 0) {
+      b = a;
+    } else if (i % 8 == 1) {
+      b = objs->max;
+    } else {
+      TEST_FIXPOINT_INIT( &b, (uint32_t)(rng >> 32) >> (i % 31), (uint32_t)rng >> (i % 29), rng & 1 );
+    }
+    if ((i / 8) % 2 == 0) {
+      b.negative = !b.negative;
+    }
+
+    ASSERT( fixpoint_inline_add( &result, &a, &b ) == fixpoint_add( &expected, &a, &b ) );
+    TEST_EQUAL( &expected, &result );
+    ASSERT( fixpoint_inline_sub( &result, &a, &b ) == fixpoint_sub( &expected, &a, &b ) );
+    TEST_EQUAL( &expected, &result );
+    ASSERT( fixpoint_inline_mul( &result, &a, &b ) == fixpoint_mul( &expected, &a, &b ) );
+    TEST_EQUAL( &expected, &result );
+    ASSERT( fixpoint_inline_compare( &a, &b ) == fixpoint_compare( &a, &b ) );
+
+    result = a;
+    expected = a;
+    fixpoint_inline_negate( &result );
+    fixpoint_negate( &expected );
+    TEST_EQUAL( &expected, &result );
+  }
+}
+
+// Check a Qm.n operation against the same fixpoint_t operation on
+// the converted operands: the flags of the fixpoint_t operation and
+// the conversion back must add up to those of the Qm.n operation
+#define TEST_Q_OP( name, op, a, b ) \
+do { \
+  fixpoint_##name##_t q_result, converted; \
+  fixpoint_t fa, fb, f_result; \
+  ASSERT( fixpoint_##name##_to_fixpoint( &fa, a ) == RESULT_OK ); \
+  ASSERT( fixpoint_##name##_to_fixpoint( &fb, b ) == RESULT_OK ); \
+  result_t ret = fixpoint_##op( &f_result, &fa, &fb ); \
+  ret |= fixpoint_##name##_from_fixpoint( &converted, &f_result ); \
+  ASSERT( fixpoint_##name##_##op( &q_result, a, b ) == ret ); \
+  ASSERT( q_result.raw == converted.raw ); \
+} while ( 0 )
+
+// Check a Qm.n format (with at most 32 fractional bits, so values
+// convert exactly) on random values against fixpoint_t (raw is
+// shifted right by a varying amount so all magnitudes are tested)
+#define TEST_Q_FORMAT( name, word_t, uword_t, word_bits ) \
+do { \
+  uint64_t rng = TEST_RAND_SEED; \
+  for (int i = 0; i < 100000; i++) { \
+    test_rand( &rng ); \
+    fixpoint_##name##_t a = fixpoint_##name##_from_raw( (word_t)(uword_t)rng >> (i % (word_bits)) ); \
+    test_rand( &rng ); \
+    fixpoint_##name##_t b = fixpoint_##name##_from_raw( (word_t)(uword_t)rng >> ((i / 7) % (word_bits)) ); \
+    TEST_Q_OP( name, add, a, b ); \
+    TEST_Q_OP( name, sub, a, b ); \
+    TEST_Q_OP( name, mul, a, b ); \
+    fixpoint_t fa, fb; \
+    fixpoint_##name##_to_fixpoint( &fa, a ); \
+    fixpoint_##name##_to_fixpoint( &fb, b ); \
+    ASSERT( fixpoint_##name##_compare( a, b ) == fixpoint_compare( &fa, &fb ) ); \
+    fixpoint_str_t q_str, f_str; \
+    fixpoint_##name##_format_hex( &q_str, a ); \
+    fixpoint_format_hex( &f_str, &fa ); \
+    ASSERT( 0 == strcmp( q_str.str, f_str.str ) ); \
+  } \
+} while ( 0 )
+
+TEST_CASE( test_q_formats ) {
+  fixpoint_str_t s;
+  fixpoint_t val, expected;
+
+  //-1.5 in Q8.24
+  fixpoint_q8_24_t q = fixpoint_q8_24_from_raw( -(3 << 23) );
+  fixpoint_q8_24_format_hex( &s, q );
+  ASSERT( 0 == strcmp( "-1.8", s.str ) );
+  ASSERT( fixpoint_q8_24_to_fixpoint( &val, q ) == RESULT_OK );
+  TEST_FIXPOINT_INIT( &expected, 1, 0x80000000, true );
+  TEST_EQUAL( &expected, &val );
+
+  //limits of Q16.16
+  fixpoint_q16_16_format_hex( &s, fixpoint_q16_16_from_raw( INT32_MAX ) );
+  ASSERT( 0 == strcmp( "7fff.ffff", s.str ) );
+  fixpoint_q16_16_format_hex( &s, fixpoint_q16_16_from_raw( INT32_MIN ) );
+  ASSERT( 0 == strcmp( "-8000.0", s.str ) );
+  fixpoint_q16_16_t q16;
+  ASSERT( fixpoint_q16_16_from_fixpoint( &q16, &objs->max ) == (RESULT_OVERFLOW | RESULT_UNDERFLOW) );
+  ASSERT( fixpoint_q16_16_from_fixpoint( &q16, &objs->min ) == RESULT_UNDERFLOW );
+  ASSERT( q16.raw == 0 );
+  TEST_FIXPOINT_INIT( &val, 0x8000, 0, true );
+  ASSERT( fixpoint_q16_16_from_fixpoint( &q16, &val ) == RESULT_OK );
+  ASSERT( q16.raw == INT32_MIN );
+  val.negative = false;
+  ASSERT( fixpoint_q16_16_from_fixpoint( &q16, &val ) == RESULT_OVERFLOW );
+
+  //Q8.8: 0.5 * -0.00390625 truncates to 0 (never negative)
+  fixpoint_q8_8_t q8;
+  ASSERT( fixpoint_q8_8_mul( &q8, fixpoint_q8_8_from_raw( 128 ), fixpoint_q8_8_from_raw( -1 ) ) == RESULT_UNDERFLOW );
+  ASSERT( q8.raw == 0 );
+  ASSERT( fixpoint_q8_8_add( &q8, fixpoint_q8_8_from_raw( INT16_MAX ), fixpoint_q8_8_from_raw( 1 ) ) == RESULT_OVERFLOW );
+  ASSERT( q8.raw == INT16_MIN );
+
+  TEST_Q_FORMAT( q8_8, int16_t, uint16_t, 16 );
+  TEST_Q_FORMAT( q16_16, int32_t, uint32_t, 32 );
+  TEST_Q_FORMAT( q8_24, int32_t, uint32_t, 32 );
+  TEST_Q_FORMAT( q32_32, int64_t, uint64_t, 64 );
+}
+
+TEST_CASE( test_saturating ) {
+  fixpoint_t result;
+
+  ASSERT( fixpoint_add_sat( &result, &objs->max, &objs->min ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->max, &result );
+  ASSERT( fixpoint_sub_sat( &result, &objs->neg_max, &objs->one ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->neg_max, &result );
+  ASSERT( fixpoint_sub_sat( &result, &objs->max, &objs->neg_max ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->max, &result );
+  ASSERT( fixpoint_mul_sat( &result, &objs->neg_max, &objs->neg_two ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->max, &result );
+  ASSERT( fixpoint_mul_sat( &result, &objs->max, &objs->neg_two ) == RESULT_OVERFLOW );
+  TEST_EQUAL( &objs->neg_max, &result );
+  //overflow and underflow, clamped all the same
+  ASSERT( fixpoint_mul_sat( &result, &objs->max, &objs->max ) == (RESULT_OVERFLOW | RESULT_UNDERFLOW) );
+  TEST_EQUAL( &objs->max, &result );
+
+  //otherwise the same as the wrapping versions, one at a time and
+  //as arrays
+  fixpoint_t left[256], right[256], sat[256], expected[256];
+  result_t flags[256];
+  uint64_t rng = TEST_RAND_SEED;
+  for (int pass = 0; pass < 200; pass++) {
+    for (int i = 0; i < 256; i++) {
+      test_rand( &rng );
+      TEST_FIXPOINT_INIT( &left[i], (uint32_t)(rng >> 32) >> (i % 32), (uint32_t)rng, rng & 1 );
+      test_rand( &rng );
+      TEST_FIXPOINT_INIT( &right[i], (uint32_t)(rng >> 32) >> (pass % 32), (uint32_t)rng, rng & 1 );
+    }
+    typedef result_t (*op_fn)( fixpoint_t *, const fixpoint_t *, const fixpoint_t * );
+    typedef result_t (*op_n_fn)( fixpoint_t *, const fixpoint_t *, const fixpoint_t *, size_t, result_t * );
+    op_fn ops[] = { fixpoint_add, fixpoint_sub, fixpoint_mul };
+    op_fn sat_ops[] = { fixpoint_add_sat, fixpoint_sub_sat, fixpoint_mul_sat };
+    op_n_fn sat_n_ops[] = { fixpoint_add_sat_n, fixpoint_sub_sat_n, fixpoint_mul_sat_n };
+    for (int op = 0; op < 3; op++) {
+      result_t all = sat_n_ops[op]( sat, left, right, 256, flags );
+      result_t expected_all = RESULT_OK;
+      for (int i = 0; i < 256; i++) {
+        result_t ret = ops[op]( &expected[i], &left[i], &right[i] );
+        expected_all |= ret;
+        if (ret & RESULT_OVERFLOW) {
+          expected[i].whole = expected[i].frac = 0xFFFFFFFF;
+        }
+        ASSERT( flags[i] == ret );
+        TEST_EQUAL( &expected[i], &sat[i] );
+        ASSERT( sat_ops[op]( &result, &left[i], &right[i] ) == ret );
+        TEST_EQUAL( &expected[i], &result );
+      }
+      ASSERT( all == expected_all );
+      ASSERT( sat_n_ops[op]( sat, left, right, 256, NULL ) == expected_all );
+    }
+  }
+}
+
+TEST_CASE( test_mul_rounding ) {
+  fixpoint_t result, expected;
+
+  //2^-32 * 0.5 is a tie, rounded to 0 (even) but still inexact
+  ASSERT( fixpoint_mul_rne( &result, &objs->min, &objs->one_half ) == RESULT_UNDERFLOW );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( fixpoint_mul_rne( &result, &objs->neg_min, &objs->one_half ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0, 0, true );
+  TEST_EQUAL( &expected, &result );
+  //2^-32 * 1.5 is a tie, rounded to 2^-31 (even)
+  ASSERT( fixpoint_mul_rne( &result, &objs->min, &objs->one_and_one_half ) == RESULT_UNDERFLOW );
+  TEST_FIXPOINT_INIT( &expected, 0, 2, false );
+  TEST_EQUAL( &expected, &result );
+  //rounding up can overflow
+  fixpoint_t almost_two;
+  TEST_FIXPOINT_INIT( &almost_two, 1, 0xFFFFFFFF, false );
+  ASSERT( fixpoint_mul_rne( &result, &objs->max, &almost_two ) == (RESULT_OVERFLOW | RESULT_UNDERFLOW) );
+  ASSERT( fixpoint_mul_rne( &result, &objs->one, &objs->max ) == RESULT_OK );
+  TEST_EQUAL( &objs->max, &result );
+
+  //stochastic rounding with 0 truncates, with all 1s rounds up any
+  //inexact product
+  ASSERT( fixpoint_mul_stochastic( &result, &objs->min, &objs->one_half, 0 ) == RESULT_UNDERFLOW );
+  TEST_EQUAL( &objs->zero, &result );
+  ASSERT( fixpoint_mul_stochastic( &result, &objs->min, &objs->one_half, 0xFFFFFFFF ) == RESULT_UNDERFLOW );
+  TEST_EQUAL( &objs->min, &result );
+  ASSERT( fixpoint_mul_stochastic( &result, &objs->one_half, &objs->neg_two, 0xFFFFFFFF ) == RESULT_OK );
+  TEST_EQUAL( &objs->neg_one, &result );
+
+  //random values against 128 bit arithmetic, one at a time and as
+  //arrays
+  fixpoint_t left[256], right[256], rounded[256];
+  result_t flags[256];
+  uint64_t rng = TEST_RAND_SEED2;
+  for (int pass = 0; pass < 200; pass++) {
+    for (int i = 0; i < 256; i++) {
+      test_rand( &rng );
+      TEST_FIXPOINT_INIT( &left[i], (uint32_t)(rng >> 32) >> (i % 32), (uint32_t)rng, rng & 1 );
+      test_rand( &rng );
+      //some products are ties
+      TEST_FIXPOINT_INIT( &right[i], (uint32_t)(rng >> 32) >> (pass % 32),
+                          i % 4 ? (uint32_t)rng : (uint32_t)rng & 0x80000000, rng & 1 );
+    }
+    result_t all = fixpoint_mul_rne_n( rounded, left, right, 256, flags );
+    result_t expected_all = RESULT_OK;
+    for (int i = 0; i < 256; i++) {
+      unsigned __int128 p = (unsigned __int128)(((uint64_t)left[i].whole << 32) | left[i].frac)
+                          * (((uint64_t)right[i].whole << 32) | right[i].frac);
+      uint32_t low = (uint32_t)p;
+      unsigned __int128 q = p >> 32;
+      q += low > 0x80000000 || (low == 0x80000000 && (q & 1));
+      result_t ret = ((q >> 64) != 0 ? RESULT_OVERFLOW : 0) | (low != 0 ? RESULT_UNDERFLOW : 0);
+      bool negative = (left[i].negative ^ right[i].negative) && (ret != RESULT_OK || (uint64_t)q != 0);
+      TEST_FIXPOINT_INIT( &expected, (uint32_t)(q >> 32), (uint32_t)q, negative );
+      expected_all |= ret;
+
+      ASSERT( flags[i] == ret );
+      TEST_EQUAL( &expected, &rounded[i] );
+      ASSERT( fixpoint_mul_rne( &result, &left[i], &right[i] ) == ret );
+      TEST_EQUAL( &expected, &result );
+
+      //stochastic rounding gives the truncated or the rounded up product
+      test_rand( &rng );
+      uint32_t random = (uint32_t)rng;
+      q = (p >> 32) + ((uint64_t)low + random > 0xFFFFFFFF);
+      ret = ((q >> 64) != 0 ? RESULT_OVERFLOW : 0) | (low != 0 ? RESULT_UNDERFLOW : 0);
+      negative = (left[i].negative ^ right[i].negative) && (ret != RESULT_OK || (uint64_t)q != 0);
+      TEST_FIXPOINT_INIT( &expected, (uint32_t)(q >> 32), (uint32_t)q, negative );
+      ASSERT( fixpoint_mul_stochastic( &result, &left[i], &right[i], random ) == ret );
+      TEST_EQUAL( &expected, &result );
+    }
+    ASSERT( all == expected_all );
+  }
+
+  //stochastic rounding of 2^-32 * 0.25 rounds up a quarter of the
+  //time, and the array version continues its sequence from the seed
+  fixpoint_t quarter, mins[1000], quarters[1000], products[1000], again[1000];
+  result_t again_flags[1000];
+  TEST_FIXPOINT_INIT( &quarter, 0, 0x40000000, false );
+  for (int i = 0; i < 1000; i++) {
+    mins[i] = objs->min;
+    quarters[i] = quarter;
+  }
+  uint64_t seed = 1, seed_again = 1;
+  int up = 0;
+  for (int pass = 0; pass < 10; pass++) {
+    ASSERT( fixpoint_mul_stochastic_n( products, mins, quarters, 1000, &seed, NULL ) == RESULT_UNDERFLOW );
+    for (int i = 0; i < 1000; i++) {
+      ASSERT( products[i].whole == 0 && products[i].frac <= 1 );
+      up += products[i].frac;
+    }
+  }
+  ASSERT( up > 2300 && up < 2700 );
+  for (int pass = 0; pass < 10; pass++) {
+    fixpoint_mul_stochastic_n( again, mins, quarters, 1000, &seed_again, again_flags );
+  }
+  ASSERT( seed == seed_again );
+  for (int i = 0; i < 1000; i++) {
+    TEST_EQUAL( &products[i], &again[i] );
+    ASSERT( again_flags[i] == RESULT_UNDERFLOW );
+  }
+}
+
+TEST_CASE( test_packed ) {
+  //more than two sign words and not a multiple of 64
+  enum { N = 150 };
+  fixpoint_t vals[N], out[N], val;
+  uint64_t rng = TEST_RAND_SEED;
+  size_t bad;
+
+  for (int i = 0; i < N; i++) {
+    //xorshift64, with some 0s
+    test_rand( &rng );
+    if (i % 7 == 0) {
+      TEST_FIXPOINT_INIT( &vals[i], 0, 0, false );
+    } else {
+      TEST_FIXPOINT_INIT( &vals[i], (uint32_t)((rng >> 32) >> (i % 33)), (uint32_t)rng, rng & 1 );
+    }
+  }
+  vals[1] = objs->max;
+  vals[2] = objs->neg_max;
+  vals[3] = objs->neg_min;
+
+  fixpoint_packed_t packed;
+  ASSERT( fixpoint_packed_init(&packed, N) );
+
+  //round trip
+  ASSERT( fixpoint_pack(&packed, vals) );
+  ASSERT( fixpoint_packed_validate(&packed, NULL) );
+  fixpoint_unpack(out, &packed);
+  for (int i = 0; i < N; i++) {
+    TEST_EQUAL( &vals[i], &out[i] );
+    fixpoint_packed_get(&val, &packed, i);
+    TEST_EQUAL( &vals[i], &val );
+  }
+  ASSERT( packed.mag[2] == UINT64_MAX && (packed.sign[0] & 4) );
+
+  //set and get, including across sign words
+  fixpoint_packed_set(&packed, 64, &objs->neg_one);
+  fixpoint_packed_get(&val, &packed, 64);
+  TEST_EQUAL( &objs->neg_one, &val );
+  fixpoint_packed_set(&packed, 64, &objs->one);
+  fixpoint_packed_get(&val, &packed, 64);
+  TEST_EQUAL( &objs->one, &val );
+
+  //a negative 0 is stored as 0, and reported by fixpoint_pack
+  fixpoint_t neg_zero;
+  TEST_FIXPOINT_INIT( &neg_zero, 0, 0, true );
+  fixpoint_packed_set(&packed, 65, &neg_zero);
+  fixpoint_packed_get(&val, &packed, 65);
+  TEST_EQUAL( &objs->zero, &val );
+  vals[100] = neg_zero;
+  ASSERT( !fixpoint_pack(&packed, vals) );
+  ASSERT( fixpoint_packed_validate(&packed, NULL) );
+  fixpoint_unpack(out, &packed);
+  TEST_EQUAL( &objs->zero, &out[100] );
+
+  //invalid sign bits are found, and ignored when unpacking
+  packed.sign[100 / 64] |= (uint64_t)1 << (100 % 64);
+  ASSERT( !fixpoint_packed_validate(&packed, &bad) );
+  ASSERT( bad == 100 );
+  fixpoint_unpack(out, &packed);
+  TEST_EQUAL( &objs->zero, &out[100] );
+  fixpoint_packed_get(&val, &packed, 100);
+  TEST_EQUAL( &objs->zero, &val );
+  packed.sign[100 / 64] &= ~((uint64_t)1 << (100 % 64));
+  packed.sign[N / 64] |= (uint64_t)1 << 63;
+  ASSERT( !fixpoint_packed_validate(&packed, &bad) );
+  ASSERT( bad == N );
+  fixpoint_packed_cleanup(&packed);
+
+  //empty
+  ASSERT( fixpoint_packed_init(&packed, 0) );
+  ASSERT( fixpoint_pack(&packed, vals) );
+  ASSERT( fixpoint_packed_validate(&packed, NULL) );
+  fixpoint_packed_cleanup(&packed);
+}
+
+TEST_CASE( test_binary_file ) {
+  enum { N = 200 };
+  fixpoint_t vals[N], out[N];
+  uint64_t rng = TEST_RAND_SEED2;
+  for (int i = 0; i < N; i++) {
+    test_rand( &rng );
+    TEST_FIXPOINT_INIT( &vals[i], (uint32_t)((rng >> 32) >> (i % 33)), (uint32_t)rng, rng & 1 );
+  }
+  vals[0] = objs->zero;
+  vals[1] = objs->neg_max;
+
+  char filename[] = "/tmp/fixpoint_tests_XXXXXX";
+  int fd = mkstemp(filename);
+  ASSERT( fd >= 0 );
+  close(fd);
+
+  fixpoint_packed_t packed;
+  fixpoint_binary_file_t file;
+  ASSERT( fixpoint_packed_init(&packed, N) );
+  fixpoint_pack(&packed, vals);
+
+  //round trip, with and without a checksum
+  for (int checksum = 0; checksum <= 1; checksum++) {
+    ASSERT( FIXPOINT_IO_OK == fixpoint_write_binary_file(filename, &packed, checksum) );
+    for (int verify = 0; verify <= 1; verify++) {
+      ASSERT( FIXPOINT_IO_OK == fixpoint_map_binary_file(&file, filename, verify) );
+      ASSERT( file.packed.size == N );
+      ASSERT( file.map_len == sizeof(fixpoint_binary_header_t) + (N + N / 64 + 1) * 8 );
+      fixpoint_unpack(out, &file.packed);
+      for (int i = 0; i < N; i++) {
+        TEST_EQUAL( &vals[i], &out[i] );
+      }
+      fixpoint_unmap_binary_file(&file);
+      ASSERT( file.map == NULL );
+    }
+  }
+
+  //corrupted data is only found when verifying (the file has a
+  //checksum from the last iteration above)
+  fixpoint_binary_header_t header;
+  fd = open(filename, O_RDWR);
+  ASSERT( fd >= 0 );
+  ASSERT( pread(fd, &header, sizeof(header), 0) == sizeof(header) );
+  ASSERT( header.version == FIXPOINT_BINARY_VERSION );
+  ASSERT( header.flags == FIXPOINT_BINARY_CHECKSUM );
+  uint64_t mag = 12345;
+  ASSERT( pwrite(fd, &mag, sizeof(mag), sizeof(header) + 5 * 8) == sizeof(mag) );
+  ASSERT( FIXPOINT_IO_OK == fixpoint_map_binary_file(&file, filename, false) );
+  ASSERT( file.packed.mag[5] == 12345 );
+  fixpoint_unmap_binary_file(&file);
+  ASSERT( FIXPOINT_IO_MALFORMED == fixpoint_map_binary_file(&file, filename, true) );
+
+  //so is a negative 0 without a checksum
+  fixpoint_packed_set(&packed, 3, &objs->zero);
+  packed.sign[0] |= 8;
+  close(fd);
+  ASSERT( FIXPOINT_IO_OK == fixpoint_write_binary_file(filename, &packed, false) );
+  ASSERT( FIXPOINT_IO_OK == fixpoint_map_binary_file(&file, filename, false) );
+  fixpoint_unmap_binary_file(&file);
+  ASSERT( FIXPOINT_IO_MALFORMED == fixpoint_map_binary_file(&file, filename, true) );
+
+  //bad headers
+  fd = open(filename, O_RDWR);
+  ASSERT( fd >= 0 );
+  fixpoint_binary_header_t bad = header;
+  bad.version = FIXPOINT_BINARY_VERSION + 1;
+  ASSERT( pwrite(fd, &bad, sizeof(bad), 0) == sizeof(bad) );
+  ASSERT( FIXPOINT_IO_UNSUPPORTED == fixpoint_map_binary_file(&file, filename, false) );
+  bad = header;
+  bad.endian = 0x04030201;
+  ASSERT( pwrite(fd, &bad, sizeof(bad), 0) == sizeof(bad) );
+  ASSERT( FIXPOINT_IO_UNSUPPORTED == fixpoint_map_binary_file(&file, filename, false) );
+  bad = header;
+  bad.count = N + 1;
+  ASSERT( pwrite(fd, &bad, sizeof(bad), 0) == sizeof(bad) );
+  ASSERT( FIXPOINT_IO_MALFORMED == fixpoint_map_binary_file(&file, filename, false) );
+  bad = header;
+  bad.magic[0] = 'X';
+  ASSERT( pwrite(fd, &bad, sizeof(bad), 0) == sizeof(bad) );
+  ASSERT( FIXPOINT_IO_MALFORMED == fixpoint_map_binary_file(&file, filename, false) );
+  ASSERT( ftruncate(fd, 10) == 0 );
+  ASSERT( FIXPOINT_IO_MALFORMED == fixpoint_map_binary_file(&file, filename, false) );
+  close(fd);
+  fixpoint_packed_cleanup(&packed);
+
+  //no values
+  ASSERT( fixpoint_packed_init(&packed, 0) );
+  ASSERT( FIXPOINT_IO_OK == fixpoint_write_binary_file(filename, &packed, true) );
+  ASSERT( FIXPOINT_IO_OK == fixpoint_map_binary_file(&file, filename, true) );
+  ASSERT( file.packed.size == 0 );
+  fixpoint_unmap_binary_file(&file);
+  fixpoint_packed_cleanup(&packed);
+
+  unlink(filename);
+  ASSERT( FIXPOINT_IO_ERROR == fixpoint_map_binary_file(&file, filename, false) );
+}
+
+// qsort comparator for the reference sort in test_sort
+static int
+compare_for_qsort( const void *left, const void *right ) {
+  return fixpoint_compare( left, right );
+}
+
+TEST_CASE( test_sort ) {
+  (void) objs;
+  enum { N = 5000 };
+  static fixpoint_t vals[N], expected[N];
+  const size_t sizes[] = { 0, 1, 2, 17, 255, 767, 768, N };
+  uint64_t rng = TEST_RAND_SEED;
+
+  //kinds of input: random, few distinct values (with 0s and negative
+  //0s), small magnitudes (most radix passes skipped), all negative,
+  //sorted, reverse sorted
+  for (int kind = 0; kind < 6; kind++) {
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+      size_t n = sizes[s];
+      for (size_t i = 0; i < n; i++) {
+        test_rand( &rng );
+        switch (kind) {
+        case 1:
+          TEST_FIXPOINT_INIT( &vals[i], (uint32_t)(rng % 3), 0, (rng >> 8) & 1 );
+          break;
+        case 2:
+          TEST_FIXPOINT_INIT( &vals[i], 0, (uint32_t)rng & 0xFFFF, (rng >> 32) & 1 );
+          break;
+        case 3:
+          TEST_FIXPOINT_INIT( &vals[i], (uint32_t)(rng >> 32), (uint32_t)rng, true );
+          break;
+        case 4:
+          TEST_FIXPOINT_INIT( &vals[i], (uint32_t)i, 0, false );
+          break;
+        case 5:
+          TEST_FIXPOINT_INIT( &vals[i], (uint32_t)(n - i), (uint32_t)rng, false );
+          break;
+        default:
+          TEST_FIXPOINT_INIT( &vals[i], (uint32_t)(rng >> 32), (uint32_t)rng, (rng >> 7) & 1 );
+        }
+      }
+      memcpy(expected, vals, n * sizeof(fixpoint_t));
+      qsort(expected, n, sizeof(fixpoint_t), compare_for_qsort);
+
+      fixpoint_sort_n(vals, n);
+      for (size_t i = 0; i < n; i++) {
+        TEST_EQUAL( &expected[i], &vals[i] );
+      }
+    }
+  }
+}
+
+TEST_CASE( test_reductions ) {
+  enum { N = 1000, NBUCKETS = 10 };
+  static fixpoint_t vals[N];
+  fixpoint_t result, sum;
+  fixpoint_stats_t stats;
+  size_t index;
+  uint64_t rng = TEST_RAND_SEED2;
+
+  //few distinct values so there are ties (including 0 and negative 0),
+  //then full range values
+  for (int kind = 0; kind < 2; kind++) {
+    for (int i = 0; i < N; i++) {
+      test_rand( &rng );
+      if (kind == 0) {
+        TEST_FIXPOINT_INIT( &vals[i], (uint32_t)(rng % 5), (uint32_t)(rng >> 40) & 0x80000000, (rng >> 8) & 1 );
+      } else {
+        TEST_FIXPOINT_INIT( &vals[i], (uint32_t)(rng >> 32), (uint32_t)rng, (rng >> 7) & 1 );
+      }
+    }
+
+    for (size_t n = 1; n <= N; n = n * 3 + 1) {
+      //reference: first smallest and largest with fixpoint_compare
+      size_t min_i = 0, max_i = 0;
+      for (size_t i = 1; i < n; i++) {
+        if (fixpoint_compare(&vals[i], &vals[min_i]) < 0) min_i = i;
+        if (fixpoint_compare(&vals[i], &vals[max_i]) > 0) max_i = i;
+      }
+
+      ASSERT( fixpoint_min_n(&result, &index, vals, n) );
+      ASSERT( index == min_i );
+      TEST_EQUAL( &vals[min_i], &result );
+      ASSERT( fixpoint_max_n(&result, NULL, vals, n) );
+      TEST_EQUAL( &vals[max_i], &result );
+
+      result_t ret = fixpoint_stats_n(&stats, vals, n);
+      ASSERT( ret == fixpoint_sum_n(&sum, vals, n) );
+      TEST_EQUAL( &sum, &stats.sum );
+      ASSERT( stats.count == n );
+      ASSERT( stats.argmin == min_i && stats.argmax == max_i );
+      TEST_EQUAL( &vals[min_i], &stats.min );
+      TEST_EQUAL( &vals[max_i], &stats.max );
+    }
+
+    //histograms with small buckets around 0, and with buckets wider
+    //than 2^64 units in total (lo + nbuckets * width is out of range)
+    fixpoint_t lo, width;
+    for (int h = 0; h < 2; h++) {
+      if (h == 0) {
+        TEST_FIXPOINT_INIT( &lo, 2, 0x40000000, true );
+        TEST_FIXPOINT_INIT( &width, 0, 0x60000000, false );
+      } else {
+        lo = objs->neg_max;
+        TEST_FIXPOINT_INIT( &width, 0x80000000, 0, false );
+      }
+      size_t counts[NBUCKETS + 2] = { 0 }, expected[NBUCKETS + 2] = { 0 };
+      ASSERT( fixpoint_histogram_n(counts, NBUCKETS, &lo, &width, vals, N) );
+      __int128 lo_val = (__int128)(((uint64_t)lo.whole << 32) | lo.frac) * (lo.negative ? -1 : 1);
+      __int128 w = ((uint64_t)width.whole << 32) | width.frac;
+      for (int i = 0; i < N; i++) {
+        __int128 v = (__int128)(((uint64_t)vals[i].whole << 32) | vals[i].frac) * (vals[i].negative ? -1 : 1);
+        __int128 d = v - lo_val;
+        expected[d < 0 ? 0 : d / w >= NBUCKETS ? NBUCKETS + 1 : (size_t)(d / w) + 1]++;
+      }
+      for (int b = 0; b < NBUCKETS + 2; b++) {
+        ASSERT( counts[b] == expected[b] );
+      }
+      //counts accumulate
+      ASSERT( fixpoint_histogram_n(counts, NBUCKETS, &lo, &width, vals, N) );
+      ASSERT( counts[1] == 2 * expected[1] );
+    }
+  }
+
+  //the boundaries of a bucket, and invalid widths
+  size_t counts[3] = { 0 };
+  fixpoint_t width = objs->one, neg_zero;
+  fixpoint_t edge[] = { objs->neg_min, objs->zero, objs->one_half, objs->one };
+  TEST_FIXPOINT_INIT( &neg_zero, 0, 0, true );
+  ASSERT( fixpoint_histogram_n(counts, 1, &neg_zero, &width, edge, 4) );
+  ASSERT( counts[0] == 1 && counts[1] == 2 && counts[2] == 1 );
+  ASSERT( !fixpoint_histogram_n(counts, 1, &objs->zero, &objs->zero, edge, 4) );
+  ASSERT( !fixpoint_histogram_n(counts, 1, &objs->zero, &objs->neg_one, edge, 4) );
+
+  //empty arrays
+  ASSERT( !fixpoint_min_n(&result, &index, vals, 0) );
+  ASSERT( !fixpoint_max_n(&result, &index, vals, 0) );
+  ASSERT( RESULT_OK == fixpoint_stats_n(&stats, vals, 0) );
+  ASSERT( stats.count == 0 && stats.argmin == 0 && stats.argmax == 0 );
+  TEST_EQUAL( &objs->zero, &stats.min );
+  TEST_EQUAL( &objs->zero, &stats.sum );
+}
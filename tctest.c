@@ -25,6 +25,13 @@
 #include <signal.h>
 #include <unistd.h>
 #include <stdarg.h>
+#include <stdlib.h>
+#include <time.h>
+#include <errno.h>
+#include <poll.h>
+#include <fnmatch.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include "tctest.h"
 
 typedef struct {
@@ -39,6 +46,7 @@ static tctest_signal tctest_signal_list[] = {
 	{ SIGABRT, "abort (assert failed?)" },
 	{ SIGTRAP, "trap" },
 	{ SIGSYS, "bad system call" },
+	{ SIGALRM, "timed out" },
 	{ -1, "unknown signal" }
 };
 
@@ -49,6 +57,75 @@ int tctest_num_executed;
 const char *tctest_testname_to_execute;
 void (*tctest_on_test_executed)(const char *testname, int passed);
 void (*tctest_on_complete)(int num_passed, int num_executed);
+int tctest_repeat = 1;
+unsigned tctest_timeout;
+uint64_t tctest_test_elapsed_ns;
+uint64_t tctest_elapsed_ns;
+int tctest_jobs = 1;
+int tctest_shard_index;
+int tctest_shard_count = 1;
+
+/* table of tests registered by TEST_CASE(), sorted by file and line */
+static tctest_entry *tctest_entries;
+
+/* number of TEST() calls so far for tests matching the name filter */
+static int tctest_num_matched;
+
+/* position of the test being executed among the tests of this
+ * shard, counting from 0 */
+static int tctest_test_index = -1;
+
+/* index of this worker process, -1 if this is not a worker */
+static int tctest_worker = -1;
+
+/* a worker skips its tests up to this TEST() call (the previous
+ * worker for the same share of the tests crashed in it) */
+static int tctest_resume_after = -1;
+
+/* set in the parent process once the workers have executed all tests */
+static int tctest_parallel_done;
+
+/* growable buffer for the output received from a worker */
+typedef struct {
+	char *data;
+	size_t len, cap;
+} tctest_buffer;
+
+/* state of a worker process, in the parent process */
+typedef struct {
+	pid_t pid;
+	int fd;                 /* read end of the worker's stdout, -1 if closed */
+	int test_index;         /* test being executed, -1 if none */
+	char *test_name;
+	uint64_t test_start_ns; /* when the parent saw the test begin */
+	tctest_buffer in;       /* received data not parsed yet */
+	tctest_buffer out;      /* output of the test being executed */
+} tctest_worker_state;
+
+/* start time of the current run of a test, 0 if none is in progress */
+static uint64_t tctest_run_start;
+
+static uint64_t tctest_now_ns(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000 + (uint64_t) ts.tv_nsec;
+}
+
+/*
+ * Print a duration in nanoseconds with a unit that
+ * keeps it readable.
+ */
+static void tctest_print_duration(double ns) {
+	if (ns < 1e3) {
+		printf("%.0f ns", ns);
+	} else if (ns < 1e6) {
+		printf("%.3f us", ns / 1e3);
+	} else if (ns < 1e9) {
+		printf("%.3f ms", ns / 1e6);
+	} else {
+		printf("%.3f s", ns / 1e9);
+	}
+}
 
 /*
  * Special version of write to work around the fact that
@@ -123,6 +200,18 @@ static void tctest_signal_handler(int signum, siginfo_t *info, void *addr) {
 	/* print message about failure */
 	tctest_print_signal_msg(msg);
 
+	/* a worker process is not trusted to recover: let the signal
+	 * kill it, and the parent process reports the failure */
+	if (tctest_worker >= 0) {
+		sigset_t set;
+		signal(signum, SIG_DFL);
+		sigemptyset(&set);
+		sigaddset(&set, signum);
+		sigprocmask(SIG_UNBLOCK, &set, NULL);
+		raise(signum);
+		_exit(1);
+	}
+
 	/* jump back to TEST context */
 	siglongjmp(tctest_env, 1);
 }
@@ -140,6 +229,432 @@ void tctest_register_signal_handlers(void) {
 	}
 }
 
+/*
+ * Get an option from a nonnegative integer environment variable,
+ * leaving it unchanged if the variable is not set or not valid.
+ */
+static void tctest_read_option(const char *name, unsigned long *val) {
+	const char *str = getenv(name);
+	char *end;
+	unsigned long n;
+
+	if (!str || *str < '0' || *str > '9') {
+		return;
+	}
+	n = strtoul(str, &end, 10);
+	if (*end == '\0') {
+		*val = n;
+	}
+}
+
+void tctest_read_options(void) {
+	unsigned long repeat = tctest_repeat, timeout = tctest_timeout, jobs = tctest_jobs;
+
+	tctest_read_option("TCTEST_REPEAT", &repeat);
+	tctest_read_option("TCTEST_TIMEOUT", &timeout);
+	tctest_read_option("TCTEST_JOBS", &jobs);
+	tctest_repeat = repeat > 0 && repeat <= 1000000000 ? (int) repeat : 1;
+	tctest_timeout = (unsigned) timeout;
+	tctest_jobs = jobs > 0 && jobs <= 1024 ? (int) jobs : 1;
+
+	/* TCTEST_SHARD is "index/count" */
+	const char *shard = getenv("TCTEST_SHARD");
+	int index, count, len;
+	if (shard && sscanf(shard, "%d/%d%n", &index, &count, &len) == 2 && shard[len] == '\0') {
+		if (count > 0 && index >= 0 && index < count) {
+			tctest_shard_index = index;
+			tctest_shard_count = count;
+		} else {
+			fprintf(stderr, "tctest: ignoring invalid TCTEST_SHARD %s\n", shard);
+		}
+	}
+	if (tctest_shard_count < 1 || tctest_shard_index < 0 || tctest_shard_index >= tctest_shard_count) {
+		tctest_shard_index = 0;
+		tctest_shard_count = 1;
+	}
+}
+
+static void tctest_append(tctest_buffer *buf, const char *data, size_t n) {
+	/* data may be NULL (an empty buffer) if there is nothing to append */
+	if (n == 0) {
+		return;
+	}
+	if (buf->len + n > buf->cap) {
+		size_t cap = buf->cap ? buf->cap : 256;
+		while (cap < buf->len + n) {
+			cap *= 2;
+		}
+		buf->data = (char *) realloc(buf->data, cap);
+		if (!buf->data) {
+			fprintf(stderr, "tctest: out of memory\n");
+			exit(1);
+		}
+		buf->cap = cap;
+	}
+	memcpy(buf->data + buf->len, data, n);
+	buf->len += n;
+}
+
+/* print the output in a buffer, and empty it */
+static void tctest_print_output(tctest_buffer *buf) {
+	if (buf->len > 0) {
+		fwrite(buf->data, 1, buf->len, stdout);
+		buf->len = 0;
+	}
+}
+
+/*
+ * Fork worker k.  Returns 1 in the new worker process (which returns
+ * from TEST_INIT() and goes on to execute its share of the tests),
+ * 0 in the parent.
+ */
+static int tctest_start_worker(tctest_worker_state *workers, int k, int resume_after) {
+	int fds[2];
+	pid_t pid;
+	int i;
+
+	fflush(stdout);
+	if (pipe(fds) != 0 || (pid = fork()) < 0) {
+		perror("tctest: could not start worker");
+		exit(1);
+	}
+
+	if (pid == 0) {
+		/* the worker's standard output goes to the parent */
+		for (i = 0; i < tctest_jobs; i++) {
+			if (workers[i].fd >= 0) {
+				close(workers[i].fd);
+			}
+		}
+		close(fds[0]);
+		dup2(fds[1], 1);
+		close(fds[1]);
+		setvbuf(stdout, NULL, _IOLBF, 0);
+		tctest_worker = k;
+		tctest_resume_after = resume_after;
+		return 1;
+	}
+
+	close(fds[1]);
+	workers[k].pid = pid;
+	workers[k].fd = fds[0];
+	workers[k].test_index = -1;
+	return 0;
+}
+
+/*
+ * Report the outcome of the test a worker was executing: print its
+ * output and update the counts as the TEST() macro does.
+ */
+static void tctest_report(tctest_worker_state *w, int passed, uint64_t elapsed_ns) {
+	tctest_print_output(&w->out);
+	fflush(stdout);
+
+	tctest_num_executed++;
+	if (!passed) {
+		tctest_failures++;
+	}
+	tctest_test_elapsed_ns = elapsed_ns;
+	tctest_elapsed_ns += elapsed_ns;
+	if (tctest_on_test_executed) {
+		tctest_on_test_executed(w->test_name, passed);
+	}
+
+	free(w->test_name);
+	w->test_name = NULL;
+	w->test_index = -1;
+}
+
+/*
+ * Handle a record from a worker: "B <index> <name>" when it begins
+ * executing a test, "E <passed> <elapsed_ns>" when the test is done.
+ */
+static void tctest_worker_record(tctest_worker_state *w, const char *rec) {
+	int index, passed, name_pos;
+	unsigned long long elapsed_ns;
+
+	if (sscanf(rec, "B %d %n", &index, &name_pos) == 1) {
+		/* output between tests does not belong to either test */
+		tctest_print_output(&w->out);
+		free(w->test_name);
+		w->test_name = strdup(rec + name_pos);
+		w->test_index = index;
+		w->test_start_ns = tctest_now_ns();
+	} else if (sscanf(rec, "E %d %llu", &passed, &elapsed_ns) == 2 && w->test_index >= 0) {
+		tctest_report(w, passed, elapsed_ns);
+	}
+}
+
+/*
+ * Handle data read from a worker's standard output: records start
+ * with a \001 character and end with a newline, and everything
+ * else is output of the test being executed.
+ */
+static void tctest_worker_input(tctest_worker_state *w, const char *data, size_t n) {
+	size_t pos = 0;
+
+	tctest_append(&w->in, data, n);
+	while (pos < w->in.len) {
+		char *rec = (char *) memchr(w->in.data + pos, '\001', w->in.len - pos);
+		size_t end = rec ? (size_t) (rec - w->in.data) : w->in.len;
+		char *nl;
+
+		tctest_append(&w->out, w->in.data + pos, end - pos);
+		pos = end;
+		if (!rec || !(nl = (char *) memchr(rec, '\n', w->in.len - pos))) {
+			/* no record, or only part of one so far */
+			break;
+		}
+		*nl = '\0';
+		tctest_worker_record(w, rec + 1);
+		pos = nl + 1 - w->in.data;
+	}
+	memmove(w->in.data, w->in.data + pos, w->in.len - pos);
+	w->in.len -= pos;
+}
+
+/*
+ * Handle the exit of a worker.  If it was executing a test,
+ * the test failed.
+ */
+static void tctest_worker_exited(tctest_worker_state *w, int status) {
+	char msg[64];
+	int i;
+
+	tctest_append(&w->out, w->in.data, w->in.len);
+	w->in.len = 0;
+
+	if (w->test_index < 0) {
+		tctest_print_output(&w->out);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+			printf("worker process exited abnormally between tests\n");
+		}
+		return;
+	}
+
+	msg[0] = '\0';
+	if (WIFSIGNALED(status)) {
+		/* the signal handler printed a message for the signals it handles */
+		for (i = 0; tctest_signal_list[i].signum != -1; i++) {
+			if (WTERMSIG(status) == tctest_signal_list[i].signum) {
+				break;
+			}
+		}
+		if (tctest_signal_list[i].signum == -1) {
+			snprintf(msg, sizeof(msg), "killed by signal %d\n", WTERMSIG(status));
+		}
+	} else {
+		snprintf(msg, sizeof(msg), "exited with status %d\n", WEXITSTATUS(status));
+	}
+	tctest_append(&w->out, msg, strlen(msg));
+
+	/* the worker couldn't time the test, so count the time since
+	 * the parent saw it begin, as a timeout counts in serial mode */
+	tctest_report(w, 0, tctest_now_ns() - w->test_start_ns);
+}
+
+void tctest_run_parallel(void) {
+	tctest_worker_state *workers;
+	struct pollfd *fds;
+	int *fd_worker;
+	int k, i, n, active;
+
+	if (tctest_jobs <= 1) {
+		return;
+	}
+
+	workers = (tctest_worker_state *) calloc(tctest_jobs, sizeof(tctest_worker_state));
+	fds = (struct pollfd *) calloc(tctest_jobs, sizeof(struct pollfd));
+	fd_worker = (int *) calloc(tctest_jobs, sizeof(int));
+	if (!workers || !fds || !fd_worker) {
+		fprintf(stderr, "tctest: out of memory\n");
+		exit(1);
+	}
+	for (k = 0; k < tctest_jobs; k++) {
+		workers[k].fd = -1;
+	}
+	for (k = 0; k < tctest_jobs; k++) {
+		if (tctest_start_worker(workers, k, -1)) {
+			return;
+		}
+	}
+
+	active = tctest_jobs;
+	while (active > 0) {
+		n = 0;
+		for (k = 0; k < tctest_jobs; k++) {
+			if (workers[k].fd >= 0) {
+				fds[n].fd = workers[k].fd;
+				fds[n].events = POLLIN;
+				fd_worker[n++] = k;
+			}
+		}
+		if (poll(fds, n, -1) < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			perror("tctest: poll");
+			exit(1);
+		}
+
+		for (i = 0; i < n; i++) {
+			tctest_worker_state *w = &workers[fd_worker[i]];
+			char data[4096];
+			ssize_t len;
+			int status, crashed_index;
+
+			if (fds[i].revents == 0) {
+				continue;
+			}
+			len = read(w->fd, data, sizeof(data));
+			if (len > 0) {
+				tctest_worker_input(w, data, (size_t) len);
+				continue;
+			}
+			if (len < 0 && errno == EINTR) {
+				continue;
+			}
+
+			/* end of output: the worker is done, or crashed */
+			close(w->fd);
+			w->fd = -1;
+			while (waitpid(w->pid, &status, 0) < 0 && errno == EINTR) {
+			}
+			crashed_index = w->test_index;
+			tctest_worker_exited(w, status);
+			if (crashed_index >= 0) {
+				/* a new worker executes the rest of the crashed worker's tests */
+				if (tctest_start_worker(workers, fd_worker[i], crashed_index)) {
+					return;
+				}
+			} else {
+				active--;
+			}
+		}
+	}
+	fflush(stdout);
+
+	for (k = 0; k < tctest_jobs; k++) {
+		free(workers[k].test_name);
+		free(workers[k].in.data);
+		free(workers[k].out.data);
+	}
+	free(workers);
+	free(fds);
+	free(fd_worker);
+	tctest_parallel_done = 1;
+}
+
+void tctest_worker_exit(void) {
+	if (tctest_worker >= 0) {
+		fflush(stdout);
+		_exit(0);
+	}
+}
+
+int tctest_should_run(const char *testname) {
+	int position;
+
+	if (tctest_testname_to_execute && fnmatch(tctest_testname_to_execute, testname, 0) != 0) {
+		return 0;
+	}
+	position = tctest_num_matched++;
+	if (position % tctest_shard_count != tctest_shard_index) {
+		return 0;
+	}
+	tctest_test_index = position / tctest_shard_count;
+	if (tctest_parallel_done) {
+		/* the workers executed the tests */
+		return 0;
+	}
+	if (tctest_worker >= 0) {
+		return tctest_test_index % tctest_jobs == tctest_worker &&
+			tctest_test_index > tctest_resume_after;
+	}
+	return 1;
+}
+
+void tctest_begin(const char *testname) {
+	tctest_num_executed++;
+	tctest_assertion_line = -1;
+	tctest_test_elapsed_ns = 0;
+	if (tctest_repeat < 1) {
+		tctest_repeat = 1;
+	}
+	if (tctest_worker >= 0) {
+		printf("\001B %d %s\n", tctest_test_index, testname);
+	}
+	printf("%s...", testname);
+	fflush(stdout);
+}
+
+void tctest_begin_run(void) {
+	alarm(tctest_timeout);
+	tctest_run_start = tctest_now_ns();
+}
+
+void tctest_end_run(void) {
+	tctest_test_elapsed_ns += tctest_now_ns() - tctest_run_start;
+	tctest_run_start = 0;
+	alarm(0);
+}
+
+void tctest_end(const char *testname, int passed) {
+	/* a failed run stops the timer without tctest_end_run */
+	if (tctest_run_start != 0) {
+		tctest_end_run();
+	}
+	tctest_elapsed_ns += tctest_test_elapsed_ns;
+
+	if (passed) {
+		printf("passed! (");
+		tctest_print_duration((double) tctest_test_elapsed_ns);
+		if (tctest_repeat > 1) {
+			printf(", %d runs, ", tctest_repeat);
+			tctest_print_duration((double) tctest_test_elapsed_ns / tctest_repeat);
+			printf(" per run");
+		}
+		printf(")\n");
+	}
+
+	if (tctest_worker >= 0) {
+		/* the parent process counts the test and calls the callback */
+		printf("\001E %d %llu\n", passed, (unsigned long long) tctest_test_elapsed_ns);
+		fflush(stdout);
+		return;
+	}
+	if (!passed) {
+		tctest_failures++;
+	}
+	if (tctest_on_test_executed) {
+		tctest_on_test_executed(testname, passed);
+	}
+}
+
+void tctest_register(tctest_entry *entry) {
+	tctest_entry **pos = &tctest_entries;
+
+	/* constructors don't necessarily run in the order the tests are
+	 * defined, so insert the entry in order of file and line */
+	while (*pos) {
+		int cmp = strcmp((*pos)->file, entry->file);
+		if (cmp > 0 || (cmp == 0 && (*pos)->line > entry->line)) {
+			break;
+		}
+		pos = &(*pos)->next;
+	}
+	entry->next = *pos;
+	*pos = entry;
+}
+
+void tctest_run_registered(void) {
+	tctest_entry *entry;
+
+	for (entry = tctest_entries; entry; entry = entry->next) {
+		entry->run();
+	}
+}
+
 void tctest_fail(const char *fmt, ...) {
 	/* print the failure message */
 	va_list args;
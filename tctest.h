@@ -29,9 +29,11 @@
 #include <stdexcept>
 #include <cstdio>
 #include <cstring>
+#include <cstdint>
 #else
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #endif
 #include <setjmp.h>
 #include <signal.h>
@@ -42,8 +44,12 @@ extern "C" {
 
 #ifdef __GNUC__
 #  define TCTEST_PRINTF_FORMAT_ATTR __attribute__ ((format (printf, 1, 2)))
+#  define TCTEST_CONSTRUCTOR_ATTR __attribute__ ((constructor))
+#  define TCTEST_UNUSED_ATTR __attribute__ ((unused))
 #else
 #  define TCTEST_PRINTF_FORMAT_ATTR
+#  define TCTEST_CONSTRUCTOR_ATTR
+#  define TCTEST_UNUSED_ATTR
 #endif
 
 extern sigjmp_buf tctest_env;
@@ -51,6 +57,37 @@ extern int tctest_assertion_line;
 extern int tctest_failures;
 extern int tctest_num_executed;
 void tctest_register_signal_handlers(void);
+void tctest_read_options(void);
+void tctest_run_parallel(void);
+void tctest_worker_exit(void);
+
+/*
+ * Functions called by the TEST() macro to decide whether to execute
+ * a test, time each test and run of a test, arm and cancel the
+ * timeout, and report the outcome.
+ */
+int tctest_should_run(const char *testname);
+
+/*
+ * Entry in the table of tests registered by TEST_CASE().  The table
+ * is built before main() runs (by constructor functions), and kept
+ * sorted by file and line, so TEST_RUN_ALL() executes the tests in
+ * the order they are defined.
+ */
+typedef struct tctest_entry {
+	const char *name;
+	void (*run)(void);
+	const char *file;
+	int line;
+	struct tctest_entry *next;
+} tctest_entry;
+
+void tctest_register(tctest_entry *entry);
+void tctest_run_registered(void);
+void tctest_begin(const char *testname);
+void tctest_begin_run(void);
+void tctest_end_run(void);
+void tctest_end(const char *testname, int passed);
 
 /*
  * This function is called by the ASSERT() and FAIL() macros
@@ -62,12 +99,69 @@ void tctest_fail(const char *fmt, ...) TCTEST_PRINTF_FORMAT_ATTR;
 
 /*
  * Setting this pointer to a non-null value will cause tctest to
- * only execute the test with the specified name (which must
- * exactly match the name of a test function.)  This is useful
- * for allowing the test driver to run a single test.
+ * only execute the tests whose names match it, as a shell glob
+ * pattern (see fnmatch(3)): for example, "test_parse_*".  A plain
+ * test name only matches the test with that name.  This is useful
+ * for allowing the test driver to run a single test, or a group of
+ * related tests.
  */
 extern const char *tctest_testname_to_execute;
 
+/*
+ * Number of times each test is run (default 1).  Each run gets a
+ * fresh fixture from setup(), and only the test function itself is
+ * timed, so running a fast test many times gives a more useful
+ * per-run time.  The TCTEST_REPEAT environment variable overrides
+ * this when TEST_INIT() is executed.
+ */
+extern int tctest_repeat;
+
+/*
+ * If nonzero, a run of a test which takes longer than this many
+ * seconds is interrupted (using alarm and SIGALRM) and counted as
+ * a failure, rather than hanging the whole test program.  The
+ * TCTEST_TIMEOUT environment variable overrides this when
+ * TEST_INIT() is executed.
+ */
+extern unsigned tctest_timeout;
+
+/*
+ * If greater than 1, the tests are executed in parallel by this many
+ * worker processes, forked by TEST_INIT(): worker k executes the
+ * tests whose position in the sequence of TEST() calls is k modulo
+ * tctest_jobs.  A test which crashes (or times out) only kills its
+ * worker, and a new worker carries on with the rest of its share of
+ * the tests.  The parent process reports the output and outcome of
+ * each test (in the order they complete) and calls the callbacks, so
+ * the tests must not depend on each other's side effects.  The
+ * TCTEST_JOBS environment variable overrides this when TEST_INIT()
+ * is executed.
+ */
+extern int tctest_jobs;
+
+/*
+ * To split the tests between several test processes (for example,
+ * on different machines), set tctest_shard_count to the number of
+ * processes, and tctest_shard_index to a different number from 0
+ * to tctest_shard_count - 1 in each: each process executes every
+ * tctest_shard_count-th test that matches tctest_testname_to_execute,
+ * starting with the tctest_shard_index-th.  The TCTEST_SHARD
+ * environment variable, in the form "index/count" (e.g., "0/4"),
+ * overrides these when TEST_INIT() is executed.
+ */
+extern int tctest_shard_index;
+extern int tctest_shard_count;
+
+/*
+ * Time in nanoseconds (from the monotonic clock) spent running
+ * the most recently executed test, and all executed tests.  Only
+ * the test functions are timed, not setup() and cleanup().  These
+ * can be read from the tctest_on_test_executed and
+ * tctest_on_complete callbacks.
+ */
+extern uint64_t tctest_test_elapsed_ns;
+extern uint64_t tctest_elapsed_ns;
+
 /*
  * If this function pointer is set to a non-null value, it will
  * be called after a test has been executed.  The testname parameter
@@ -81,7 +175,8 @@ extern void (*tctest_on_test_executed)(const char *testname, int passed);
  * If this function pointer is set to a non-null value, it will
  * be called after all tests have executed.  The parameters
  * are the number of tests passed and the total number of tests
- * executed (respectively.)
+ * executed (respectively.)  The total time spent in the tests is
+ * in tctest_elapsed_ns.
  */
 extern void (*tctest_on_complete)(int num_passed, int num_executed);
 
@@ -98,16 +193,10 @@ extern void (*tctest_on_complete)(int num_passed, int num_executed);
 #  define TCTEST_CATCH(func) \
 	} catch (std::exception &ex) { \
 		printf("std::exception (what='%s')\n", ex.what()); \
-		tctest_failures++; \
-		if (tctest_on_test_executed) { \
-			tctest_on_test_executed(#func, 0); \
-		} \
+		tctest_end(#func, 0); \
 	} catch (...) { \
 		printf("exception\n"); \
-		tctest_failures++; \
-		if (tctest_on_test_executed) { \
-			tctest_on_test_executed(#func, 0); \
-		} \
+		tctest_end(#func, 0); \
 	}
 
 #else
@@ -119,29 +208,33 @@ extern void (*tctest_on_complete)(int num_passed, int num_executed);
 #endif
 
 #define TEST_INIT() do { \
+	tctest_read_options(); \
+	tctest_run_parallel(); \
 	tctest_register_signal_handlers(); \
 } while (0)
 
+/*
+ * The fixture pointer and run counter are volatile because they are
+ * modified after sigsetjmp and used after a siglongjmp back to it.
+ */
 #define TEST(func) do { \
-	if (!tctest_testname_to_execute || strcmp(tctest_testname_to_execute, #func) == 0) { \
-		TestObjs *t = 0; \
-		tctest_num_executed++; \
-		tctest_assertion_line = -1; \
+	if (tctest_should_run(#func)) { \
+		TestObjs *volatile t = 0; \
+		volatile int tctest_run; \
+		tctest_begin(#func); \
 		TCTEST_TRY \
 		if (sigsetjmp(tctest_env, 1) == 0) { \
-			t = setup(); \
-			printf("%s...", #func); \
-			fflush(stdout); \
-			func(t); \
-			printf("passed!\n"); \
-			if (tctest_on_test_executed) { \
-				tctest_on_test_executed(#func, 1); \
+			for (tctest_run = 0; tctest_run < tctest_repeat; tctest_run++) { \
+				t = setup(); \
+				tctest_begin_run(); \
+				func(t); \
+				tctest_end_run(); \
+				cleanup(t); \
+				t = 0; \
 			} \
+			tctest_end(#func, 1); \
 		} else { \
-			tctest_failures++; \
-			if (tctest_on_test_executed) { \
-				tctest_on_test_executed(#func, 0); \
-			} \
+			tctest_end(#func, 0); \
 		} \
 		TCTEST_CATCH(func) \
 		if (t) { \
@@ -150,6 +243,40 @@ extern void (*tctest_on_complete)(int num_passed, int num_executed);
 	} \
 } while (0)
 
+/*
+ * Define and register a test function:
+ *
+ *   TEST_CASE(test_foo) {
+ *       ASSERT(...);
+ *   }
+ *
+ * defines the function static void test_foo(TestObjs *objs), and adds
+ * it to the table of tests executed by TEST_RUN_ALL(), so there is no
+ * need to also declare it and call TEST(test_foo) in main().  Tests
+ * which don't use the fixture don't need to mark objs as unused.  The
+ * setup() and cleanup() functions must be declared before the first
+ * TEST_CASE().
+ */
+#define TEST_CASE(func) \
+	static void func(TestObjs *objs TCTEST_UNUSED_ATTR); \
+	static void tctest_run_##func(void) { \
+		TEST(func); \
+	} \
+	static tctest_entry tctest_entry_##func = { #func, tctest_run_##func, __FILE__, __LINE__, 0 }; \
+	static void tctest_register_##func(void) TCTEST_CONSTRUCTOR_ATTR; \
+	static void tctest_register_##func(void) { \
+		tctest_register(&tctest_entry_##func); \
+	} \
+	static void func(TestObjs *objs TCTEST_UNUSED_ATTR)
+
+/*
+ * Execute the tests defined by TEST_CASE() (in all the files linked
+ * into the test program), as if by calling TEST() for each of them.
+ */
+#define TEST_RUN_ALL() do { \
+	tctest_run_registered(); \
+} while (0)
+
 #define ASSERT(cond) do { \
 	tctest_assertion_line = __LINE__; \
 	if (!(cond)) { \
@@ -167,14 +294,15 @@ extern void (*tctest_on_complete)(int num_passed, int num_executed);
 } while (0)
 
 #define TEST_FINI() do { \
+	tctest_worker_exit(); \
 	if (tctest_failures == 0) { \
 		if (tctest_num_executed > 0) { \
-			printf("All tests passed!\n"); \
+			printf("All tests passed! (%.3f s)\n", tctest_elapsed_ns / 1e9); \
 		} else { \
 			printf("No tests were executed!\n"); \
 		} \
 	} else { \
-		printf("%d test(s) failed\n", tctest_failures); \
+		printf("%d test(s) failed (%.3f s)\n", tctest_failures, tctest_elapsed_ns / 1e9); \
 	} \
 	if (tctest_on_complete) { \
 		tctest_on_complete(tctest_num_executed - tctest_failures, tctest_num_executed); \